@@ -2,6 +2,7 @@
 #include <migraphx/rank.hpp>
 #include <migraphx/shape.hpp>
 #include <migraphx/program.hpp>
+#include <migraphx/session.hpp>
 #include <migraphx/onnx.hpp>
 #include <migraphx/tf.hpp>
 #include <migraphx/register_target.hpp>
@@ -188,6 +189,8 @@ bool equal(const T& x, const T& y)
 
 std::vector<argument> run(program& p, const parameter_map& params) { return p.eval(params); }
 
+std::vector<argument> run(session& s, const parameter_map& params) { return s.eval(params); }
+
 std::vector<shape> get_output_shapes(program& p) { return p.get_output_shapes(); }
 
 void print_program(const program& p) { std::cout << p << std::endl; }
@@ -309,6 +312,16 @@ struct migraphx_program
     migraphx::program object;
 };
 
+extern "C" struct migraphx_session;
+struct migraphx_session
+{
+    template <class... Ts>
+    migraphx_session(Ts&&... xs) : object(std::forward<Ts>(xs)...)
+    {
+    }
+    migraphx::session object;
+};
+
 extern "C" struct migraphx_operation;
 struct migraphx_operation
 {
@@ -825,6 +838,37 @@ migraphx_program_equal(bool* out, const_migraphx_program_t program, const_migrap
     return api_error_result;
 }
 
+extern "C" migraphx_status migraphx_session_destroy(migraphx_session_t session)
+{
+    auto api_error_result = migraphx::try_([&] { destroy((session)); });
+    return api_error_result;
+}
+
+extern "C" migraphx_status migraphx_session_create(migraphx_session_t* session,
+                                                   const_migraphx_program_t program)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(program == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param, "Bad parameter program: Null pointer");
+        *session = object_cast<migraphx_session_t>(allocate<migraphx::session>((program->object)));
+    });
+    return api_error_result;
+}
+
+extern "C" migraphx_status migraphx_session_run(migraphx_arguments_t* out,
+                                                migraphx_session_t session,
+                                                migraphx_program_parameters_t params)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(session == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param, "Bad parameter session: Null pointer");
+        if(params == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param, "Bad parameter params: Null pointer");
+        *out = allocate<migraphx_arguments_t>(migraphx::run((session->object), (params->object)));
+    });
+    return api_error_result;
+}
+
 extern "C" migraphx_status migraphx_operation_destroy(migraphx_operation_t operation)
 {
     auto api_error_result = migraphx::try_([&] { destroy((operation)); });
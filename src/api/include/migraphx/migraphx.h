@@ -17,7 +17,8 @@
     m(int32_type, int32_t) \
     m(int64_type, int64_t) \
     m(uint32_type, uint32_t) \
-    m(uint64_type, uint64_t)
+    m(uint64_type, uint64_t) \
+    m(bf16_type, bf16)
 // clang-format on
 
 #ifdef __cplusplus
@@ -68,6 +69,9 @@ typedef const struct migraphx_module* const_migraphx_module_t;
 typedef struct migraphx_program* migraphx_program_t;
 typedef const struct migraphx_program* const_migraphx_program_t;
 
+typedef struct migraphx_session* migraphx_session_t;
+typedef const struct migraphx_session* const_migraphx_session_t;
+
 typedef struct migraphx_operation* migraphx_operation_t;
 typedef const struct migraphx_operation* const_migraphx_operation_t;
 
@@ -205,6 +209,15 @@ migraphx_status migraphx_program_run(migraphx_arguments_t* out,
 migraphx_status
 migraphx_program_equal(bool* out, const_migraphx_program_t program, const_migraphx_program_t x);
 
+migraphx_status migraphx_session_destroy(migraphx_session_t session);
+
+migraphx_status migraphx_session_create(migraphx_session_t* session,
+                                        const_migraphx_program_t program);
+
+migraphx_status migraphx_session_run(migraphx_arguments_t* out,
+                                     migraphx_session_t session,
+                                     migraphx_program_parameters_t params);
+
 migraphx_status migraphx_operation_destroy(migraphx_operation_t operation);
 
 migraphx_status migraphx_operation_create(migraphx_operation_t* operation,
@@ -592,6 +592,26 @@ struct program : MIGRAPHX_HANDLE_BASE(program)
     friend bool operator!=(const program& px, const program& py) { return !(px == py); }
 };
 
+/// Runs a compiled program with its own context and scratch memory, so several sessions of one
+/// program can run concurrently while sharing its weights. The program must outlive the session.
+struct session : MIGRAPHX_HANDLE_BASE(session)
+{
+    session(migraphx_session* p, own) { this->set_handle(p, own{}); }
+
+    session(migraphx_session* p, borrow) { this->set_handle(p, borrow{}); }
+
+    /// Create a session for a compiled program
+    session(const program& p) { this->make_handle(&migraphx_session_create, p.get_handle_ptr()); }
+
+    /// Run the program using the inputs passed in
+    arguments eval(const program_parameters& pparams) const
+    {
+        migraphx_arguments_t pout;
+        call(&migraphx_session_run, &pout, this->get_handle_ptr(), pparams.get_handle_ptr());
+        return arguments(pout, own{});
+    }
+};
+
 struct operation : MIGRAPHX_HANDLE_BASE(operation)
 {
     operation(migraphx_operation* p, own) { this->set_handle(p, own{}); }
@@ -209,6 +209,16 @@ def program(h):
              const=True)
 
 
+@auto_handle()
+def session(h):
+    h.constructor('create', api.params(program='const migraphx::program&'))
+    h.method('run',
+             api.params(
+                 params='std::unordered_map<std::string, migraphx::argument>'),
+             invoke='migraphx::run($@)',
+             returns='std::vector<migraphx::argument>')
+
+
 @auto_handle()
 def operation(h):
     h.constructor('create',
@@ -8,7 +8,8 @@ inline namespace MIGRAPHX_INLINE_NS {
 argument::argument(const shape& s) : m_shape(s)
 {
     auto buffer = make_shared_array<char>(s.bytes());
-    assign_buffer({[=]() mutable { return buffer.get(); }});
+    auto* p     = buffer.get();
+    assign_buffer([p] { return p; }, std::move(buffer));
 }
 
 argument::argument(shape s, std::nullptr_t)
@@ -18,12 +19,12 @@ argument::argument(shape s, std::nullptr_t)
 
 argument::argument(const shape& s, const argument::data_t& d) : m_shape(s), m_data(d) {}
 
-void argument::assign_buffer(std::function<char*()> d)
+void argument::assign_buffer(std::function<char*()> d, std::shared_ptr<const void> owner)
 {
     const shape& s = m_shape;
     if(s.type() != shape::tuple_type)
     {
-        m_data = {std::move(d)};
+        m_data = {std::move(d), {}, std::move(owner)};
         return;
     }
     // Collect all shapes
@@ -67,7 +68,7 @@ void argument::assign_buffer(std::function<char*()> d)
         if(ss.sub_shapes().empty())
         {
             auto n = offsets[i];
-            result = {[d, n]() mutable { return d() + n; }};
+            result = {[d, n]() mutable { return d() + n; }, {}, owner};
             i++;
             return result;
         }
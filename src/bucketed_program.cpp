@@ -0,0 +1,339 @@
+#include <migraphx/bucketed_program.hpp>
+#include <migraphx/dead_code_elimination.hpp>
+#include <migraphx/filesystem.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/load_save.hpp>
+#include <migraphx/msgpack.hpp>
+#include <migraphx/pass_manager.hpp>
+#include <migraphx/propagate_constant.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/shape_for_each.hpp>
+#include <migraphx/stringutils.hpp>
+#include <migraphx/tmp_dir.hpp>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <system_error>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+// Copies the elements at the indices that are valid in both arguments
+static void copy_overlap(const argument& src, const argument& dst)
+{
+    const auto& ss = src.get_shape();
+    const auto& ds = dst.get_shape();
+    std::vector<std::size_t> lens;
+    std::transform(ss.lens().begin(),
+                   ss.lens().end(),
+                   ds.lens().begin(),
+                   std::back_inserter(lens),
+                   [](auto x, auto y) { return std::min(x, y); });
+    if(lens.empty())
+    {
+        std::memcpy(dst.data(), src.data(), ss.bytes());
+    }
+    else if(ss.standard() and ds.standard())
+    {
+        // The innermost dimension is contiguous in both, so it is copied a row at a time
+        auto type_size = ss.type_size();
+        auto row_bytes = lens.back() * type_size;
+        shape outer{ss.type(), {lens.begin(), lens.end() - 1}};
+        if(outer.lens().empty())
+        {
+            std::memcpy(dst.data(), src.data(), row_bytes);
+            return;
+        }
+        std::vector<std::size_t> idx(lens.size(), 0);
+        shape_for_each(outer, [&](const auto& i) {
+            std::copy(i.begin(), i.end(), idx.begin());
+            std::memcpy(dst.data() + ds.index(idx) * type_size,
+                        src.data() + ss.index(idx) * type_size,
+                        row_bytes);
+        });
+    }
+    else
+    {
+        visit_all(dst, src)([&](auto y, auto x) {
+            shape_for_each(shape{ss.type(), lens}, [&](const auto& i) {
+                y(i.begin(), i.end()) = x(i.begin(), i.end());
+            });
+        });
+    }
+}
+
+// Identifies the model and how it is compiled, so a cached program is not used for a different
+// model or with different options
+static std::string get_fingerprint(const program& p, const compile_options& options)
+{
+    value v;
+    v["program"]      = p.to_value();
+    v["offload_copy"] = options.offload_copy;
+    v["fast_math"]    = options.fast_math;
+    auto buffer       = to_msgpack(v);
+    std::stringstream ss;
+    ss << std::hex << std::hash<std::string>{}(std::string(buffer.begin(), buffer.end()));
+    return ss.str();
+}
+
+static std::vector<bucketed_program::dim_map>
+get_combinations(const std::unordered_map<std::string, std::vector<std::size_t>>& buckets)
+{
+    std::vector<bucketed_program::dim_map> result = {{}};
+    for(auto&& b : buckets)
+    {
+        std::vector<bucketed_program::dim_map> next;
+        for(auto&& x : result)
+        {
+            for(auto size : b.second)
+            {
+                next.push_back(x);
+                next.back()[b.first] = size;
+            }
+        }
+        result = std::move(next);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+bucketed_program::bucketed_program(program_factory f, target tgt, bucket_options opts)
+    : factory(std::move(f)), t(std::move(tgt)), options(std::move(opts))
+{
+    for(auto&& b : options.buckets)
+    {
+        if(b.second.empty())
+            MIGRAPHX_THROW("No sizes for bucket dimension: " + b.first);
+        std::sort(b.second.begin(), b.second.end());
+    }
+    auto check_dims = [&](const std::vector<std::string>& dims) {
+        for(auto&& d : dims)
+        {
+            if(not d.empty() and not contains(options.buckets, d))
+                MIGRAPHX_THROW("Unknown bucket dimension: " + d);
+        }
+    };
+    std::for_each(options.output_dims.begin(), options.output_dims.end(), check_dims);
+
+    // Find the sizes of the axes that are not bucketed
+    auto p           = factory({});
+    parameter_shapes = p.get_parameter_shapes();
+    for(auto&& pd : options.parameter_dims)
+    {
+        check_dims(pd.second);
+        if(not contains(parameter_shapes, pd.first))
+            MIGRAPHX_THROW("Unknown parameter: " + pd.first);
+        if(parameter_shapes.at(pd.first).lens().size() != pd.second.size())
+            MIGRAPHX_THROW("Dimensions for parameter " + pd.first + " do not match its rank");
+    }
+    if(not options.cache_dir.empty())
+        fingerprint = get_fingerprint(p, options.options);
+    share_literals(p);
+
+    if(not options.lazy)
+    {
+        for(auto&& bucket : get_buckets())
+            get_program(bucket);
+    }
+}
+
+std::vector<bucketed_program::dim_map> bucketed_program::get_buckets() const
+{
+    return get_combinations(options.buckets);
+}
+
+bucketed_program::dim_map bucketed_program::find_bucket(const dim_map& sizes) const
+{
+    dim_map result;
+    for(auto&& b : options.buckets)
+    {
+        const auto& name = b.first;
+        auto size        = contains(sizes, name) ? sizes.at(name) : 0;
+        auto it          = std::lower_bound(b.second.begin(), b.second.end(), size);
+        if(it == b.second.end())
+            MIGRAPHX_THROW("Size " + std::to_string(size) + " of dimension " + name +
+                           " is larger than the largest bucket");
+        result[name] = *it;
+    }
+    return result;
+}
+
+const program& bucketed_program::get_program(const dim_map& bucket)
+{
+    std::lock_guard<std::mutex> lock(m);
+    auto it = programs.find(bucket);
+    if(it == programs.end())
+    {
+        auto buckets = get_buckets();
+        if(not contains(buckets, bucket))
+            MIGRAPHX_THROW("Sizes are not one of the buckets");
+        it = programs.emplace(bucket, std::make_unique<program>(create_program(bucket))).first;
+    }
+    return *it->second;
+}
+
+program bucketed_program::create_program(const dim_map& bucket)
+{
+    fs::path file;
+    if(not options.cache_dir.empty())
+    {
+        std::vector<std::string> names = {t.name(), fingerprint};
+        std::transform(bucket.begin(), bucket.end(), std::back_inserter(names), [](auto&& b) {
+            return b.first + "_" + std::to_string(b.second);
+        });
+        file = fs::path{options.cache_dir} / (join_strings(names, "-") + ".mxr");
+        if(fs::exists(file))
+            return load(file.string());
+    }
+
+    std::unordered_map<std::string, std::vector<std::size_t>> input_dims;
+    for(auto&& pd : options.parameter_dims)
+    {
+        auto lens = parameter_shapes.at(pd.first).lens();
+        for(std::size_t i = 0; i < lens.size(); i++)
+        {
+            if(not pd.second[i].empty())
+                lens[i] = bucket.at(pd.second[i]);
+        }
+        input_dims[pd.first] = lens;
+    }
+    auto p = factory(input_dims);
+    // Fold the constants first so the ones that don't depend on the bucket can be shared as well
+    run_passes(*p.get_main_module(), {propagate_constant{}, dead_code_elimination{}});
+    share_literals(p);
+    p.compile(t, options.options);
+
+    if(not file.empty())
+    {
+        fs::create_directories(file.parent_path());
+        file_options fo;
+        fo.format = "mmap";
+        // Write to a temporary file and rename it, so another process never loads a partially
+        // written file
+        auto tmp = file.parent_path() / unique_string(file.filename().string());
+        try
+        {
+            save(p, tmp.string(), fo);
+            fs::rename(tmp, file);
+        }
+        catch(...)
+        {
+            std::error_code ec;
+            fs::remove(tmp, ec);
+            throw;
+        }
+    }
+    return p;
+}
+
+void bucketed_program::share_literals(program& p)
+{
+    for(auto* mod : p.get_modules())
+    {
+        std::vector<instruction_ref> lits;
+        for(auto ins : iterator_for(*mod))
+        {
+            if(ins->name() == "@literal")
+                lits.push_back(ins);
+        }
+        for(auto ins : lits)
+        {
+            const auto& l = ins->get_literal();
+            const auto& s = l.get_shape();
+            // Only the start of the data is hashed, the full contents are compared on a match
+            auto h = std::hash<std::string>{}(
+                to_string(s) + std::string(l.data(), std::min<std::size_t>(s.bytes(), 256)));
+            auto range = literals.equal_range(h);
+            auto it    = std::find_if(range.first, range.second, [&](auto&& pp) {
+                const auto& x = pp.second;
+                return x.get_shape() == s and
+                       (x.data() == l.data() or std::memcmp(x.data(), l.data(), s.bytes()) == 0);
+            });
+            if(it == range.second)
+            {
+                literals.emplace(h, l);
+                continue;
+            }
+            if(it->second.data() == l.data())
+                continue;
+            mod->replace_instruction(ins, mod->add_literal(it->second));
+            mod->remove_instruction(ins);
+        }
+    }
+}
+
+std::vector<argument> bucketed_program::eval(const parameter_map& params)
+{
+    dim_map sizes;
+    for(auto&& pd : options.parameter_dims)
+    {
+        if(not contains(params, pd.first))
+            continue;
+        const auto& lens = params.at(pd.first).get_shape().lens();
+        if(lens.size() != pd.second.size())
+            MIGRAPHX_THROW("Incorrect rank for parameter: " + pd.first);
+        const auto& fixed_lens = parameter_shapes.at(pd.first).lens();
+        for(std::size_t i = 0; i < lens.size(); i++)
+        {
+            const auto& name = pd.second[i];
+            if(not name.empty())
+                sizes[name] = std::max(sizes[name], lens[i]);
+            // The axes that are not bucketed are not padded
+            else if(lens[i] != fixed_lens[i])
+                MIGRAPHX_THROW("Incorrect size " + std::to_string(lens[i]) + " for axis " +
+                               std::to_string(i) + " of parameter " + pd.first + ", expected " +
+                               std::to_string(fixed_lens[i]));
+        }
+    }
+    auto bucket      = find_bucket(sizes);
+    const auto& prog = get_program(bucket);
+
+    parameter_map padded;
+    for(auto&& x : params)
+    {
+        if(not contains(options.parameter_dims, x.first))
+        {
+            padded[x.first] = x.second;
+            continue;
+        }
+        auto s = prog.get_parameter_shape(x.first);
+        if(x.second.get_shape().lens() == s.lens())
+        {
+            padded[x.first] = x.second;
+            continue;
+        }
+        if(x.second.get_shape().type() != s.type())
+            MIGRAPHX_THROW("Incorrect type for parameter: " + x.first);
+        auto arg = fill_argument(s, 0);
+        copy_overlap(x.second, arg);
+        padded[x.first] = arg;
+    }
+
+    auto results = prog.eval(padded);
+    for(std::size_t j = 0; j < std::min(results.size(), options.output_dims.size()); j++)
+    {
+        const auto& dims = options.output_dims[j];
+        if(dims.empty())
+            continue;
+        auto s    = results[j].get_shape();
+        auto lens = s.lens();
+        if(lens.size() != dims.size())
+            MIGRAPHX_THROW("Dimensions for output " + std::to_string(j) + " do not match its rank");
+        for(std::size_t i = 0; i < lens.size(); i++)
+        {
+            if(not dims[i].empty() and contains(sizes, dims[i]))
+                lens[i] = sizes.at(dims[i]);
+        }
+        if(lens == s.lens())
+            continue;
+        argument cropped{shape{s.type(), lens}};
+        copy_overlap(results[j], cropped);
+        results[j] = cropped;
+    }
+    return results;
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
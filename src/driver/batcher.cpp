@@ -0,0 +1,242 @@
+#include "batcher.hpp"
+
+#include <migraphx/ranges.hpp>
+#include <migraphx/stringutils.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace migraphx {
+namespace driver {
+inline namespace MIGRAPHX_INLINE_NS {
+
+static shape with_batch(const shape& s, std::size_t batch)
+{
+    auto lens    = s.lens();
+    lens.front() = batch;
+    return {s.type(), lens};
+}
+
+// Finds what is batched by comparing the first dimension across the programs, with a single
+// program everything whose first dimension is the batch size is assumed to be batched
+template <class F>
+static bool is_batched(const std::map<std::size_t, program>& programs, F get_shape)
+{
+    auto first = get_shape(programs.begin()->second);
+    if(first.lens().empty())
+        return false;
+    if(programs.size() == 1)
+        return first.lens().front() == programs.begin()->first;
+    return std::any_of(std::next(programs.begin()), programs.end(), [&](auto&& pp) {
+        return get_shape(pp.second).lens().front() != first.lens().front();
+    });
+}
+
+batcher::batcher(std::map<std::size_t, program> progs,
+                 std::chrono::microseconds delay,
+                 std::size_t nworkers)
+    : programs(std::move(progs)), max_delay(delay), use_sessions(nworkers > 1)
+{
+    if(programs.empty())
+        MIGRAPHX_THROW("No programs to batch");
+    max_batch = programs.rbegin()->first;
+    for(auto&& ps : programs.begin()->second.get_parameter_shapes())
+    {
+        auto name = ps.first;
+        if(not is_batched(programs, [&](const program& p) { return p.get_parameter_shape(name); }))
+            continue;
+        for(auto&& pp : programs)
+        {
+            if(not pp.second.get_parameter_shape(name).standard())
+                MIGRAPHX_THROW("Batched parameter " + name + " is not standard");
+        }
+        batched_params.insert(name);
+    }
+    auto noutputs = programs.begin()->second.get_output_shapes().size();
+    for(std::size_t i = 0; i < noutputs; i++)
+    {
+        if(is_batched(programs, [&](const program& p) { return p.get_output_shapes().at(i); }))
+            batched_outputs.insert(i);
+    }
+    for(std::size_t i = 0; i < std::max<std::size_t>(nworkers, 1); i++)
+        workers.emplace_back([this] { this->work(); });
+}
+
+batcher::~batcher() { stop(); }
+
+std::unordered_map<std::string, shape> batcher::get_request_shapes() const
+{
+    auto result = programs.begin()->second.get_parameter_shapes();
+    for(auto&& name : batched_params)
+        result[name] = with_batch(result[name], 1);
+    return result;
+}
+
+std::future<std::vector<argument>> batcher::submit(parameter_map params)
+{
+    request r;
+    r.params  = std::move(params);
+    r.arrival = clock::now();
+    auto f    = r.result.get_future();
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if(stopped)
+            MIGRAPHX_THROW("Request submitted to a stopped batcher");
+        queue.push_back(std::move(r));
+    }
+    cv.notify_all();
+    return f;
+}
+
+void batcher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stopped = true;
+    }
+    cv.notify_all();
+    for(auto& w : workers)
+    {
+        if(w.joinable())
+            w.join();
+    }
+}
+
+batcher_stats batcher::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(m);
+    return stats;
+}
+
+void batcher::work()
+{
+    std::vector<session> sessions;
+    if(use_sessions)
+    {
+        std::transform(programs.begin(),
+                       programs.end(),
+                       std::back_inserter(sessions),
+                       [](auto&& pp) { return session{pp.second}; });
+    }
+    for(;;)
+    {
+        std::vector<request> batch;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&] { return stopped or not queue.empty(); });
+            if(queue.empty())
+                return;
+            auto deadline = queue.front().arrival + max_delay;
+            cv.wait_until(lock, deadline, [&] { return stopped or queue.size() >= max_batch; });
+            // Another worker could have taken the requests while waiting
+            if(queue.empty())
+                continue;
+            auto n = std::min(queue.size(), max_batch);
+            std::move(queue.begin(), queue.begin() + n, std::back_inserter(batch));
+            queue.erase(queue.begin(), queue.begin() + n);
+        }
+        // The other workers can form a batch from the requests left in the queue
+        cv.notify_all();
+        run_batch(batch, sessions);
+    }
+}
+
+void batcher::run_batch(std::vector<request>& batch, std::vector<session>& sessions)
+{
+    auto it         = programs.lower_bound(batch.size());
+    auto b          = it->first;
+    const auto& p   = it->second;
+    auto index      = std::distance(programs.begin(), it);
+    auto set_result = [&](auto f) {
+        auto finished = clock::now();
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stats.batches[b]++;
+            stats.padding += b - batch.size();
+            for(auto&& r : batch)
+            {
+                using ms = std::chrono::duration<double, std::milli>;
+                stats.latencies_ms.push_back(ms{finished - r.arrival}.count());
+            }
+        }
+        for(std::size_t i = 0; i < batch.size(); i++)
+            f(i, batch[i].result);
+    };
+    try
+    {
+        parameter_map params;
+        for(auto&& ps : p.get_parameter_shapes())
+        {
+            const auto& name = ps.first;
+            if(not contains(batched_params, name))
+            {
+                params[name] = batch.front().params.at(name);
+                continue;
+            }
+            argument arg{ps.second};
+            auto row_bytes = ps.second.bytes() / b;
+            for(std::size_t i = 0; i < batch.size(); i++)
+            {
+                const auto& x = batch[i].params.at(name);
+                if(x.get_shape() != with_batch(ps.second, 1))
+                    MIGRAPHX_THROW("Incorrect shape {" + to_string(x.get_shape()) +
+                                   "} for request parameter: " + name);
+                std::memcpy(arg.data() + i * row_bytes, x.data(), row_bytes);
+            }
+            std::fill(arg.data() + batch.size() * row_bytes, arg.data() + ps.second.bytes(), 0);
+            params[name] = arg;
+        }
+        std::vector<argument> results;
+        if(use_sessions)
+        {
+            auto& s = sessions.at(index);
+            results = s.eval(params);
+            s.get_context().finish();
+        }
+        else
+        {
+            results = p.eval(params);
+            p.get_context().finish();
+        }
+        // Copy the outputs since they can point to memory that is reused by the next batch
+        std::vector<std::vector<argument>> outputs(batch.size());
+        for(std::size_t j = 0; j < results.size(); j++)
+        {
+            const auto& r = results[j];
+            if(not contains(batched_outputs, j))
+            {
+                auto x = r.copy();
+                for(auto& output : outputs)
+                    output.push_back(x);
+                continue;
+            }
+            auto s         = with_batch(r.get_shape(), 1);
+            auto row_bytes = s.bytes();
+            for(std::size_t i = 0; i < batch.size(); i++)
+            {
+                argument x{s};
+                if(r.get_shape().standard())
+                {
+                    std::memcpy(x.data(), r.data() + i * row_bytes, row_bytes);
+                }
+                else
+                {
+                    visit_all(x, r)([&](auto y, auto v) {
+                        for(std::size_t k = 0; k < y.size(); k++)
+                            y[k] = v[i * y.size() + k];
+                    });
+                }
+                outputs[i].push_back(x);
+            }
+        }
+        set_result([&](std::size_t i, auto& result) { result.set_value(outputs[i]); });
+    }
+    catch(...)
+    {
+        auto e = std::current_exception();
+        set_result([&](std::size_t, auto& result) { result.set_exception(e); });
+    }
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace driver
+} // namespace migraphx
@@ -0,0 +1,88 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_DRIVER_BATCHER_HPP
+#define MIGRAPHX_GUARD_RTGLIB_DRIVER_BATCHER_HPP
+
+#include <migraphx/program.hpp>
+#include <migraphx/session.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace migraphx {
+namespace driver {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct batcher_stats
+{
+    // Time from submitting each request until its results are ready
+    std::vector<double> latencies_ms;
+    // Number of batches run for each batch size
+    std::map<std::size_t, std::size_t> batches;
+    // Unused rows in the batches that were run
+    std::size_t padding = 0;
+};
+
+// Runs single requests in batches. Requests are queued until the largest batch is full or the
+// oldest one has waited for max_delay. The waiting requests then run with the smallest program
+// whose batch fits them, the unused rows are zero-filled, and each request gets its rows of the
+// outputs.
+//
+// The programs are compiled from the same model for different batch sizes, where an input or
+// output is batched when its first dimension changes with the batch size. With more than one
+// worker, each worker runs its batches in its own sessions of the programs.
+struct batcher
+{
+    using clock = std::chrono::steady_clock;
+
+    batcher(std::map<std::size_t, program> progs,
+            std::chrono::microseconds delay,
+            std::size_t nworkers = 1);
+    batcher(const batcher&) = delete;
+    batcher& operator=(const batcher&) = delete;
+    ~batcher();
+
+    // Shapes of the parameters for a single request
+    std::unordered_map<std::string, shape> get_request_shapes() const;
+
+    std::future<std::vector<argument>> submit(parameter_map params);
+
+    // Waits for the queued requests to finish, no more requests can be submitted after this
+    void stop();
+
+    batcher_stats get_stats() const;
+
+    private:
+    struct request
+    {
+        parameter_map params;
+        std::promise<std::vector<argument>> result;
+        clock::time_point arrival;
+    };
+
+    void work();
+    void run_batch(std::vector<request>& batch, std::vector<session>& sessions);
+
+    std::map<std::size_t, program> programs;
+    std::chrono::microseconds max_delay;
+    std::size_t max_batch = 0;
+    std::set<std::string> batched_params;
+    std::set<std::size_t> batched_outputs;
+    bool use_sessions = false;
+
+    mutable std::mutex m;
+    std::condition_variable cv;
+    std::deque<request> queue;
+    bool stopped = false;
+    batcher_stats stats;
+    std::vector<std::thread> workers;
+};
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace driver
+} // namespace migraphx
+
+#endif
@@ -0,0 +1,136 @@
+#include "bench.hpp"
+#include "perf.hpp"
+#include "models.hpp"
+
+#include <migraphx/eliminate_common_subexpression.hpp>
+#include <migraphx/errors.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/literal.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/pass_manager.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/time.hpp>
+
+namespace migraphx {
+namespace driver {
+inline namespace MIGRAPHX_INLINE_NS {
+
+using milliseconds = std::chrono::duration<double, std::milli>;
+
+// Runs f once first, so allocations made on the first run are not timed
+template <class F>
+double average_time(unsigned n, F f)
+{
+    f();
+    auto total = time<milliseconds>([&] {
+        for(unsigned i = 0; i < n; i++)
+            f();
+    });
+    return total / n;
+}
+
+// A loop with a small body, so evaluating the body costs more than its computation
+static program create_loop_program(int64_t iterations)
+{
+    program p;
+    auto* mm = p.get_main_module();
+    shape si{shape::int64_type};
+    shape sc{shape::bool_type};
+    shape s{shape::float_type, {1, 64}};
+    auto iter_num = mm->add_parameter("iter_num", si);
+    auto cond     = mm->add_parameter("cond", sc);
+    auto x        = mm->add_parameter("x", s);
+
+    auto* body = p.create_module("loop_body");
+    body->add_parameter("#loop_body_in_0", si);
+    auto bcond = body->add_parameter("#loop_body_in_1", sc);
+    auto bx    = body->add_parameter("#loop_body_in_2", s);
+    auto w     = body->add_literal(generate_literal(s, 1));
+    auto mul   = body->add_instruction(make_op("mul"), bx, w);
+    auto add   = body->add_instruction(make_op("add"), mul, w);
+    auto y     = body->add_instruction(make_op("tanh"), add);
+    body->add_return({bcond, y});
+
+    auto l = mm->add_instruction(
+        make_op("loop", {{"max_iterations", iterations}}), {iter_num, cond, x}, {body});
+    auto r = mm->add_instruction(make_op("get_tuple_elem", {{"index", 0}}), l);
+    mm->add_return({r});
+    return p;
+}
+
+static double bench_loop(const target& t, unsigned n)
+{
+    int64_t iterations = 500;
+    auto p             = create_loop_program(iterations);
+    compile_options options;
+    options.offload_copy = true;
+    p.compile(t, options);
+    auto m        = create_param_map(p, t, true);
+    m["iter_num"] = literal{iterations}.get_argument();
+    m["cond"]     = literal{true}.get_argument();
+    return average_time(n, [&] { p.eval(m); });
+}
+
+// Slices with distinct attributes, each used by two equal adds whose sums are multiplied, so every
+// instruction has to be compared with others of the same operator
+static module create_cse_module(std::size_t instructions)
+{
+    module m;
+    std::size_t n = instructions / 5;
+    auto x        = m.add_parameter("x", shape{shape::float_type, {n + 1}});
+    auto slice    = [&](std::size_t i) {
+        return m.add_instruction(
+            make_op("slice", {{"axes", {0}}, {"starts", {i}}, {"ends", {i + 1}}}), x);
+    };
+    auto prod = slice(0);
+    for(std::size_t i = 1; i <= n; i++)
+    {
+        auto add1 = m.add_instruction(make_op("add"), slice(i), prod);
+        auto add2 = m.add_instruction(make_op("add"), slice(i), prod);
+        prod      = m.add_instruction(make_op("mul"), add1, add2);
+    }
+    m.add_return({prod});
+    return m;
+}
+
+// Only the pass is timed, since it modifies the module
+static double bench_cse(const target&, unsigned n)
+{
+    double total = 0;
+    for(unsigned i = 0; i < n; i++)
+    {
+        auto m = create_cse_module(100000);
+        total += time<milliseconds>([&] { run_passes(m, {eliminate_common_subexpression{}}); });
+    }
+    return total / n;
+}
+
+// Converts a program to a value and back, as saving and loading it do
+static double bench_value(const target&, unsigned n)
+{
+    auto p = resnet50(1);
+    return average_time(n, [&] {
+        program p2;
+        p2.from_value(p.to_value());
+    });
+}
+
+const std::map<std::string, bench_case>& get_bench_cases()
+{
+    static const std::map<std::string, bench_case> cases = {
+        {"cse", &bench_cse}, {"loop", &bench_loop}, {"value", &bench_value}};
+    return cases;
+}
+
+double run_bench_case(const std::string& name, const target& t, unsigned n)
+{
+    auto it = get_bench_cases().find(name);
+    if(it == get_bench_cases().end())
+        MIGRAPHX_THROW("Unknown bench case: " + name);
+    return it->second(t, n);
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace driver
+} // namespace migraphx
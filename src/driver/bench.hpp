@@ -0,0 +1,24 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_DRIVER_BENCH_HPP
+#define MIGRAPHX_GUARD_RTGLIB_DRIVER_BENCH_HPP
+
+#include <migraphx/target.hpp>
+#include <functional>
+#include <map>
+#include <string>
+
+namespace migraphx {
+namespace driver {
+inline namespace MIGRAPHX_INLINE_NS {
+
+/// Runs a benchmark n times on the target and returns the average time of one run in milliseconds
+using bench_case = std::function<double(const target& t, unsigned n)>;
+
+const std::map<std::string, bench_case>& get_bench_cases();
+
+double run_bench_case(const std::string& name, const target& t, unsigned n);
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace driver
+} // namespace migraphx
+
+#endif
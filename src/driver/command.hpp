@@ -7,6 +7,7 @@
 #include <migraphx/type_name.hpp>
 #include <migraphx/stringutils.hpp>
 
+#include <algorithm>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -31,6 +32,7 @@ std::string compute_command_name()
         name = name.substr(0, name.size() - 8);
     if(ends_with(name, "_cmd"))
         name = name.substr(0, name.size() - 4);
+    std::replace(name.begin(), name.end(), '_', '-');
     return name;
 }
 
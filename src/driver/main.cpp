@@ -1,4 +1,6 @@
 #include "verify.hpp"
+#include "bench.hpp"
+#include "batcher.hpp"
 #include "argument_parser.hpp"
 #include "command.hpp"
 #include "precision.hpp"
@@ -27,6 +29,7 @@
 #include <migraphx/register_target.hpp>
 
 #include <fstream>
+#include <random>
 
 namespace migraphx {
 namespace driver {
@@ -94,6 +97,10 @@ struct loader
            {"--binary"},
            ap.help("Print out program in binary format."),
            ap.set_value("binary"));
+        ap(output_type,
+           {"--mmap"},
+           ap.help("Save program in a format that can be memory mapped when loaded."),
+           ap.set_value("mmap"));
         ap(output, {"--output", "-o"}, ap.help("Output to file."));
     }
 
@@ -214,6 +221,15 @@ struct loader
 
     void save(const program& p) const
     {
+        if(output_type == "mmap")
+        {
+            if(output.empty())
+                MIGRAPHX_THROW("An output file is needed to save in the mmap format");
+            file_options options;
+            options.format = "mmap";
+            migraphx::save(p, output, options);
+            return;
+        }
         auto* os = &std::cout;
         std::ofstream fs;
         if(not output.empty())
@@ -485,6 +501,136 @@ struct perf : command<perf>
     }
 };
 
+struct bench : command<bench>
+{
+    compiler_target ct;
+    std::vector<std::string> cases;
+    unsigned n = 10;
+    bool list  = false;
+    void parse(argument_parser& ap)
+    {
+        ap(cases, {}, ap.metavar("<bench cases>"), ap.append());
+        ct.parse(ap);
+        ap(n, {"--iterations", "-n"}, ap.help("Number of iterations to run each case"));
+        ap(list, {"--list", "-l"}, ap.help("List the bench cases"), ap.set_value(true));
+    }
+
+    void run()
+    {
+        if(list)
+        {
+            for(auto&& x : get_bench_cases())
+                std::cout << x.first << std::endl;
+            return;
+        }
+        if(cases.empty())
+        {
+            for(auto&& x : get_bench_cases())
+                cases.push_back(x.first);
+        }
+        auto t = ct.get_target();
+        for(auto&& name : cases)
+            std::cout << name << ": " << run_bench_case(name, t, n) << "ms" << std::endl;
+    }
+};
+
+struct serve_bench : command<serve_bench>
+{
+    compiler c;
+    std::vector<std::string> batch_sizes;
+    double rate       = 100;
+    unsigned n        = 1000;
+    double max_delay  = 5;
+    unsigned nworkers = 1;
+    void parse(argument_parser& ap)
+    {
+        c.parse(ap);
+        ap(batch_sizes,
+           {"--batch-sizes"},
+           ap.help("Batch sizes to compile the model for (default: 1 2 4 8)"),
+           ap.append(),
+           ap.nargs(2));
+        ap(rate, {"--rate"}, ap.help("Average number of requests per second"));
+        ap(n, {"--requests", "-n"}, ap.help("Number of requests to send"));
+        ap(max_delay,
+           {"--max-delay"},
+           ap.help("Milliseconds a request can wait for a batch to fill up"));
+        ap(nworkers, {"--workers"}, ap.help("Number of batches that can run at the same time"));
+    }
+
+    program compile_batch(std::size_t batch) const
+    {
+        auto bc    = c;
+        bc.l.batch = batch;
+        // Use the batch size for the first dimension of each parameter set with --input-dim
+        for(auto it = bc.l.param_dims.begin(); it != bc.l.param_dims.end(); ++it)
+        {
+            if(it->front() == '@' and std::next(it) != bc.l.param_dims.end())
+                *std::next(it) = std::to_string(batch);
+        }
+        return bc.compile();
+    }
+
+    void run()
+    {
+        if(n == 0)
+            MIGRAPHX_THROW("At least one request is needed");
+        if(batch_sizes.empty())
+            batch_sizes = {"1", "2", "4", "8"};
+        // The requests are host buffers
+        c.offload_copy = true;
+        std::map<std::size_t, program> programs;
+        for(auto&& x : batch_sizes)
+        {
+            auto batch = value_parser<std::size_t>::apply(x);
+            std::cout << "Compiling for batch " << batch << " ... " << std::endl;
+            programs[batch] = compile_batch(batch);
+        }
+        using microseconds = std::chrono::microseconds;
+        batcher b{std::move(programs),
+                  microseconds{static_cast<std::int64_t>(max_delay * 1000)},
+                  nworkers};
+
+        parameter_map params;
+        for(auto&& x : b.get_request_shapes())
+            params[x.first] = generate_argument(x.second, std::hash<std::string>{}(x.first));
+
+        std::cout << "Sending " << n << " requests at " << rate << " requests/s ... "
+                  << std::endl;
+        std::mt19937 gen{0};
+        std::exponential_distribution<double> interval{rate};
+        std::vector<std::future<std::vector<argument>>> results;
+        auto start   = std::chrono::steady_clock::now();
+        auto arrival = start;
+        for(unsigned i = 0; i < n; i++)
+        {
+            std::this_thread::sleep_until(arrival);
+            results.push_back(b.submit(params));
+            arrival += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>{interval(gen)});
+        }
+        for(auto&& r : results)
+            r.get();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        b.stop();
+
+        auto stats = b.get_stats();
+        auto& latencies = stats.latencies_ms;
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double x) {
+            return latencies[std::min<std::size_t>(x * latencies.size(), latencies.size() - 1)];
+        };
+        std::cout << "Throughput: " << n / elapsed.count() << " requests/s" << std::endl;
+        std::cout << "Latency p50: " << percentile(0.5) << "ms" << std::endl;
+        std::cout << "Latency p99: " << percentile(0.99) << "ms" << std::endl;
+        std::cout << "Latency max: " << latencies.back() << "ms" << std::endl;
+        std::cout << "Batches:" << std::endl;
+        for(auto&& x : stats.batches)
+            std::cout << "    " << x.first << ": " << x.second << std::endl;
+        std::cout << "Padded rows: " << stats.padding << std::endl;
+    }
+};
+
 struct roctx : command<roctx>
 {
     compiler c;
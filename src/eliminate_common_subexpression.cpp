@@ -4,45 +4,110 @@
 #include <migraphx/iterator_for.hpp>
 #include <migraphx/ranges.hpp>
 #include <migraphx/functional.hpp>
+#include <migraphx/value.hpp>
 
-#include <unordered_set>
+#include <unordered_map>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
-template <class Range>
-void cse_range(module& p, Range&& r)
+static std::size_t hash_combine(std::size_t seed, std::size_t x)
 {
-    std::unordered_multimap<std::string, instruction_ref> instructions;
-    std::unordered_set<instruction_ref> processed_ins;
-    for(auto ins : r)
+    return seed ^ (x + 0x9e3779b9 + (seed << 6u) + (seed >> 2u));
+}
+
+// Number of elements of a literal used for its hash, so large weights are not hashed entirely
+constexpr std::size_t literal_hash_elements = 16;
+
+static std::size_t hash_literal(const literal& l)
+{
+    std::size_t result = 0;
+    l.visit([&](auto v) {
+        auto n = std::min(v.size(), literal_hash_elements);
+        for(std::size_t i = 0; i < n; i++)
+        {
+            auto x = static_cast<double>(v[i]);
+            // Literals are compared by value, so 0 and -0 must hash the same
+            result = hash_combine(result, std::hash<double>{}(x == 0 ? 0.0 : x));
+        }
+    });
+    return result;
+}
+
+template <class T>
+static std::size_t hash_scalar(const T&)
+{
+    return 0;
+}
+
+static std::size_t hash_scalar(std::int64_t x) { return std::hash<std::uint64_t>{}(x); }
+
+static std::size_t hash_scalar(std::uint64_t x) { return std::hash<std::uint64_t>{}(x); }
+
+// Values are compared by value, so 0 and -0 must hash the same
+static std::size_t hash_scalar(double x) { return std::hash<double>{}(x == 0 ? 0.0 : x); }
+
+static std::size_t hash_scalar(bool x) { return std::hash<bool>{}(x); }
+
+static std::size_t hash_scalar(const std::string& x) { return std::hash<std::string>{}(x); }
+
+static std::size_t hash_value(const value& v)
+{
+    std::size_t result = std::hash<std::string>{}(v.get_key());
+    if(v.is_object() or v.is_array())
+    {
+        for(const auto& x : v)
+            result = hash_combine(result, hash_value(x));
+        return result;
+    }
+    v.visit_value([&](const auto& x) { result = hash_combine(result, hash_scalar(x)); });
+    return result;
+}
+
+// Structural hash of an instruction, equal instructions always have the same hash. The operator
+// attributes are hashed as well, so operators like slice that are used many times with different
+// attributes do not all end up with the same hash.
+static std::size_t hash_instruction(instruction_ref ins)
+{
+    std::size_t result = std::hash<std::string>{}(ins->name());
+    // Literals are hashed from their data below
+    if(ins->name().front() != '@')
+        result = hash_combine(result, hash_value(ins->get_operator().to_value()));
+    auto s             = ins->get_shape();
+    result             = hash_combine(result, s.type());
+    result             = hash_combine(result, s.elements());
+    for(auto input : ins->inputs())
+        result = hash_combine(result, std::hash<instruction_ref>{}(input));
+    for(auto* smod : ins->module_inputs())
+        result = hash_combine(result, std::hash<module_ref>{}(smod));
+    if(ins->name() == "@literal")
+        result = hash_combine(result, hash_literal(ins->get_literal()));
+    return result;
+}
+
+// Instructions are visited in order, so the inputs of an instruction have already been replaced
+// by the first instruction equal to them. This means two instructions computing the same value
+// have the same inputs, and a single pass finds all of them.
+void eliminate_common_subexpression::apply(module& p) const
+{
+    std::unordered_multimap<std::size_t, instruction_ref> instructions;
+    for(auto ins : iterator_for(p))
     {
         // Skip dead instructions
         if(ins->outputs().empty())
             continue;
 
-        // Find instruction with the same name
-        auto found_instructions = range(instructions.equal_range(ins->name()));
-        for(const auto& pp : found_instructions)
-        {
-            auto eq = pp.second;
-            if(contains(processed_ins, eq))
-                continue;
-            if(*eq != *ins)
-                continue;
-            p.replace_instruction(ins, eq);
-            processed_ins.emplace(ins);
-            auto outputs = eq->outputs();
-            std::sort(outputs.begin(), outputs.end(), [&](auto x, auto y) {
-                return std::distance(eq, x) < std::distance(eq, y);
-            });
-            cse_range(p, outputs);
-        }
-        instructions.emplace(ins->name(), ins);
+        auto h          = hash_instruction(ins);
+        auto candidates = range(instructions.equal_range(h));
+        auto eq         = std::find_if(candidates.begin(), candidates.end(), [&](const auto& pp) {
+            return *pp.second == *ins;
+        });
+        if(eq != candidates.end())
+            p.replace_instruction(ins, eq->second);
+        else
+            instructions.emplace(h, ins);
     }
 }
 
-void eliminate_common_subexpression::apply(module& p) const { cse_range(p, iterator_for(p)); }
-
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
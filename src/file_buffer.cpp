@@ -2,6 +2,10 @@
 #include <migraphx/errors.hpp>
 #include <fstream>
 #include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -31,6 +35,29 @@ std::string read_string(const std::string& filename)
     return generic_read_file<std::string>(filename);
 }
 
+mapped_file map_file(const std::string& filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY); // NOLINT
+    if(fd < 0)
+        MIGRAPHX_THROW("Error opening file: " + filename);
+    struct stat st = {};
+    if(fstat(fd, &st) != 0 or st.st_size < 1)
+    {
+        close(fd);
+        MIGRAPHX_THROW("Invalid size for: " + filename);
+    }
+    mapped_file result;
+    result.size = st.st_size;
+    void* p     = mmap(nullptr, result.size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+    if(p == MAP_FAILED) // NOLINT
+        MIGRAPHX_THROW("Error mapping file: " + filename);
+    auto size   = result.size;
+    result.data = std::shared_ptr<char>(static_cast<char*>(p), [=](char* x) { munmap(x, size); });
+    return result;
+}
+
 void write_buffer(const std::string& filename, const char* buffer, std::size_t size)
 {
     std::ofstream os(filename);
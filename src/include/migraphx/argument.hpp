@@ -6,6 +6,7 @@
 #include <migraphx/config.hpp>
 #include <migraphx/make_shared_array.hpp>
 #include <functional>
+#include <memory>
 #include <utility>
 
 // clang-format off
@@ -43,7 +44,10 @@ struct argument : raw_data<argument>
     argument(shape s, std::shared_ptr<T> d)
         : m_shape(std::move(s))
     {
-        assign_buffer([d] { return reinterpret_cast<char*>(d.get()); });
+        // Only capture the pointer so copying the argument doesn't copy the shared_ptr into the
+        // function, the data is kept alive by the owner
+        auto* p = reinterpret_cast<char*>(d.get());
+        assign_buffer([p] { return p; }, std::move(d));
     }
 
     argument(shape s, std::nullptr_t);
@@ -71,11 +75,12 @@ struct argument : raw_data<argument>
     argument element(std::size_t i) const;
 
     private:
-    void assign_buffer(std::function<char*()> d);
+    void assign_buffer(std::function<char*()> d, std::shared_ptr<const void> owner = nullptr);
     struct data_t
     {
         std::function<char*()> get = nullptr;
         std::vector<data_t> sub = {};
+        std::shared_ptr<const void> owner = nullptr;
         data_t share() const;
         static data_t from_args(const std::vector<argument>& args);
     };
@@ -0,0 +1,149 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_BF16_HPP
+#define MIGRAPHX_GUARD_RTGLIB_BF16_HPP
+
+#include <migraphx/half.hpp>
+#include <migraphx/config.hpp>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+/// Brain floating point, the upper 16 bits of a float. It is stored as its bits and the
+/// arithmetic is done in float.
+struct bf16
+{
+    std::uint16_t bits = 0;
+
+    constexpr bf16() = default;
+    explicit bf16(float f) : bits(from_float(f)) {}
+
+    bf16& operator=(float f)
+    {
+        bits = from_float(f);
+        return *this;
+    }
+
+    operator float() const { return to_float(bits); }
+
+    static constexpr bf16 from_bits(std::uint16_t b) { return bf16{b, from_bits_tag{}}; }
+
+    static std::uint16_t from_float(float f)
+    {
+        std::uint32_t x = 0;
+        std::memcpy(&x, &f, sizeof(x));
+        // Keep nan a quiet nan, since rounding could turn it into inf
+        if((x & 0x7fffffffu) > 0x7f800000u)
+            return static_cast<std::uint16_t>((x >> 16u) | 0x40u);
+        // Round to nearest even
+        x += 0x7fffu + ((x >> 16u) & 1u);
+        return static_cast<std::uint16_t>(x >> 16u);
+    }
+
+    static float to_float(std::uint16_t b)
+    {
+        std::uint32_t x = std::uint32_t{b} << 16u;
+        float f         = 0;
+        std::memcpy(&f, &x, sizeof(f));
+        return f;
+    }
+
+#define MIGRAPHX_BF16_ASSIGN_OP(op)             \
+    template <class T>                          \
+    bf16& operator op##=(const T& x)            \
+    {                                           \
+        *this = bf16(float(*this) op float(x)); \
+        return *this;                           \
+    }
+    MIGRAPHX_BF16_ASSIGN_OP(+)
+    MIGRAPHX_BF16_ASSIGN_OP(-)
+    MIGRAPHX_BF16_ASSIGN_OP(*)
+    MIGRAPHX_BF16_ASSIGN_OP(/)
+#undef MIGRAPHX_BF16_ASSIGN_OP
+
+    private:
+    struct from_bits_tag
+    {
+    };
+    constexpr bf16(std::uint16_t b, from_bits_tag) : bits(b) {}
+};
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+namespace std {
+
+template <class T>
+struct common_type<migraphx::bf16, T> : std::common_type<float, T>
+{
+};
+
+template <class T>
+struct common_type<T, migraphx::bf16> : std::common_type<float, T>
+{
+};
+
+template <>
+struct common_type<migraphx::bf16, migraphx::bf16>
+{
+    using type = migraphx::bf16;
+};
+
+template <>
+struct common_type<migraphx::bf16, migraphx::half>
+{
+    using type = float;
+};
+
+template <>
+struct common_type<migraphx::half, migraphx::bf16>
+{
+    using type = float;
+};
+
+template <>
+class numeric_limits<migraphx::bf16>
+{
+    using bf16 = migraphx::bf16;
+
+    public:
+    static constexpr bool is_specialized           = true;
+    static constexpr bool is_signed                = true;
+    static constexpr bool is_integer               = false;
+    static constexpr bool is_exact                 = false;
+    static constexpr bool has_infinity             = true;
+    static constexpr bool has_quiet_NaN            = true;
+    static constexpr bool has_signaling_NaN        = true;
+    static constexpr float_denorm_style has_denorm = denorm_present;
+    static constexpr bool has_denorm_loss          = false;
+    static constexpr float_round_style round_style = round_to_nearest;
+    static constexpr bool is_iec559                = false;
+    static constexpr bool is_bounded               = true;
+    static constexpr bool is_modulo                = false;
+    static constexpr int digits                    = 8;
+    static constexpr int digits10                  = 2;
+    static constexpr int max_digits10              = 4;
+    static constexpr int radix                     = 2;
+    static constexpr int min_exponent              = -125;
+    static constexpr int min_exponent10            = -37;
+    static constexpr int max_exponent              = 128;
+    static constexpr int max_exponent10            = 38;
+    static constexpr bool traps                    = false;
+    static constexpr bool tinyness_before          = false;
+
+    static constexpr bf16 min() noexcept { return bf16::from_bits(0x0080); }
+    static constexpr bf16 lowest() noexcept { return bf16::from_bits(0xff7f); }
+    static constexpr bf16 max() noexcept { return bf16::from_bits(0x7f7f); }
+    static constexpr bf16 epsilon() noexcept { return bf16::from_bits(0x3c00); }
+    static constexpr bf16 round_error() noexcept { return bf16::from_bits(0x3f00); }
+    static constexpr bf16 infinity() noexcept { return bf16::from_bits(0x7f80); }
+    static constexpr bf16 quiet_NaN() noexcept { return bf16::from_bits(0x7fc0); }
+    static constexpr bf16 signaling_NaN() noexcept { return bf16::from_bits(0x7fa0); }
+    static constexpr bf16 denorm_min() noexcept { return bf16::from_bits(0x0001); }
+};
+
+} // namespace std
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef MIGRAPHX_GUARD_MIGRAPHX_BUCKETED_PROGRAM_HPP
+#define MIGRAPHX_GUARD_MIGRAPHX_BUCKETED_PROGRAM_HPP
+
+#include <migraphx/config.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/target.hpp>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct bucket_options
+{
+    /// Sizes to compile the program for, for each variable dimension. A program is compiled for
+    /// every combination of the sizes.
+    std::unordered_map<std::string, std::vector<std::size_t>> buckets = {};
+    /// Name of the variable dimension used by each axis of a parameter, or an empty string for an
+    /// axis with a fixed size
+    std::unordered_map<std::string, std::vector<std::string>> parameter_dims = {};
+    /// Name of the variable dimension used by each axis of the outputs. Outputs that are not
+    /// listed are returned as they are computed for the bucket.
+    std::vector<std::vector<std::string>> output_dims = {};
+    compile_options options = compile_options{};
+    /// Compile the program for a bucket the first time it is used
+    bool lazy = false;
+    /// Directory where compiled buckets are saved, and loaded from when they already exist. The
+    /// file names include a hash of the model and of the compile options.
+    std::string cache_dir = "";
+};
+
+/**
+ * @brief Runs inputs of varying sizes with programs compiled for a fixed set of sizes
+ * @details The program for a bucket is created by calling the factory with the dims of the
+ * bucketed parameters, in the same form as `onnx_options::map_input_dims`. Each input is run with
+ * the smallest bucket that fits it: the inputs are padded with zeros up to the sizes of the bucket,
+ * and the outputs listed in `bucket_options::output_dims` are cut back to the sizes of the inputs.
+ * The padding is only invisible to ops that compute each output element from the matching input
+ * elements. Ops that reduce over a padded axis see the zeros, so softmax, mean or attention
+ * without a mask over that axis give different results than the unpadded input would.
+ *
+ * Literals with the same contents are shared between the programs before they are compiled, so
+ * the weights are only stored once. Constants computed while compiling, and buckets loaded from
+ * the cache directory, have their own copies.
+ */
+struct bucketed_program
+{
+    using dim_map = std::map<std::string, std::size_t>;
+    using program_factory =
+        std::function<program(const std::unordered_map<std::string, std::vector<std::size_t>>&)>;
+
+    bucketed_program(program_factory f, target t, bucket_options opts);
+
+    bucketed_program(const bucketed_program&) = delete;
+    bucketed_program& operator=(const bucketed_program&) = delete;
+
+    /// Returns the sizes of every bucket
+    std::vector<dim_map> get_buckets() const;
+
+    /// Returns the smallest bucket that the sizes fit into
+    dim_map find_bucket(const dim_map& sizes) const;
+
+    /// Returns the program for a bucket, compiling it if needed
+    const program& get_program(const dim_map& bucket);
+
+    std::vector<argument> eval(const parameter_map& params);
+
+    private:
+    program create_program(const dim_map& bucket);
+    void share_literals(program& p);
+
+    program_factory factory;
+    target t;
+    bucket_options options;
+    std::unordered_map<std::string, shape> parameter_shapes;
+    // Hash of the model and the compile options, used in the names of the cached programs
+    std::string fingerprint;
+
+    std::mutex m;
+    std::map<dim_map, std::unique_ptr<program>> programs;
+    std::unordered_multimap<std::size_t, literal> literals;
+};
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
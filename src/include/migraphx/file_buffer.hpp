@@ -2,6 +2,7 @@
 #define MIGRAPHX_GUARD_RTGLIB_FILE_BUFFER_HPP
 
 #include <migraphx/config.hpp>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -11,6 +12,17 @@ inline namespace MIGRAPHX_INLINE_NS {
 std::vector<char> read_buffer(const std::string& filename);
 std::string read_string(const std::string& filename);
 
+struct mapped_file
+{
+    std::shared_ptr<char> data = nullptr;
+    std::size_t size           = 0;
+};
+
+// Maps the whole file into memory. Pages are read on first access and shared
+// with other processes mapping the same file, and writes stay private to this
+// process. The mapping is released once every copy of data is gone.
+mapped_file map_file(const std::string& filename);
+
 void write_buffer(const std::string& filename, const char* buffer, std::size_t size);
 void write_buffer(const std::string& filename, const std::vector<char>& buffer);
 
@@ -109,6 +109,10 @@ struct instruction
 
     bool need_normalization() const;
 
+    /// Replace the operator with its normalized form, so it doesn't need to be normalized on
+    /// every evaluation
+    void normalize();
+
     operation normalized_operator() const;
 
     void debug_print() const;
@@ -58,6 +58,9 @@ struct literal : raw_data<literal>
         std::copy(x, x + s.bytes(), buffer.get());
     }
 
+    /// Shares the buffer instead of copying it
+    literal(const shape& s, std::shared_ptr<char> x) : buffer(std::move(x)), m_shape(s) {}
+
     /// Whether data is available
     bool empty() const { return this->buffer == nullptr; }
 
@@ -75,6 +78,10 @@ struct literal : raw_data<literal>
         return {m_shape, [b]() { return b.get(); }};
     }
 
+    /// Convert the data to an argument that shares the buffer with the literal, so the data must
+    /// not be modified through the argument
+    argument get_shared_argument() const { return {m_shape, buffer}; }
+
     private:
     std::shared_ptr<char> buffer;
     shape m_shape;
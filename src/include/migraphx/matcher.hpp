@@ -8,9 +8,11 @@
 #include <migraphx/optional.hpp>
 #include <migraphx/iterator_for.hpp>
 #include <migraphx/type_name.hpp>
+#include <migraphx/rank.hpp>
 #include <migraphx/config.hpp>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -66,6 +68,45 @@ struct matcher_context
     module* mod = nullptr;
 };
 
+template <class M>
+auto get_root_names(rank<1>, const M& m) -> decltype(m.root_names())
+{
+    return m.root_names();
+}
+
+template <class M>
+std::vector<std::string> get_root_names(rank<0>, const M&)
+{
+    return {};
+}
+
+/// Names an instruction must have to be matched by the matcher, empty when the matcher can match
+/// any instruction
+template <class M>
+std::vector<std::string> get_root_names(const M& m)
+{
+    return get_root_names(rank<1>{}, m);
+}
+
+/// Matcher that only matches instructions with one of the root names
+template <class M>
+struct root_named_matcher
+{
+    M m;
+    std::vector<std::string> names;
+
+    auto match(matcher_context& ctx, instruction_ref ins) const { return m.match(ctx, ins); }
+
+    const std::vector<std::string>& root_names() const { return names; }
+};
+
+/// Keep the root names when a matcher is wrapped into another one
+template <class M>
+root_named_matcher<M> make_root_named_matcher(M m, std::vector<std::string> names)
+{
+    return {m, std::move(names)};
+}
+
 /// Convert a predicate function into a matcher
 template <class P>
 struct predicate_matcher
@@ -100,18 +141,20 @@ function_matcher<F> make_function_matcher(F f)
 template <class M>
 auto bind_match(M m, std::string name)
 {
-    return make_function_matcher(
-        [ =, name = std::move(name) ](matcher_context & ctx, instruction_ref ins)
-            ->optional<instruction_ref> {
-                auto result = m.match(ctx, ins);
-                if(result)
-                {
-                    if(not ctx.has_instruction(ins))
-                        return nullopt;
-                    ctx.instructions[name] = ins;
-                }
-                return result;
-            });
+    return make_root_named_matcher(
+        make_function_matcher([ =, name = std::move(name) ](matcher_context & ctx,
+                                                            instruction_ref ins)
+                                  ->optional<instruction_ref> {
+                                      auto result = m.match(ctx, ins);
+                                      if(result)
+                                      {
+                                          if(not ctx.has_instruction(ins))
+                                              return nullopt;
+                                          ctx.instructions[name] = ins;
+                                      }
+                                      return result;
+                                  }),
+        get_root_names(m));
 }
 
 /// Convert a matcher to a bindable matcher
@@ -123,6 +166,8 @@ struct bindable_matcher
     auto bind(std::string name) const { return bind_match(m, std::move(name)); }
 
     auto match(matcher_context& ctx, instruction_ref ins) const { return m.match(ctx, ins); }
+
+    std::vector<std::string> root_names() const { return get_root_names(m); }
 };
 
 /// Create a bindable matcher
@@ -167,23 +212,28 @@ struct basic_matcher
     {
         // Copy m because we cant capture `this` by value
         auto mm = m;
-        return make_bf_matcher([=](matcher_context& ctx,
-                                   instruction_ref ins) -> optional<instruction_ref> {
-            auto result = mm.match(ctx, ins);
-            if(result)
-            {
-                bool matches =
-                    fold([&](auto x, auto y) { return x and ctx.matched(y, result); })(true, ms...);
-                if(matches)
-                    return result;
-            }
-            return nullopt;
-        });
+        return make_bindable_matcher(make_root_named_matcher(
+            make_function_matcher(
+                [=](matcher_context& ctx, instruction_ref ins) -> optional<instruction_ref> {
+                    auto result = mm.match(ctx, ins);
+                    if(result)
+                    {
+                        bool matches = fold([&](auto x, auto y) {
+                            return x and ctx.matched(y, result);
+                        })(true, ms...);
+                        if(matches)
+                            return result;
+                    }
+                    return nullopt;
+                }),
+            get_root_names(m)));
     }
 
     auto bind(std::string name) const { return bind_match(m, std::move(name)); }
 
     auto match(matcher_context& ctx, instruction_ref ins) const { return m.match(ctx, ins); }
+
+    std::vector<std::string> root_names() const { return get_root_names(m); }
 };
 
 /// Create a basic matcher from a matcher
@@ -213,9 +263,16 @@ using any_matcher_base = basic_matcher<
 struct any_matcher : any_matcher_base
 {
     template <class M>
-    any_matcher(M mm) : any_matcher_base({[=](auto& ctx, auto ins) { return mm.match(ctx, ins); }})
+    any_matcher(M mm)
+        : any_matcher_base({[=](auto& ctx, auto ins) { return mm.match(ctx, ins); }}),
+          names(get_root_names(mm))
     {
     }
+
+    const std::vector<std::string>& root_names() const { return names; }
+
+    private:
+    std::vector<std::string> names;
 };
 
 /// This macro takes care of the boilerplate for defining a matcher
@@ -279,41 +336,91 @@ match::matcher_result find_match(module& modl, M&& m)
 
 MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_TRACE_MATCHES)
 
-/// Find matches for an instruction in the module
-template <class... Ms>
-void find_matches(module& mod, instruction_ref ins, Ms&&... ms)
+/// A finder together with its matcher, so the matcher is only constructed once
+template <class Finder, class M>
+struct finder_matcher
+{
+    const Finder* finder;
+    M m;
+    std::vector<std::string> names;
+};
+
+template <class Finder>
+auto make_finder_matcher(const Finder& f)
+{
+    auto m = f.matcher();
+    return finder_matcher<Finder, decltype(m)>{&f, m, get_root_names(m)};
+}
+
+/// Apply the first finder that matches the instruction, only trying the finders that are enabled
+template <class... Fs>
+bool find_matches_impl(module& mod,
+                       instruction_ref ins,
+                       const std::vector<bool>& enabled_finders,
+                       const Fs&... fs)
 {
 #if !defined(__GNUC__) || defined(__clang__) || __GNUC__ > 5
     const
 #endif
-        bool trace = enabled(MIGRAPHX_TRACE_MATCHES{});
-    bool match     = false;
+        bool trace  = enabled(MIGRAPHX_TRACE_MATCHES{});
+    bool match      = false;
+    std::size_t idx = 0;
     each_args(
-        [&](auto&& m) {
-            if(match)
+        [&](const auto& f) {
+            auto i = idx++;
+            if(match or not enabled_finders[i])
                 return;
-            auto r = match_instruction(mod, ins, m.matcher());
+            auto r = match_instruction(mod, ins, f.m);
             if(r.result == mod.end())
                 return;
             if(trace)
             {
-                std::cout << "Matched by " << get_type_name(m) << std::endl;
+                std::cout << "Matched by " << get_type_name(*f.finder) << std::endl;
                 mod.debug_print(ins);
             }
-            m.apply(mod, r);
+            f.finder->apply(mod, r);
             match = true;
         },
-        ms...);
+        fs...);
+    return match;
 }
 
-/// Find matches in a module
+/// Find matches for an instruction in the module, returns true if a finder was applied
 template <class... Ms>
-void find_matches(module& mod, Ms&&... ms)
+bool find_matches(module& mod, instruction_ref ins, Ms&&... ms)
 {
-    for(auto ins : iterator_for(mod))
-    {
-        find_matches(mod, ins, ms...);
-    }
+    std::vector<bool> enabled_finders(sizeof...(Ms), true);
+    return find_matches_impl(mod, ins, enabled_finders, make_finder_matcher(ms)...);
+}
+
+/// Find matches in a module, returns true if any finder was applied
+template <class... Ms>
+bool find_matches(module& mod, Ms&&... ms)
+{
+    auto fs = pack(make_finder_matcher(ms)...);
+    return fs([&](const auto&... f) {
+        const std::vector<const std::vector<std::string>*> names = {&f.names...};
+        // The finders tried for each operator name. Finders rooted on a name matcher are skipped
+        // for instructions with any other name, without constructing a matcher context.
+        std::unordered_map<std::string, std::vector<bool>> dispatch;
+        bool matched = false;
+        for(auto ins : iterator_for(mod))
+        {
+            auto it = dispatch.find(ins->name());
+            if(it == dispatch.end())
+            {
+                std::vector<bool> enabled_finders(names.size());
+                std::transform(
+                    names.begin(), names.end(), enabled_finders.begin(), [&](const auto* n) {
+                        return n->empty() or contains(*n, ins->name());
+                    });
+                it = dispatch.emplace(ins->name(), std::move(enabled_finders)).first;
+            }
+            if(find_matches_impl(mod, ins, it->second, f...))
+                matched = true;
+        }
+        return matched;
+    });
 }
 
 template <class M, class F>
@@ -533,11 +640,22 @@ auto skip_output(Ms... ms)
     });
 }
 
-inline auto name(std::string s)
+/// Matches instructions with one of the names
+struct name_matcher
 {
-    return make_basic_pred_matcher(
-        [ =, s = std::move(s) ](instruction_ref ins) { return ins->name() == s; });
-}
+    std::vector<std::string> names;
+
+    optional<instruction_ref> match(const matcher_context&, instruction_ref ins) const
+    {
+        if(contains(names, ins->name()))
+            return ins;
+        return nullopt;
+    }
+
+    const std::vector<std::string>& root_names() const { return names; }
+};
+
+inline auto name(std::string s) { return make_basic_matcher(name_matcher{{std::move(s)}}); }
 
 inline auto name_contains(const std::string& name)
 {
@@ -545,11 +663,9 @@ inline auto name_contains(const std::string& name)
         [=](instruction_ref ins) { return contains(ins->get_operator().name(), name); });
 }
 
-inline auto name(std::unordered_set<std::string> names)
+inline auto name(const std::unordered_set<std::string>& names)
 {
-    return make_basic_pred_matcher([ =, names = std::move(names) ](instruction_ref ins) {
-        return names.count(ins->name()) > 0;
-    });
+    return make_basic_matcher(name_matcher{{names.begin(), names.end()}});
 }
 
 template <class... Ts>
@@ -10,12 +10,21 @@ inline namespace MIGRAPHX_INLINE_NS {
 struct module;
 
 /**
- * Remove memory allocations. It uses graph coloring to find memory allocations that can be reused.
+ * Remove memory allocations. The allocations are replaced with loads from a single scratch buffer,
+ * where allocations whose live intervals don't overlap can share the same memory. When it runs on
+ * a program, the scratch memory of the submodules is planned in the module that uses them, so the
+ * whole program uses the scratch buffer of the main module.
  */
 struct memory_coloring
 {
     std::string allocation_op{};
     bool verify = false;
+    /// Alignment of the offset of each allocation, it is also aligned to the size of its type
+    std::size_t alignment = 4;
+    /// Allocations of at least this many bytes are aligned to large_alignment instead, or none
+    /// when it is zero
+    std::size_t large_size      = 0;
+    std::size_t large_alignment = 4096;
     std::string name() const { return "memory coloring"; }
     void apply(module& p) const;
 };
@@ -128,6 +128,8 @@ struct module
     bool has_instruction(instruction_ref ins) const;
 
     std::size_t size() const;
+    // Changes whenever the instructions are added, removed, moved or replaced
+    std::size_t version() const;
     instruction_ref begin() const;
     instruction_ref end() const;
 
@@ -87,6 +87,9 @@ struct loop
                 auto* out_data       = scan_out.data();
                 std::size_t out_size = iter_stat.get_shape().bytes();
                 assert((iter + 1) * out_size <= scan_out.get_shape().bytes());
+                // Already written in place by the module
+                if(in_data == out_data + iter * out_size)
+                    continue;
                 std::copy(in_data, in_data + out_size, out_data + iter * out_size);
             }
         }
@@ -0,0 +1,210 @@
+#ifndef MIGRAPHX_GUARD_OPERATORS_RESIZE_HPP
+#define MIGRAPHX_GUARD_OPERATORS_RESIZE_HPP
+
+#include <migraphx/check_shapes.hpp>
+#include <migraphx/config.hpp>
+#include <migraphx/argument.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/shape_for_each.hpp>
+#include <migraphx/stringutils.hpp>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace op {
+
+/**
+ * Resize with the ONNX nearest and linear modes. The source position of every output
+ * index is computed per axis, so linear mode interpolates separably over each axis.
+ */
+struct resize
+{
+    std::vector<std::size_t> sizes;
+    std::vector<double> scales;
+    // Starts followed by ends, only used by tf_crop_and_resize
+    std::vector<double> roi;
+    std::string mode                           = "nearest";
+    std::string coordinate_transformation_mode = "half_pixel";
+    std::string nearest_mode                   = "round_prefer_floor";
+    float extrapolation_value                  = 0.0f;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.sizes, "sizes"),
+                    f(self.scales, "scales"),
+                    f(self.roi, "roi"),
+                    f(self.mode, "mode"),
+                    f(self.coordinate_transformation_mode, "coordinate_transformation_mode"),
+                    f(self.nearest_mode, "nearest_mode"),
+                    f(self.extrapolation_value, "extrapolation_value"));
+    }
+
+    std::string name() const { return "resize"; }
+
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        check_shapes{inputs, *this}.has(1);
+        auto ndim = inputs.front().lens().size();
+        if(sizes.size() != ndim or scales.size() != ndim)
+        {
+            MIGRAPHX_THROW("RESIZE: sizes and scales should have the same rank as the input!");
+        }
+
+        if(mode != "nearest" and mode != "linear")
+        {
+            MIGRAPHX_THROW("RESIZE: mode " + mode + " is not supported!");
+        }
+
+        if(not contains({"half_pixel",
+                         "pytorch_half_pixel",
+                         "align_corners",
+                         "asymmetric",
+                         "tf_half_pixel_for_nn",
+                         "tf_crop_and_resize"},
+                        coordinate_transformation_mode))
+        {
+            MIGRAPHX_THROW("RESIZE: coordinate_transformation_mode " +
+                           coordinate_transformation_mode + " is not supported!");
+        }
+
+        if(coordinate_transformation_mode == "tf_crop_and_resize" and roi.size() != 2 * ndim)
+        {
+            MIGRAPHX_THROW("RESIZE: tf_crop_and_resize needs a start and end for every axis!");
+        }
+
+        if(not contains({"round_prefer_floor", "round_prefer_ceil", "floor", "ceil"},
+                        nearest_mode))
+        {
+            MIGRAPHX_THROW("RESIZE: nearest_mode " + nearest_mode + " is not supported!");
+        }
+
+        if(std::any_of(sizes.begin(), sizes.end(), [](auto len) { return len == 0; }))
+        {
+            MIGRAPHX_THROW("RESIZE: output sizes should be greater than 0!");
+        }
+
+        return {inputs.front().type(), sizes};
+    }
+
+    // The input position of output index idx along axis
+    double original_coord(std::size_t axis, std::size_t l_in, std::size_t idx) const
+    {
+        auto l_out    = sizes[axis];
+        double scale  = scales[axis];
+        const auto& m = coordinate_transformation_mode;
+        if(m == "pytorch_half_pixel")
+            return l_out > 1 ? (idx + 0.5) / scale - 0.5 : 0.0;
+        if(m == "align_corners")
+            return (l_out == 1) ? 0.0 : (1.0 * idx * (l_in - 1.0) / (l_out - 1.0));
+        if(m == "asymmetric")
+            return idx / scale;
+        if(m == "tf_half_pixel_for_nn")
+            return (idx + 0.5) / scale;
+        if(m == "tf_crop_and_resize")
+        {
+            auto start = roi[axis];
+            auto end   = roi[sizes.size() + axis];
+            if(l_out == 1)
+                return 0.5 * (start + end) * (l_in - 1.0);
+            return start * (l_in - 1.0) + idx * (end - start) * (l_in - 1.0) / (l_out - 1.0);
+        }
+        return (idx + 0.5) / scale - 0.5;
+    }
+
+    std::size_t nearest_index(std::size_t l_in, double val) const
+    {
+        val = std::max(0.0, std::min(l_in - 1.0, val));
+        if(nearest_mode == "round_prefer_ceil")
+            return static_cast<std::size_t>(std::round(val));
+        if(nearest_mode == "floor")
+            return static_cast<std::size_t>(std::floor(val));
+        if(nearest_mode == "ceil")
+            return static_cast<std::size_t>(std::ceil(val));
+        return static_cast<std::size_t>(std::ceil(val - 0.5));
+    }
+
+    struct sample
+    {
+        // Neighboring input indices along one axis, the output is lo + weight * (hi - lo)
+        std::size_t lo   = 0;
+        std::size_t hi   = 0;
+        double weight    = 0.0;
+        bool extrapolate = false;
+    };
+
+    // The samples for every output index of every axis
+    std::vector<std::vector<sample>> get_samples(const std::vector<std::size_t>& in_lens) const
+    {
+        std::vector<std::vector<sample>> result(in_lens.size());
+        for(auto axis : range(in_lens.size()))
+        {
+            auto l_in = in_lens[axis];
+            result[axis].resize(sizes[axis]);
+            for(auto idx : range(sizes[axis]))
+            {
+                auto& s = result[axis][idx];
+                auto x  = original_coord(axis, l_in, idx);
+                if(coordinate_transformation_mode == "tf_crop_and_resize" and
+                   (x < 0 or x > l_in - 1.0))
+                    s.extrapolate = true;
+                if(mode == "nearest")
+                {
+                    s.lo = s.hi = nearest_index(l_in, x);
+                    continue;
+                }
+                x        = std::max(0.0, std::min(l_in - 1.0, x));
+                s.lo     = static_cast<std::size_t>(std::floor(x));
+                s.hi     = std::min(s.lo + 1, l_in - 1);
+                s.weight = (s.hi == s.lo) ? 0.0 : x - s.lo;
+            }
+        }
+        return result;
+    }
+
+    argument compute(const shape& output_shape, std::vector<argument> args) const
+    {
+        argument result{output_shape};
+        auto samples = get_samples(args[0].get_shape().lens());
+        auto ndim    = samples.size();
+        visit_all(result, args[0])([&](auto output, auto input) {
+            using type = typename decltype(output)::value_type;
+            std::vector<std::size_t> in_idx(ndim);
+            shape_for_each(output_shape, [&](const auto& out_idx) {
+                auto& y = output(out_idx.begin(), out_idx.end());
+                if(any_of(range(ndim), [&](auto d) { return samples[d][out_idx[d]].extrapolate; }))
+                {
+                    y = static_cast<type>(extrapolation_value);
+                    return;
+                }
+                // Visit every corner of the neighborhood, skipping the ones with no weight
+                double acc = 0.0;
+                for(std::size_t corner = 0; corner < (std::size_t{1} << ndim); corner++)
+                {
+                    double w = 1.0;
+                    for(auto d : range(ndim))
+                    {
+                        const auto& s = samples[d][out_idx[d]];
+                        bool high     = ((corner >> d) & 1) != 0;
+                        in_idx[d]     = high ? s.hi : s.lo;
+                        w *= high ? s.weight : 1.0 - s.weight;
+                    }
+                    if(w == 0.0)
+                        continue;
+                    acc += w * input(in_idx.begin(), in_idx.end());
+                }
+                y = static_cast<type>(acc);
+            });
+        });
+        return result;
+    }
+};
+
+} // namespace op
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -110,6 +110,7 @@ struct program
     void remove_unused_modules();
 
     private:
+    friend struct session;
     void assign(const program& p);
     std::unique_ptr<program_impl> impl;
 };
@@ -0,0 +1,25 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_REWRITE_RESIZE_HPP
+#define MIGRAPHX_GUARD_RTGLIB_REWRITE_RESIZE_HPP
+
+#include <string>
+#include <migraphx/config.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct module;
+
+/**
+ * Rewrite resize to a gather of the neighboring input elements followed by a linear blend
+ * along each interpolated axis
+ */
+struct rewrite_resize
+{
+    std::string name() const { return "rewrite_resize"; }
+    void apply(module& m) const;
+};
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -21,6 +21,10 @@ struct rewrite_rnn
     std::string name() const { return "rewrite_rnn"; }
     void apply(module& prog) const;
 
+    // The activation functions of an rnn, gru or lstm for each direction, with the
+    // defaults filled in the same way as parse_rnn does
+    std::vector<operation> get_actv_funcs(instruction_ref ins) const;
+
     private:
     // for vanilla rnn operators
     void apply_vanilla_rnn(module& prog, instruction_ref ins) const;
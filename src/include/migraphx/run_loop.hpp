@@ -49,6 +49,44 @@ argument run_loop(const LoopModel& model,
 
     auto out_param_indices = model.get_output_params(*mod);
 
+    // Bind the parameters once, so each iteration only updates the arguments instead of
+    // building a new parameter map
+    struct param_binding
+    {
+        argument* param;
+        std::size_t index;
+        shape s;
+    };
+    std::unordered_map<std::string, argument> params;
+    std::vector<param_binding> input_params;
+    std::vector<param_binding> output_params;
+    std::vector<param_binding> scan_params;
+    std::size_t input_index = 0;
+    for(const auto& name : param_names)
+    {
+        auto ps = param_name_shapes.at(name);
+        if(ps == shape{})
+        {
+            continue;
+        }
+
+        auto* param = &params[name];
+        // it is an input parameter
+        if(not contains(out_param_indices, name))
+        {
+            input_params.push_back({param, input_index++, ps});
+        }
+        else
+        {
+            auto output_index = out_param_indices[name];
+            if(output_index > dep_num)
+                scan_params.push_back({param, std::size_t(output_index), ps});
+            else
+                output_params.push_back({param, std::size_t(output_index), ps});
+        }
+    }
+    std::vector<argument> mod_scan_outs;
+
     int64_t iter = 0;
     for(iter = 0; iter < iter_num and cond; ++iter)
     {
@@ -57,35 +95,15 @@ argument run_loop(const LoopModel& model,
         model.copy(ctx, cond, in_args.at(1));
 
         // wrap up the inputs and outputs
-        std::unordered_map<std::string, argument> params;
-        int input_index = 0;
-        for(const auto& name : param_names)
+        for(const auto& b : input_params)
+            *b.param = in_args.at(b.index);
+        for(const auto& b : output_params)
+            *b.param = out_args.at(b.index);
+        for(const auto& b : scan_params)
         {
-            auto ps = mod->get_parameter_shape(name);
-            if(ps == shape{})
-            {
-                continue;
-            }
-
-            // it is an input parameter
-            if(not contains(out_param_indices, name))
-            {
-                params[name] = in_args.at(input_index++);
-            }
-            else
-            {
-                auto output_index = out_param_indices[name];
-                if(output_index > dep_num)
-                {
-                    const auto& arg = out_args.at(output_index);
-                    assert((iter + 1) * ps.bytes() <= arg.get_shape().bytes());
-                    params[name] = argument(ps, arg.data() + iter * ps.bytes());
-                }
-                else
-                {
-                    params[name] = out_args.at(output_index);
-                }
-            }
+            const auto& arg = out_args.at(b.index);
+            assert((iter + 1) * b.s.bytes() <= arg.get_shape().bytes());
+            *b.param = argument(b.s, arg.data() + iter * b.s.bytes());
         }
 
         auto mod_args = run(mod, params);
@@ -98,7 +116,7 @@ argument run_loop(const LoopModel& model,
         const auto& dep_out = loop_carry_deps[(iter + 1) % 2];
         std::copy(dep_out.begin(), dep_out.end(), out_args.begin());
 
-        std::vector<argument> mod_scan_outs(mod_args.begin() + 1 + dep_num, mod_args.end());
+        mod_scan_outs.assign(mod_args.begin() + 1 + dep_num, mod_args.end());
         model.append(mod_scan_outs, scan_outputs, iter);
     }
 
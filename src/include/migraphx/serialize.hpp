@@ -6,7 +6,10 @@
 #include <migraphx/reflect.hpp>
 #include <migraphx/requires.hpp>
 #include <migraphx/rank.hpp>
+#include <memory>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -205,6 +208,30 @@ void from_value(const value& v, T& x)
     detail::from_value_impl(rank<9>{}, v, x);
 }
 
+// While a scope is active, literal and argument buffers of at least min_size
+// bytes are stored as an index into the sections instead of a binary value.
+// Saving records the buffers to write, and loading shares the buffers that
+// were read instead of copying them.
+struct binary_sections
+{
+    std::size_t min_size = 4096;
+    std::vector<std::pair<const char*, std::size_t>> saved;
+    std::vector<std::pair<std::shared_ptr<char>, std::size_t>> loaded;
+};
+
+struct binary_sections_scope
+{
+    explicit binary_sections_scope(binary_sections& s);
+    binary_sections_scope(const binary_sections_scope&) = delete;
+    binary_sections_scope& operator=(const binary_sections_scope&) = delete;
+    ~binary_sections_scope();
+
+    private:
+    binary_sections* prev;
+};
+
+binary_sections* current_binary_sections();
+
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
 
@@ -0,0 +1,44 @@
+#ifndef MIGRAPHX_GUARD_MIGRAPHX_SESSION_HPP
+#define MIGRAPHX_GUARD_MIGRAPHX_SESSION_HPP
+
+#include <migraphx/config.hpp>
+#include <migraphx/program.hpp>
+#include <memory>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct session_impl;
+
+/**
+ * @brief Evaluates a compiled program with its own execution state
+ * @details Sessions share the instructions, literals and compiled kernels of the program, but
+ * each one has its own context, preallocated memory and intermediate results. So different
+ * sessions of the same program can be evaluated concurrently, while a single session must only be
+ * used by one thread at a time. The program must outlive its sessions and must not be modified
+ * while they are in use.
+ */
+struct session
+{
+    explicit session(const program& p);
+
+    session(session&&) noexcept;
+    session& operator=(session&&) noexcept;
+
+    ~session() noexcept;
+
+    std::vector<argument> eval(parameter_map params);
+
+    const program& get_program() const;
+
+    context& get_context() const;
+
+    private:
+    std::unique_ptr<session_impl> impl;
+};
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
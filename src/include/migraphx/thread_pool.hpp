@@ -0,0 +1,77 @@
+#ifndef MIGRAPHX_GUARD_RTGLIB_THREAD_POOL_HPP
+#define MIGRAPHX_GUARD_RTGLIB_THREAD_POOL_HPP
+
+#include <migraphx/config.hpp>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct thread_pool_impl;
+
+// A set of persistent worker threads used to run parallel loops. The thread
+// calling run always works on the loop as well, so loops can be nested or
+// started from several threads at once without waiting on each other.
+struct thread_pool
+{
+    static constexpr std::size_t any_node = std::numeric_limits<std::size_t>::max();
+
+    // Creates a pool that runs loops on n threads, the caller included. The
+    // workers are pinned to the cpus of the NUMA node, or to the cpus of
+    // every node, filling one node before the next, when no node is given.
+    // When n is zero the pool uses every cpu it is pinned to.
+    explicit thread_pool(std::size_t n = 0, std::size_t node = any_node);
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    ~thread_pool();
+
+    std::size_t size() const;
+    std::size_t node() const;
+
+    // Calls f(start, end, tid) on chunks of [0, n) using at most nthreads
+    // threads. Chunks are handed out as threads become free and are never
+    // smaller than grain, except for the last one. The tid is less than
+    // nthreads.
+    void run(std::size_t n,
+             std::size_t grain,
+             std::size_t nthreads,
+             const std::function<void(std::size_t, std::size_t, std::size_t)>& f);
+
+    private:
+    std::unique_ptr<thread_pool_impl> impl;
+};
+
+// The pool shared by the whole process. Its size is set with MIGRAPHX_NUM_THREADS
+// and defaults to the number of cpus this process can run on.
+thread_pool& default_thread_pool();
+
+// The pool used by par_for on this thread
+thread_pool& current_thread_pool();
+
+// Maximum number of threads par_for uses on this thread
+std::size_t current_thread_limit();
+
+// Makes par_for use the pool, and at most max_threads of it, until the scope
+// ends
+struct thread_pool_scope
+{
+    explicit thread_pool_scope(thread_pool& p, std::size_t max_threads = 0);
+    thread_pool_scope(const thread_pool_scope&) = delete;
+    thread_pool_scope& operator=(const thread_pool_scope&) = delete;
+    ~thread_pool_scope();
+
+    private:
+    thread_pool* prev_pool;
+    std::size_t prev_limit;
+};
+
+// Cpus this process can run on, grouped by NUMA node
+std::vector<std::vector<std::size_t>> get_numa_cpus();
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -3,10 +3,14 @@
 
 #include <migraphx/config.hpp>
 #include <migraphx/filesystem.hpp>
+#include <string>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
+/// Returns the prefix followed by a string that is unique to the process, thread and time
+std::string unique_string(const std::string& prefix);
+
 struct tmp_dir
 {
     fs::path path;
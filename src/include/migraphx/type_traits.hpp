@@ -10,6 +10,7 @@
 
 #include <type_traits>
 #include <migraphx/half.hpp>
+#include <migraphx/bf16.hpp>
 #include <migraphx/config.hpp>
 
 namespace migraphx {
@@ -30,6 +31,16 @@ MIGRAPHX_DETAIL_EXTEND_TRAIT_FOR(is_floating_point, half)
 MIGRAPHX_DETAIL_EXTEND_TRAIT_FOR(is_signed, half)
 MIGRAPHX_DETAIL_EXTEND_TRAIT_FOR(is_arithmetic, half)
 
+#define MIGRAPHX_DETAIL_ADD_TRAIT_FOR(trait, T) \
+    template <>                                 \
+    struct trait<T> : std::true_type            \
+    {                                           \
+    };
+
+MIGRAPHX_DETAIL_ADD_TRAIT_FOR(is_floating_point, bf16)
+MIGRAPHX_DETAIL_ADD_TRAIT_FOR(is_signed, bf16)
+MIGRAPHX_DETAIL_ADD_TRAIT_FOR(is_arithmetic, bf16)
+
 template <class T>
 using accumulator_type =
     std::conditional_t<is_floating_point<T>{},
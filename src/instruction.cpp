@@ -411,6 +411,15 @@ void instruction::set_normalized(bool value) { normalized = value; }
 
 bool instruction::is_normalized() const { return normalized; }
 
+void instruction::normalize()
+{
+    if(not this->need_normalization())
+        return;
+    // The normalized operator computes the same shape, so the outputs are left as is
+    op         = this->normalized_operator();
+    normalized = true;
+}
+
 bool instruction::need_normalization() const
 {
     return this->get_operator().need_normalization() and not normalized;
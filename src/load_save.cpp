@@ -2,14 +2,117 @@
 #include <migraphx/file_buffer.hpp>
 #include <migraphx/json.hpp>
 #include <migraphx/msgpack.hpp>
-#include <migraphx/file_buffer.hpp>
+#include <migraphx/serialize.hpp>
+#include <migraphx/make_shared_array.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <fstream>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
+// The mmap format starts with the magic and the size of the msgpack metadata,
+// followed by the metadata. Large literals are stored after the metadata in
+// sections aligned to the page size, so they can be used straight from a
+// mapping of the file.
+const std::string mmap_magic             = "MIGXMMAP";
+constexpr std::size_t mmap_header_size   = 16;
+const std::size_t mmap_section_alignment = 4096;
+
+static std::size_t align_section(std::size_t n)
+{
+    return (n + mmap_section_alignment - 1) / mmap_section_alignment * mmap_section_alignment;
+}
+
+static bool is_mmap_format(const char* buffer, std::size_t size)
+{
+    return size >= mmap_header_size and std::equal(mmap_magic.begin(), mmap_magic.end(), buffer);
+}
+
+// The owner keeps the buffer alive for the literals that share it. Without an
+// owner the sections are copied.
+static program
+load_mmap(const char* buffer, std::size_t size, const std::shared_ptr<char>& owner)
+{
+    std::uint64_t meta_size = 0;
+    std::memcpy(&meta_size, buffer + mmap_magic.size(), sizeof(meta_size));
+    if(mmap_header_size + meta_size > size)
+        MIGRAPHX_THROW("Invalid metadata size in mmap file");
+    auto v          = from_msgpack(buffer + mmap_header_size, meta_size);
+    auto data_start = align_section(mmap_header_size + meta_size);
+    binary_sections sections;
+    for(const auto& section : v.at("sections"))
+    {
+        auto offset = data_start + section.at("offset").to<std::size_t>();
+        auto bytes  = section.at("size").to<std::size_t>();
+        if(offset + bytes > size)
+            MIGRAPHX_THROW("Data section is past the end of the mmap file");
+        std::shared_ptr<char> data;
+        if(owner == nullptr)
+            data = make_shared_array<char>(buffer + offset, buffer + offset + bytes);
+        else
+            data = std::shared_ptr<char>(owner, owner.get() + offset);
+        sections.loaded.emplace_back(data, bytes);
+    }
+    binary_sections_scope scope{sections};
+    program p;
+    p.from_value(v.at("program"));
+    return p;
+}
+
+template <class F>
+static void save_mmap(const program& p, F write)
+{
+    binary_sections sections;
+    value v;
+    {
+        binary_sections_scope scope{sections};
+        v["program"] = p.to_value();
+    }
+    std::vector<value> section_vals;
+    std::size_t offset = 0;
+    for(const auto& section : sections.saved)
+    {
+        section_vals.push_back({{"offset", offset}, {"size", section.second}});
+        offset = align_section(offset + section.second);
+    }
+    v["sections"] = value(section_vals, true);
+
+    auto meta                 = to_msgpack(v);
+    std::uint64_t meta_size   = meta.size();
+    std::vector<char> padding = {};
+    write(mmap_magic.data(), mmap_magic.size());
+    write(reinterpret_cast<const char*>(&meta_size), sizeof(meta_size));
+    write(meta.data(), meta.size());
+    auto pos = mmap_header_size + meta.size();
+    for(const auto& section : sections.saved)
+    {
+        padding.resize(align_section(pos) - pos);
+        write(padding.data(), padding.size());
+        write(section.first, section.second);
+        pos = align_section(pos) + section.second;
+    }
+}
+
+static bool is_mmap_file(const std::string& filename)
+{
+    std::array<char, mmap_header_size> header = {};
+    std::ifstream is(filename, std::ios::binary);
+    if(not is.read(header.data(), header.size()))
+        return false;
+    return is_mmap_format(header.data(), header.size());
+}
+
 program load(const std::string& filename, const file_options& options)
 {
+    // Only the mmap format can use the literals from the mapping, the other
+    // formats are parsed into new buffers anyway
+    if(is_mmap_file(filename))
+    {
+        auto mapping = map_file(filename);
+        return load_mmap(mapping.data.get(), mapping.size, mapping.data);
+    }
     return load_buffer(read_buffer(filename), options);
 }
 program load_buffer(const std::vector<char>& buffer, const file_options& options)
@@ -19,7 +122,11 @@ program load_buffer(const std::vector<char>& buffer, const file_options& options
 program load_buffer(const char* buffer, std::size_t size, const file_options& options)
 {
     program p;
-    if(options.format == "msgpack")
+    if(is_mmap_format(buffer, size))
+    {
+        p = load_mmap(buffer, size, nullptr);
+    }
+    else if(options.format == "msgpack")
     {
         p.from_value(from_msgpack(buffer, size));
     }
@@ -36,21 +143,37 @@ program load_buffer(const char* buffer, std::size_t size, const file_options& op
 
 void save(const program& p, const std::string& filename, const file_options& options)
 {
-    write_buffer(filename, save_buffer(p, options));
+    if(options.format == "mmap")
+    {
+        // Write the literals straight from the program to avoid another copy
+        std::ofstream os(filename, std::ios::binary);
+        save_mmap(p, [&](const char* data, std::size_t size) { os.write(data, size); });
+        if(not os)
+            MIGRAPHX_THROW("Error writing file: " + filename);
+    }
+    else
+    {
+        write_buffer(filename, save_buffer(p, options));
+    }
 }
 std::vector<char> save_buffer(const program& p, const file_options& options)
 {
-    value v = p.to_value();
     std::vector<char> buffer;
     if(options.format == "msgpack")
     {
-        buffer = to_msgpack(v);
+        buffer = to_msgpack(p.to_value());
     }
     else if(options.format == "json")
     {
-        std::string s = to_json_string(v);
+        std::string s = to_json_string(p.to_value());
         buffer        = std::vector<char>(s.begin(), s.end());
     }
+    else if(options.format == "mmap")
+    {
+        save_mmap(p, [&](const char* data, std::size_t size) {
+            buffer.insert(buffer.end(), data, data + size);
+        });
+    }
     else
     {
         MIGRAPHX_THROW("Unknown format: " + options.format);
@@ -353,13 +353,7 @@ literal onnx_parser::parse_tensor(const onnx::TensorProto& t) const
 {
     std::vector<std::size_t> dims(t.dims().begin(), t.dims().end());
     if(not t.external_data().empty())
-    {
-        const std::string& data_file = t.external_data().at(0).value();
-        auto raw_buffer              = read_buffer(path + "/" + data_file);
-        std::string s(raw_buffer.begin(), raw_buffer.end());
-        auto type = get_type(t.data_type());
-        return create_literal(type, dims, s.data());
-    }
+        return parse_external_data(t, dims);
     if(t.has_raw_data())
     {
         const std::string& s = t.raw_data();
@@ -390,6 +384,15 @@ literal onnx_parser::parse_tensor(const onnx::TensorProto& t) const
                        [](uint16_t raw_val) { return *reinterpret_cast<half*>(&raw_val); });
         return create_literal(shape::half_type, dims, data_half);
     }
+    case onnx::TensorProto::BFLOAT16:
+    {
+        std::vector<bf16> data_bf16;
+        std::transform(t.int32_data().begin(),
+                       t.int32_data().end(),
+                       std::back_inserter(data_bf16),
+                       [](uint16_t raw_val) { return bf16::from_bits(raw_val); });
+        return create_literal(shape::bf16_type, dims, data_bf16);
+    }
     case onnx::TensorProto::DOUBLE:
         return create_literal(shape::double_type, dims, t.double_data());
     case onnx::TensorProto::FLOAT: return create_literal(shape::float_type, dims, t.float_data());
@@ -400,6 +403,54 @@ literal onnx_parser::parse_tensor(const onnx::TensorProto& t) const
     }
     MIGRAPHX_THROW("PARSE_TENSOR: Invalid tensor type");
 }
+literal onnx_parser::parse_external_data(const onnx::TensorProto& t,
+                                         const std::vector<std::size_t>& dims) const
+{
+    std::string location;
+    std::size_t offset = 0;
+    std::size_t length = 0;
+    bool has_length    = false;
+    for(auto&& entry : t.external_data())
+    {
+        if(entry.key() == "location")
+            location = entry.value();
+        else if(entry.key() == "offset")
+            offset = std::stoull(entry.value());
+        else if(entry.key() == "length")
+        {
+            length     = std::stoull(entry.value());
+            has_length = true;
+        }
+    }
+    if(location.empty())
+        MIGRAPHX_THROW("PARSE_TENSOR: No location for external data of " + t.name());
+
+    auto type = get_type(t.data_type());
+    shape s   = dims.empty() ? shape{type} : shape{type, dims};
+    if(s.elements() == 0)
+        return {};
+    if(has_length and length != s.bytes())
+        MIGRAPHX_THROW("PARSE_TENSOR: External data of " + t.name() + " has " +
+                       std::to_string(length) + " bytes but expected " +
+                       std::to_string(s.bytes()));
+
+    // Every tensor stored in the same file shares one mapping of it
+    auto file = path + "/" + location;
+    auto it   = external_data_files.find(file);
+    if(it == external_data_files.end())
+        it = external_data_files.emplace(file, map_file(file)).first;
+    const auto& mapping = it->second;
+    if(offset > mapping.size or mapping.size - offset < s.bytes())
+        MIGRAPHX_THROW("PARSE_TENSOR: External data of " + t.name() + " is past the end of " +
+                       file);
+
+    const char* data = mapping.data.get() + offset;
+    // Misaligned data is copied so it can be accessed as the tensor type
+    if(offset % s.type_size() != 0)
+        return literal{s, data};
+    return literal{s, std::shared_ptr<char>(mapping.data, mapping.data.get() + offset)};
+}
+
 shape onnx_parser::parse_type(const onnx::TypeProto& t,
                               const std::vector<std::size_t>& input_dims) const
 {
@@ -451,6 +502,7 @@ shape::type_t get_type(int dtype)
     case 11: return shape::double_type;
     case 12: return shape::uint32_type;
     case 13: return shape::uint64_type;
+    case 16: return shape::bf16_type;
     default: { MIGRAPHX_THROW("Prototensor data type " + std::to_string(dtype) + " not supported");
     }
     }
@@ -17,9 +17,10 @@ auto compute_type(shape::type_t t1, shape::type_t t2)
                                                           {shape::uint32_type, 6},
                                                           {shape::int64_type, 7},
                                                           {shape::uint64_type, 8},
-                                                          {shape::half_type, 9},
-                                                          {shape::float_type, 10},
-                                                          {shape::double_type, 11}};
+                                                          {shape::bf16_type, 9},
+                                                          {shape::half_type, 10},
+                                                          {shape::float_type, 11},
+                                                          {shape::double_type, 12}};
 
     int it1 = t1;
     int it2 = t2;
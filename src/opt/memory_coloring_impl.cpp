@@ -4,350 +4,270 @@
 
 #include "memory_coloring_impl.hpp"
 
+#include <limits>
+#include <numeric>
+#include <tuple>
+
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
-void memory_coloring_impl::run()
-{
-    // calc implicit depdendencies
-    mod_implicit_deps = p_mod->calc_implicit_deps();
-
-    MIGRAPHX_DEBUG(dump("---Before memory coloring---"));
-    MIGRAPHX_DEBUG(dump_module());
-    build();
-    if(num_of_lives != 0)
-    {
-        MIGRAPHX_DEBUG(dump_intervals());
-        // Coloring
-        while(!alloc_queue.empty())
-        {
-            interval_ptr interval = alloc_queue.top();
-            allocate(interval);
-            alloc_queue.pop();
-        }
-
-        // rewrite happens after all modules are processed
-        rewrite();
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_TRACE_MEMORY_COLORING)
 
-        if(enable_verify)
-            verify();
-    }
+static std::size_t align_up(std::size_t n, std::size_t alignment)
+{
+    return (n + alignment - 1) / alignment * alignment;
 }
 
-bool memory_coloring_impl::allocate(interval_ptr interval)
+interval_index::interval_index(std::size_t n)
 {
-    shape s          = interval->result;
-    std::size_t size = s.bytes();
-    if(size == 0)
-        return false;
-    std::size_t element_size = (s.elements() == 0 ? 4 : (size / s.elements()));
-    live_range& segment      = interval->segment;
-    int vn                   = segment.vn;
-    std::priority_queue<live_range*, std::vector<live_range*>, ordering> conflict_queue;
-    std::unordered_map<long long, live_range*> offset2_live;
-    offset2_live.clear();
+    while(leaves < n)
+        leaves *= 2;
+    nodes.resize(2 * leaves);
+}
 
-    if(conflict_table.find(vn) != conflict_table.end())
+void interval_index::insert(std::size_t begin, std::size_t end, std::size_t id)
+{
+    starts.emplace(begin, id);
+    for(auto l = begin + leaves, r = end + leaves + 1; l < r; l /= 2, r /= 2)
     {
-        std::set<int>& vn_set = conflict_table[vn];
-        for(const auto& iter : vn_set)
-        {
-            live_range* range = live_ranges[iter];
-            long long offset  = range->offset;
-            if(offset != invalid_offset)
-            {
-                conflict_queue.push(range);
-                if(offset2_live.find(offset) == offset2_live.end())
-                {
-                    offset2_live[offset] = range;
-                }
-                else
-                {
-                    live_range* prev = offset2_live[offset];
-                    assert(prev->offset == offset);
-                    if(prev->size < range->size)
-                        offset2_live[offset] = range;
-                }
-            }
-        }
+        if(l % 2 == 1)
+            nodes[l++].push_back(id);
+        if(r % 2 == 1)
+            nodes[--r].push_back(id);
     }
+}
 
-    std::size_t offset = 0;
-    while(!conflict_queue.empty())
+// Finds the smallest gap between the used ranges that fits, otherwise the offset after all of them
+static std::size_t find_best_fit(std::vector<std::pair<std::size_t, std::size_t>>& used,
+                                 std::size_t size,
+                                 std::size_t alignment)
+{
+    std::sort(used.begin(), used.end());
+    std::size_t result    = 0;
+    std::size_t best_gap  = std::numeric_limits<std::size_t>::max();
+    std::size_t gap_start = 0;
+    for(auto&& u : used)
     {
-        live_range* range       = conflict_queue.top();
-        std::size_t iter_offset = range->offset;
-        if(offset > iter_offset)
-        {
-            offset = std::max(offset, iter_offset + range->size);
-        }
-        else if(offset2_live[iter_offset] == range)
+        auto offset = align_up(gap_start, alignment);
+        if(u.first > gap_start and offset + size <= u.first and u.first - gap_start < best_gap)
         {
-            if((iter_offset > offset) && (iter_offset - offset) >= size)
-            {
-                break;
-            }
-            offset = iter_offset + range->size;
+            best_gap = u.first - gap_start;
+            result   = offset;
         }
-        // alignment
-        if((offset % element_size) != 0)
-            offset += (element_size - (offset % element_size));
-        conflict_queue.pop();
+        gap_start = std::max(gap_start, u.second);
     }
-    // when int8 type is used, the offset could be any number
-    // if not 4-byte aligned, miopen int8 convolution can crash
-    offset         = (offset + 3) / 4 * 4;
-    segment.offset = offset;
-    MIGRAPHX_DEBUG(segment.dump());
-    required_bytes = std::max(required_bytes, offset + segment.size);
-    return true;
+    if(best_gap == std::numeric_limits<std::size_t>::max())
+        return align_up(gap_start, alignment);
+    return result;
 }
 
-void memory_coloring_impl::build()
+void memory_coloring_impl::run()
 {
-    std::size_t num_of_instrs = p_mod->size();
-    if(num_of_instrs == 0)
+    build();
+    if(buffers.empty())
         return;
-
-    auto cur_points       = num_of_instrs * 2;
-    instruction_ref iter  = p_mod->end();
-    instruction_ref begin = p_mod->begin();
-    std::vector<instruction_ref> dead_instrs;
-    std::set<int> live_set;
-    // Build live intervals.
-    live_intervals.resize(num_of_instrs);
-    do
+    plan();
+    rewrite();
+    if(enable_verify)
+        verify();
+    if(enabled(MIGRAPHX_TRACE_MEMORY_COLORING{}))
     {
-        iter                      = std::prev(iter);
-        const instruction* p_iter = &(*iter);
-        interval_ptr def_interval = nullptr;
-        bool is_dead              = false;
-        if(instr2_live.find(p_iter) != instr2_live.end())
-        {
-            def_interval = instr2_live[p_iter];
-            bool is_lit  = is_literal(iter);
-            if(is_allocate(iter) || is_lit)
-            {
-                live_range& range        = def_interval->segment;
-                def_interval->result     = iter->get_shape();
-                def_interval->is_literal = is_lit;
-                range.begin              = cur_points;
-                def_interval->def_point  = cur_points;
-                range.size               = (iter->get_shape()).bytes();
-                if(!is_lit || unify_literals)
-                    alloc_queue.push(def_interval);
-                live_set.erase(range.vn);
-            }
-        }
-        else if(!is_param(iter) && !is_outline(iter) && !is_check_context(iter))
-        {
-            is_dead = true;
-        }
-
-        auto inputs = iter->inputs();
-        if(contains(mod_implicit_deps, iter))
-        {
-            const auto& impl_deps = mod_implicit_deps.at(iter);
-            inputs.insert(inputs.end(), impl_deps.begin(), impl_deps.end());
-        }
-
-        for(auto&& arg : inputs)
-        {
-            if(not p_mod->has_instruction(arg))
-                continue;
+        std::size_t total = 0;
+        for(const auto& b : buffers)
+            total += b.size;
+        std::cout << "Memory coloring " << p_mod->name() << ": " << required_bytes
+                  << " scratch bytes planned for " << buffers.size() << " allocations of "
+                  << total << " bytes";
+        if(total > 0)
+            std::cout << " (" << (100.0 * required_bytes / total) << "%)";
+        std::cout << std::endl;
+    }
+}
 
-            if(is_param(arg) || is_outline(arg))
-            {
-                if(is_output_param(arg))
-                    is_dead = false;
-                if(def_interval != nullptr)
-                {
-                    def_interval->is_live_on_entry = true;
-                }
-                continue;
-            }
-            const instruction* p_arg = &(*instruction::get_output_alias(arg));
-            if(instr2_live.find(p_arg) == instr2_live.end())
-            {
-                // First time see a use, create a live interval.
-                int id                = num_of_lives++;
-                interval_ptr interval = &(live_intervals[id]);
-                interval->id          = id;
-                interval->segment.end = cur_points;
-                interval->segment.vn  = ++max_value_number;
-                interval->add_use(cur_points);
-                instr2_live[p_arg] = interval;
-                add_conflicts(live_set, max_value_number);
-                live_set.insert(max_value_number);
-                live_ranges[max_value_number] = &(interval->segment);
-                earliest_end_point            = cur_points;
-                if(latest_end_point == -1)
-                    latest_end_point = cur_points;
-            }
-            else
-            {
-                interval_ptr interval = instr2_live[p_arg];
-                interval->add_use(cur_points);
-                assert(live_set.find(interval->id) != live_set.end());
-            }
-        }
-        if(is_dead)
-            dead_instrs.push_back(iter);
-        cur_points -= 2;
-    } while(iter != begin);
+std::size_t memory_coloring_impl::get_alignment(const shape& s) const
+{
+    auto type_size = s.elements() == 0 ? 1 : s.bytes() / s.elements();
+    auto result    = std::max(alignment, type_size);
+    if(large_size > 0 and s.bytes() >= large_size)
+        result = std::max(result, large_alignment);
+    return result;
 }
 
-void memory_coloring_impl::rewrite()
+// The alignment of the base of a submodule's scratch memory, so that the loads from it stay aligned
+std::size_t memory_coloring_impl::get_scratch_alignment(instruction_ref scratch) const
 {
-    std::vector<std::size_t> dims;
-    dims.push_back((required_bytes + sizeof(float) - 1) / sizeof(float));
-    shape s                       = {shape::float_type, dims};
-    instruction_ref scratch_param = p_mod->add_parameter("scratch", s);
-    for(auto ins : iterator_for(*p_mod))
+    std::size_t result = alignment;
+    for(auto out : scratch->outputs())
     {
-        const instruction* p_iter = &(*ins);
-        if(instr2_live.find(p_iter) != instr2_live.end())
-        {
-            interval_ptr interval = instr2_live[p_iter];
-            if(interval->get_begin() == invalid_offset)
-                continue;
-
-            if(!unify_literals && interval->is_literal)
-                continue;
-
-            std::size_t offset = 0;
-            if(interval->get_offset() != invalid_offset)
-            {
-                offset = interval->get_offset();
-            }
-            else
-            {
-                assert(interval->result.bytes() == 0);
-            }
-
-            if(is_allocate(ins))
-            {
-                p_mod->replace_instruction(
-                    ins,
-                    make_op("load", {{"shape", to_value(ins->get_shape())}, {"offset", offset}}),
-                    scratch_param);
-            }
-        }
+        if(out->name() != "load")
+            continue;
+        result = std::max({result, get_alignment(out->get_shape()), get_scratch_alignment(out)});
     }
-    MIGRAPHX_DEBUG(dump("---After rewrite---"));
-    MIGRAPHX_DEBUG(dump_module());
+    return result;
 }
 
-void memory_coloring_impl::verify()
+void memory_coloring_impl::build()
 {
-    if(num_of_lives > 0)
+    auto implicit_deps = p_mod->calc_implicit_deps();
+    std::unordered_map<module_ref, std::size_t> module_uses;
+    for(auto ins : iterator_for(*p_mod))
     {
-        for(int i = 0; i < num_of_lives; ++i)
+        for(auto* smod : ins->module_inputs())
+            module_uses[smod]++;
+    }
+    std::unordered_map<instruction_ref, std::size_t> buffer_index;
+    // The instruction of the module that each instruction aliases, which is itself when it
+    // doesn't alias anything
+    std::unordered_map<instruction_ref, instruction_ref> aliases;
+    std::size_t i = 0;
+    for(auto ins : iterator_for(*p_mod))
+    {
+        auto inputs = ins->inputs();
+        if(contains(implicit_deps, ins))
         {
-            live_interval& interval = live_intervals[i];
-            live_range& segment     = interval.segment;
-
-            if(segment.begin == invalid_offset)
-            {
-                // if(!interval.is_live_on_entry)
-                // MIGRAPHX_THROW("interval is not live on entry");
-                continue;
-            }
-
-            if(segment.offset == invalid_offset)
-            {
+            const auto& deps = implicit_deps.at(ins);
+            inputs.insert(inputs.end(), deps.begin(), deps.end());
+        }
+        for(auto arg : inputs)
+        {
+            auto it = aliases.find(arg);
+            if(it == aliases.end())
                 continue;
-            }
-            int vn = segment.vn;
-            if(conflict_table.find(vn) != conflict_table.end())
-            {
-                std::set<int>& vn_set = conflict_table[vn];
-                for(const auto& iter : vn_set)
-                {
-                    live_range* range = live_ranges[iter];
-                    if(range->offset == invalid_offset)
-                        continue;
-                    if(!is_disjoin(*range, segment))
-                        MIGRAPHX_THROW("range and segment is not disjoined");
-                }
-            }
+            auto b = buffer_index.find(it->second);
+            if(b != buffer_index.end())
+                buffers[b->second].end = i;
         }
-    }
-}
-
-#ifdef MIGRAPHX_DEBUG_OPT
 
-void memory_coloring_impl::dump(const std::string& str) { std::cout << str << std::endl; }
+        auto alias = instruction::get_output_alias(ins, true);
+        if(alias != ins and contains(aliases, alias))
+            aliases[ins] = aliases.at(alias);
+        else
+            aliases[ins] = ins;
 
-void memory_coloring_impl::dump_module() { std::cout << *p_mod << std::endl; }
-
-void memory_coloring_impl::dump_intervals()
-{
-    if(num_of_lives > 0)
-    {
-        std::cout << "---live intervals ---" << std::endl;
-        for(int i = 0; i < num_of_lives; ++i)
+        if(is_allocate(ins))
         {
-            live_interval& interval = live_intervals[i];
-            interval.dump();
+            live_buffer b;
+            b.ins       = ins;
+            b.begin     = i;
+            b.end       = i;
+            b.size      = ins->get_shape().bytes();
+            b.alignment = get_alignment(ins->get_shape());
+
+            buffer_index[ins] = buffers.size();
+            buffers.push_back(b);
         }
-        std::cout << "---conflict table---" << std::endl;
-        for(int i = 0; i <= max_value_number; ++i)
+        else if(not ins->module_inputs().empty())
         {
-            std::cout << " segment:" << i;
-            std::cout << " =>";
-            std::set<int>& table = conflict_table[i];
-            for(auto& iter : table)
+            // Submodules are colored before the module that uses them, and their scratch memory
+            // is only needed while the instruction runs, or as long as its outputs are used when
+            // they are returned from the submodule. So it's placed in this module's scratch
+            // memory like an allocation, where sibling submodules like the branches of an if
+            // share the same memory.
+            live_buffer b;
+            for(auto* smod : ins->module_inputs())
             {
-                std::cout << (iter) << ",";
+                auto scratch = smod->get_parameter("scratch");
+                if(scratch == smod->end() or module_uses.at(smod) > 1)
+                    continue;
+                b.size      = std::max(b.size, scratch->get_shape().bytes());
+                b.alignment = std::max(b.alignment, get_scratch_alignment(scratch));
+                b.submodules.emplace_back(smod, scratch);
+            }
+            if(not b.submodules.empty())
+            {
+                b.ins   = ins;
+                b.begin = i;
+                b.end   = i;
+
+                buffer_index[ins] = buffers.size();
+                buffers.push_back(b);
             }
         }
-        std::cout << std::endl;
+        i++;
     }
 }
 
-// map liveness tracking point to instruction enum.
-static int get_ins_enum(int x)
+void memory_coloring_impl::plan()
 {
-    if(x > 0)
+    // Greedy by size: the largest buffers are placed first, each one in the smallest gap left
+    // between the buffers already placed that are live at the same time
+    std::vector<std::size_t> order(buffers.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](auto i, auto j) {
+        const auto& x = buffers[i];
+        const auto& y = buffers[j];
+        return std::make_tuple(y.size, y.end - y.begin, x.begin) <
+               std::make_tuple(x.size, x.end - x.begin, y.begin);
+    });
+    interval_index placed{p_mod->size()};
+    std::vector<std::pair<std::size_t, std::size_t>> used;
+    for(auto i : order)
     {
-        return (x / 2) - 1;
+        auto& b = buffers[i];
+        if(b.size == 0)
+            continue;
+        used.clear();
+        placed.find(b.begin, b.end, [&](std::size_t j) {
+            used.emplace_back(buffers[j].offset, buffers[j].offset + buffers[j].size);
+        });
+        b.offset       = find_best_fit(used, b.size, b.alignment);
+        required_bytes = std::max(required_bytes, b.offset + b.size);
+        placed.insert(b.begin, b.end, i);
     }
-    else
-        return invalid_offset;
 }
 
-void live_range::dump()
+void memory_coloring_impl::rewrite()
 {
-    std::cout << " segment:" << vn;
-    std::cout << " [" << get_ins_enum(begin) << ", " << get_ins_enum(end) << "]";
-    if(offset != invalid_offset)
+    std::vector<std::size_t> dims;
+    dims.push_back((required_bytes + sizeof(float) - 1) / sizeof(float));
+    shape s                       = {shape::float_type, dims};
+    instruction_ref scratch_param = p_mod->add_parameter("scratch", s);
+    for(const auto& b : buffers)
     {
-        std::cout << " mem:";
-        std::cout << " [" << offset << "," << offset + size - 1 << "]";
+        if(b.submodules.empty())
+        {
+            p_mod->replace_instruction(
+                b.ins,
+                make_op("load", {{"shape", to_value(b.ins->get_shape())}, {"offset", b.offset}}),
+                scratch_param);
+            continue;
+        }
+        // The submodules load from a view of this module's scratch memory instead of their own
+        for(auto&& sm : b.submodules)
+        {
+            auto view = p_mod->insert_instruction(
+                b.ins,
+                make_op("load", {{"shape", to_value(sm.second->get_shape())}, {"offset", b.offset}}),
+                scratch_param);
+            auto outputs = sm.second->outputs();
+            for(auto out : outputs)
+                instruction::replace_argument(out, sm.second, view);
+            sm.first->remove_instruction(sm.second);
+        }
     }
-    std::cout << std::endl;
 }
 
-void live_interval::dump()
+void memory_coloring_impl::verify() const
 {
-    std::cout << "id:" << id;
-    segment.dump();
-    std::cout << " uses:";
-    for(auto& iter : use_points)
+    std::vector<const live_buffer*> live;
+    for(const auto& b : buffers)
     {
-        std::cout << " " << get_ins_enum(iter) << ",";
+        live.erase(std::remove_if(live.begin(),
+                                  live.end(),
+                                  [&](const live_buffer* x) { return x->end < b.begin; }),
+                   live.end());
+        if(b.size == 0)
+            continue;
+        if(b.offset % b.alignment != 0)
+            MIGRAPHX_THROW("Allocation is not aligned");
+        for(const auto* x : live)
+        {
+            if(b.offset < x->offset + x->size and x->offset < b.offset + b.size)
+                MIGRAPHX_THROW("Allocations that are live at the same time overlap");
+        }
+        live.push_back(&b);
     }
-    std::cout << " def:";
-    std::cout << " " << get_ins_enum(def_point);
-
-    if(is_literal)
-        std::cout << " literal";
-    std::cout << " " << result;
-    std::cout << std::endl;
 }
 
-#endif
-
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
@@ -8,161 +8,91 @@
 #include <migraphx/ranges.hpp>
 #include <migraphx/config.hpp>
 
-#include <set>
-#include <list>
+#include <algorithm>
+#include <map>
 #include <vector>
-#include <queue>
-
-#ifdef MIGRAPHX_DEBUG_OPT
-#define MIGRAPHX_DEBUG(s) s
-#else
-#define MIGRAPHX_DEBUG(s)
-#endif // MIGRAPHX_DEBUG_OPT
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
-static const std::size_t invalid_offset = std::numeric_limits<std::size_t>::max();
-
-struct live_range
+// An allocation that is live from the instruction that allocates it up to the last instruction
+// that uses it, or any instruction that aliases it
+struct live_buffer
 {
-    std::size_t begin;  // begin point in the instruction stream.
-    std::size_t end;    // end point in the instruction stream.
-    std::size_t offset; // offset to base pointer of allocated memory trunk.
-    std::size_t vn;     // value number that identifies this live_range.
-    std::size_t size;   // size of required memory in bytes
-#ifdef MIGRAPHX_DEBUG_OPT
-    void dump();
-#endif
+    instruction_ref ins;
+    std::size_t begin     = 0; // index of the allocation in the instruction stream
+    std::size_t end       = 0; // index of the last use in the instruction stream
+    std::size_t size      = 0; // size in bytes
+    std::size_t alignment = 1;
+    std::size_t offset    = 0; // offset in the scratch memory
+    // The scratch parameters of the submodules of ins, which are all placed at the offset of the
+    // buffer instead of an allocation
+    std::vector<std::pair<module_ref, instruction_ref>> submodules = {};
 };
 
-struct live_interval
+// Finds the buffers whose live intervals overlap a live interval
+struct interval_index
 {
-    live_interval() : segment({invalid_offset, invalid_offset, invalid_offset, invalid_offset, 0})
-    {
-    }
+    explicit interval_index(std::size_t n);
 
-    void add_use(std::size_t use) { use_points.push_front(use); }
-    std::size_t get_begin() const { return segment.begin; }
-    std::size_t get_end() const { return segment.end; }
-    long long get_offset() const { return segment.offset; }
+    void insert(std::size_t begin, std::size_t end, std::size_t id);
 
-#ifdef MIGRAPHX_DEBUG_OPT
-    void dump();
-#endif
+    template <class F>
+    void find(std::size_t begin, std::size_t end, F f) const
+    {
+        // The intervals that contain begin, from the nodes on the path from its leaf to the root
+        for(auto i = begin + leaves; i > 0; i /= 2)
+            std::for_each(nodes[i].begin(), nodes[i].end(), f);
+        // The intervals that start after begin
+        auto first = starts.upper_bound(begin);
+        auto last  = starts.upper_bound(end);
+        std::for_each(first, last, [&](auto&& p) { f(p.second); });
+    }
 
-    live_range segment;
-    std::size_t id = invalid_offset;
-    std::list<std::size_t> use_points{};
-    std::size_t def_point = invalid_offset;
-    shape result{};
-    bool is_literal       = false;
-    bool is_live_on_entry = false;
+    private:
+    std::size_t leaves = 1;
+    // Segment tree where each node has the intervals that cover all of its range, but not its
+    // parent's range
+    std::vector<std::vector<std::size_t>> nodes;
+    std::multimap<std::size_t, std::size_t> starts;
 };
 
-using interval_ptr = live_interval*;
-
 struct memory_coloring_impl
 {
-    memory_coloring_impl(module* p, std::string alloc_op, bool p_verify)
-        : p_mod(p), allocation_op(std::move(alloc_op)), enable_verify(p_verify)
+    memory_coloring_impl(module* p,
+                         std::string alloc_op,
+                         bool p_verify,
+                         std::size_t p_alignment,
+                         std::size_t p_large_size,
+                         std::size_t p_large_alignment)
+        : p_mod(p),
+          allocation_op(std::move(alloc_op)),
+          enable_verify(p_verify),
+          alignment(p_alignment),
+          large_size(p_large_size),
+          large_alignment(p_large_alignment)
     {
     }
 
-    bool allocate(interval_ptr);
-    void add_conflicts(const std::set<int>& live_set, int val)
-    {
-        for(const auto& iter : live_set)
-        {
-            conflict_table[iter].insert(val);
-            conflict_table[val].insert(iter);
-        }
-    }
-    void build();
     void run();
-    void rewrite();
 
     private:
-    static bool is_param(const instruction_ref ins) { return ins->name() == "@param"; }
-    static bool is_output_param(const instruction_ref ins)
-    {
-        if(not is_param(ins))
-            return false;
-
-        auto param_name = any_cast<builtin::param>(ins->get_operator()).parameter;
-        return contains(param_name, "#output_");
-    }
     bool is_allocate(const instruction_ref ins) const { return ins->name() == allocation_op; }
-    static bool is_outline(const instruction_ref ins) { return ins->name() == "@outline"; }
-    static bool is_literal(const instruction_ref ins) { return ins->name() == "@literal"; }
-    static bool is_check_context(const instruction_ref ins)
-    {
-        return ins->name() == "check_context";
-    }
-
-    static bool is_disjoin(const live_range& range1, const live_range& range2)
-    {
-        if((range1.size == 0) || (range2.size == 0))
-            return false;
-        auto end1 = range1.offset + range1.size - 1;
-        auto end2 = range2.offset + range2.size - 1;
-        return ((end1 < range2.offset) || (end2 < range1.offset));
-    }
-    void verify();
-#ifdef MIGRAPHX_DEBUG_OPT
-    void dump(const std::string&);
-    void dump_module();
-    void dump_intervals();
-#endif
-    struct ordering
-    {
-        bool operator()(const interval_ptr& i1, const interval_ptr& i2) const
-        {
-            auto len1 = i1->get_end() - i1->get_begin();
-            auto len2 = i2->get_end() - i2->get_begin();
-            if(len1 != len2)
-            {
-                return (len1 < len2);
-            }
-            else if(i1->result.bytes() != i2->result.bytes())
-            {
-                return (i1->result.bytes() < i2->result.bytes());
-            }
-            else
-            {
-                return i1->id > i2->id;
-            }
-        }
-        bool operator()(const live_range* i1, const live_range* i2) const
-        {
-            return (i1->offset > i2->offset);
-        }
-    };
+    std::size_t get_alignment(const shape& s) const;
+    std::size_t get_scratch_alignment(instruction_ref scratch) const;
+    void build();
+    void plan();
+    void rewrite();
+    void verify() const;
 
     module* p_mod;
-    std::unordered_map<const instruction*, interval_ptr> instr2_live;
-    // universe of live intervals.
-    std::vector<live_interval> live_intervals = {};
-    // Map live range value number to live range.
-    std::unordered_map<int, live_range*> live_ranges = {};
-    // Map live range value number to a set of conflicting live ranges' value numbers.
-    std::unordered_map<int, std::set<int>> conflict_table = {};
-    // Priority queue for coloring.
-    std::priority_queue<interval_ptr, std::vector<interval_ptr>, ordering> alloc_queue{};
-
-    int num_of_lives           = 0;
-    int max_value_number       = -1;
-    std::size_t required_bytes = 0;
-    // The earliest program point where an live interval ends.
-    int earliest_end_point = -1;
-    // The latest program point where an live interval ends.
-    int latest_end_point = -1;
-    // Whether to unify literals into coloring.
-    bool unify_literals = false;
-    std::string allocation_op{};
+    std::string allocation_op;
     bool enable_verify;
-
-    ins_dep_map mod_implicit_deps;
+    std::size_t alignment;
+    std::size_t large_size;
+    std::size_t large_alignment;
+    std::vector<live_buffer> buffers;
+    std::size_t required_bytes = 0;
 };
 
 } // namespace MIGRAPHX_INLINE_NS
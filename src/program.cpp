@@ -1,4 +1,5 @@
 #include <migraphx/program.hpp>
+#include <migraphx/session.hpp>
 #include <migraphx/stringutils.hpp>
 #include <migraphx/instruction.hpp>
 #include <migraphx/op/identity.hpp>
@@ -22,6 +23,7 @@
 
 #include <unordered_set>
 #include <map>
+#include <mutex>
 #include <cassert>
 
 namespace migraphx {
@@ -29,14 +31,146 @@ inline namespace MIGRAPHX_INLINE_NS {
 
 using milliseconds = std::chrono::duration<double, std::milli>;
 
+struct eval_step
+{
+    enum step_kind
+    {
+        literal_step,
+        param_step,
+        outline_step,
+        return_step,
+        compute_step
+    };
+    step_kind kind = compute_step;
+    instruction_ref ins;
+    operation op;
+    // Slot indices of the inputs and the output
+    std::vector<std::size_t> inputs;
+    std::size_t output = 0;
+    // Precomputed result for literals and outlines
+    argument result;
+    std::string parameter;
+};
+
+struct module_plan
+{
+    std::vector<eval_step> steps;
+    // Version of the module the plan was built from
+    std::size_t version = 0;
+};
+
+/// Flattened form of the instruction stream used by eval, where every instruction is assigned an
+/// integer slot to store its result. The plan is not modified by eval, so it can be shared by
+/// evaluations running at the same time.
+struct eval_plan
+{
+    std::unordered_map<const module*, module_plan> modules;
+    std::size_t nslots = 0;
+    // Largest number of inputs of an instruction
+    std::size_t max_inputs = 0;
+};
+
+/// Storage used by a single evaluation
+struct eval_state
+{
+    std::vector<argument> slots;
+    // The input arguments passed to compute, one vector for each level of nested modules
+    std::vector<std::vector<argument>> args;
+    std::size_t depth = 0;
+
+    explicit eval_state(const eval_plan& plan) : slots(plan.nslots), args(plan.modules.size()) {}
+};
+
 struct program_impl
 {
     // A map is used to keep references to modules of the program
     std::unordered_map<std::string, module> modules;
     context ctx;
     std::string target_name;
+    // Cached execution plan, reset whenever the modules may have been modified
+    std::shared_ptr<const eval_plan> plan;
+    std::mutex plan_mutex;
 };
 
+static eval_plan make_eval_plan(const program& p)
+{
+    eval_plan plan;
+    auto mods = p.get_modules();
+    std::unordered_map<instruction_ref, std::size_t> slot_index;
+    for(const auto* mod : mods)
+    {
+        for(auto ins : iterator_for(*mod))
+            slot_index.emplace(ins, slot_index.size());
+    }
+    plan.nslots = slot_index.size();
+    for(const auto* mod : mods)
+    {
+        assert(mod->validate() == mod->end());
+        auto& mplan   = plan.modules[mod];
+        mplan.version = mod->version();
+        mplan.steps.reserve(mod->size());
+        for(auto ins : iterator_for(*mod))
+        {
+            eval_step step;
+            step.ins    = ins;
+            step.output = slot_index.at(ins);
+            std::transform(ins->inputs().begin(),
+                           ins->inputs().end(),
+                           std::back_inserter(step.inputs),
+                           [&](instruction_ref i) { return slot_index.at(i); });
+            plan.max_inputs  = std::max(plan.max_inputs, step.inputs.size());
+            const auto& name = ins->name();
+            if(name == "@literal")
+            {
+                step.kind = eval_step::literal_step;
+                // Shares the data with the literal, so a result that is a literal stays valid
+                // after the program is destroyed
+                step.result = ins->get_literal().get_shared_argument();
+            }
+            else if(name == "@param")
+            {
+                step.kind      = eval_step::param_step;
+                step.parameter = any_cast<builtin::param>(ins->get_operator()).parameter;
+            }
+            else if(name == "@outline")
+            {
+                step.kind   = eval_step::outline_step;
+                step.result = argument{ins->get_shape(), nullptr};
+            }
+            else if(name == "@return")
+            {
+                step.kind = eval_step::return_step;
+            }
+            else
+            {
+                step.kind = eval_step::compute_step;
+                step.op   = ins->normalized_operator();
+            }
+            mplan.steps.push_back(std::move(step));
+        }
+    }
+    return plan;
+}
+
+static bool is_stale(const eval_plan& plan)
+{
+    return std::any_of(plan.modules.begin(), plan.modules.end(), [](auto&& pp) {
+        return pp.first->version() != pp.second.version;
+    });
+}
+
+static std::shared_ptr<const eval_plan> get_eval_plan(const program& p, program_impl& impl)
+{
+    // The plan is only reused for compiled programs, otherwise the modules are likely to be
+    // modified between evaluations
+    if(not p.is_compiled())
+        return std::make_shared<eval_plan>(make_eval_plan(p));
+    std::lock_guard<std::mutex> lock(impl.plan_mutex);
+    if(impl.plan == nullptr or is_stale(*impl.plan))
+        impl.plan = std::make_shared<eval_plan>(make_eval_plan(p));
+    return impl.plan;
+}
+
 program::program() : impl(std::make_unique<program_impl>()) { this->create_module("main"); }
 
 program::program(program&&) noexcept = default;
@@ -66,6 +200,7 @@ void program::assign(const program& p)
     impl->ctx         = p.impl->ctx;
     impl->target_name = p.impl->target_name;
     impl->modules     = p.impl->modules;
+    impl->plan        = nullptr;
 
     // build a map from old ins to new ins
     // Build a map from old module to new module
@@ -172,100 +307,109 @@ void program::compile(const target& t, compile_options options)
         }
         mod->finalize(this->impl->ctx);
     }
+    this->impl->plan = std::make_shared<eval_plan>(make_eval_plan(*this));
 }
 
 void program::finalize()
 {
     auto* mm = this->get_main_module();
     mm->finalize(this->impl->ctx);
+    this->impl->plan = nullptr;
 }
 
 template <class F>
-std::vector<argument> generic_eval(const module* mod,
+std::vector<argument> generic_eval(const eval_plan& plan,
+                                   eval_state& state,
+                                   const module* mod,
                                    context& ctx,
-                                   std::unordered_map<std::string, argument> params,
-                                   std::unordered_map<instruction_ref, argument> results,
+                                   const std::unordered_map<std::string, argument>& params,
                                    F make_trace)
 {
-    assert(mod->validate() == mod->end());
-    results.reserve(mod->size() * 2);
-    std::vector<argument> values;
-    values.reserve(16);
-    auto trace = make_trace(mod);
-    for(auto ins : iterator_for(*mod))
+    assert(contains(plan.modules, mod));
+    const auto& mplan = plan.modules.at(mod);
+    auto& slots       = state.slots;
+    auto& args        = state.args.at(state.depth);
+    auto trace        = make_trace(mod);
+    args.reserve(plan.max_inputs);
+    // Sub-modules run on the same context, copying it would clone the whole context on the first
+    // non-const access
+    auto module_eval = [&](module_ref smod,
+                           const std::unordered_map<std::string, argument>& inputs) {
+        state.depth++;
+        auto result = generic_eval(plan, state, smod, ctx, inputs, make_trace);
+        state.depth--;
+        return result;
+    };
+    // Only capture a pointer so constructing the std::function for compute doesn't allocate
+    auto run = [f = &module_eval](module_ref& smod,
+                                  const std::unordered_map<std::string, argument>& inputs) {
+        return (*f)(smod, inputs);
+    };
+    for(const auto& step : mplan.steps)
     {
-        assert(results.find(ins) == results.end());
-        const auto& name = ins->name();
-        if(name == "@literal")
+        auto ins = step.ins;
+        switch(step.kind)
         {
-            results.emplace(ins, trace(ins, [&] { return ins->get_literal().get_argument(); }));
-        }
-        else if(name == "@param")
+        case eval_step::literal_step:
+        case eval_step::outline_step:
         {
-            results.emplace(
-                ins, trace(ins, [&] {
-                    auto param_name = any_cast<builtin::param>(ins->get_operator()).parameter;
-                    if(not contains(params, param_name))
-                        MIGRAPHX_THROW("Parameter not found: " + param_name);
-                    auto param = params[param_name];
-                    if(param.get_shape() != ins->get_shape())
-                        MIGRAPHX_THROW("Incorrect shape {" + to_string(param.get_shape()) +
-                                       "} for parameter: " + param_name);
-                    return param;
-                }));
+            slots[step.output] = trace(ins, [&] { return step.result; });
+            break;
         }
-        else if(name == "@outline")
+        case eval_step::param_step:
         {
-            results.emplace(ins, trace(ins, [&] { return argument{ins->get_shape(), nullptr}; }));
+            slots[step.output] = trace(ins, [&] {
+                auto param = params.find(step.parameter);
+                if(param == params.end())
+                    MIGRAPHX_THROW("Parameter not found: " + step.parameter);
+                if(param->second.get_shape() != ins->get_shape())
+                    MIGRAPHX_THROW("Incorrect shape {" + to_string(param->second.get_shape()) +
+                                   "} for parameter: " + step.parameter);
+                return param->second;
+            });
+            break;
         }
-        else if(name == "@return")
+        case eval_step::return_step:
         {
-            std::vector<argument> prog_outputs;
-            std::transform(ins->inputs().begin(),
-                           ins->inputs().end(),
-                           std::back_inserter(prog_outputs),
-                           [&](instruction_ref i) {
-                               assert(results.find(i) != results.end());
-                               return results[i];
-                           });
-
+            std::vector<argument> prog_outputs(step.inputs.size());
+            std::transform(step.inputs.begin(),
+                           step.inputs.end(),
+                           prog_outputs.begin(),
+                           [&](std::size_t i) { return slots[i]; });
             return prog_outputs;
         }
-        else
+        case eval_step::compute_step:
         {
-            values.resize(ins->inputs().size());
-            std::transform(
-                ins->inputs().begin(), ins->inputs().end(), values.begin(), [&](instruction_ref i) {
-                    assert(results.find(i) != results.end());
-                    return results[i];
-                });
-
-            const auto& mod_args = ins->module_inputs();
-            auto module_eval     = [&](module_ref smod,
-                                   const std::unordered_map<std::string, argument>& inputs) {
-                auto ssctx = ctx;
-                return generic_eval(smod, ssctx, inputs, results, make_trace);
-            };
-
-            results.emplace(ins, trace(ins, [&] {
-                                return ins->normalized_operator().compute(
-                                    ctx, ins->get_shape(), values, mod_args, module_eval);
-                            }));
+            args.resize(step.inputs.size());
+            std::transform(step.inputs.begin(),
+                           step.inputs.end(),
+                           args.begin(),
+                           [&](std::size_t i) { return slots[i]; });
+            slots[step.output] = trace(ins, [&] {
+                return step.op.compute(ctx, ins->get_shape(), args, ins->module_inputs(), run);
+            });
+            std::fill(args.begin(), args.end(), argument{});
+            break;
         }
-        assert(results.find(ins) != results.end());
-        assert(results.at(ins).get_shape() == ins->get_shape());
+        }
+        assert(slots[step.output].get_shape() == ins->get_shape());
     }
-    return {results.at(std::prev(mod->end()))};
+    if(mplan.steps.empty())
+        return {};
+    return {slots[mplan.steps.back().output]};
 }
 
 template <class F>
 std::vector<argument> generic_eval(const program& p,
-                                   context& ctx,
+                                   program_impl& impl,
                                    std::unordered_map<std::string, argument> params,
                                    F make_trace)
 {
-    const module* mm = p.get_main_module();
-    return generic_eval(mm, ctx, params, {}, make_trace);
+    auto plan = get_eval_plan(p, impl);
+    // The intermediate results are released with the state, so buffers are not kept alive
+    // between evaluations
+    eval_state state{*plan};
+    return generic_eval(*plan, state, p.get_main_module(), impl.ctx, params, make_trace);
 }
 
 std::vector<argument> program::eval(parameter_map params) const
@@ -297,7 +441,7 @@ std::vector<argument> program::eval(parameter_map params) const
     if(trace_level > 0)
     {
         return generic_eval(*this,
-                            ctx,
+                            *this->impl,
                             std::move(params),
                             with_check_context([&](auto& ins, auto f, auto&& check_context) {
                                 ctx.finish();
@@ -321,7 +465,7 @@ std::vector<argument> program::eval(parameter_map params) const
     else
     {
         return generic_eval(*this,
-                            ctx,
+                            *this->impl,
                             std::move(params),
                             with_check_context([&](auto&, auto f, auto&& check_context) {
                                 return check_context(f);
@@ -329,6 +473,51 @@ std::vector<argument> program::eval(parameter_map params) const
     }
 }
 
+struct session_impl
+{
+    const program* prog = nullptr;
+    context ctx;
+    // The plan is shared with the program, only the state is owned by the session
+    std::shared_ptr<const eval_plan> plan;
+    std::unique_ptr<eval_state> state;
+};
+
+session::session(const program& p) : impl(std::make_unique<session_impl>())
+{
+    if(not p.is_compiled())
+        MIGRAPHX_THROW("Sessions can only be created for a compiled program");
+    // The gpu context keeps the device copies of the literals, so a new context would be missing
+    // them
+    if(p.impl->target_name == "gpu")
+        MIGRAPHX_THROW("Sessions are not supported on the gpu target");
+    impl->prog = &p;
+    impl->ctx  = make_target(p.impl->target_name).get_context();
+    impl->ctx.from_value(p.impl->ctx.to_value());
+    impl->plan  = get_eval_plan(p, *p.impl);
+    impl->state = std::make_unique<eval_state>(*impl->plan);
+}
+
+session::session(session&&) noexcept = default;
+session& session::operator=(session&&) noexcept = default;
+session::~session() noexcept                    = default;
+
+std::vector<argument> session::eval(parameter_map params)
+{
+    auto result = generic_eval(*impl->plan,
+                               *impl->state,
+                               impl->prog->get_main_module(),
+                               impl->ctx,
+                               params,
+                               [](auto&&) { return [](auto&&, auto f) { return f(); }; });
+    // Release the intermediate results so buffers are not kept alive between evaluations
+    std::fill(impl->state->slots.begin(), impl->state->slots.end(), argument{});
+    return result;
+}
+
+const program& session::get_program() const { return *impl->prog; }
+
+context& session::get_context() const { return impl->ctx; }
+
 const int program_file_version = 5;
 
 value program::to_value() const
@@ -516,7 +705,7 @@ void program::mark(const parameter_map& params, marker&& m)
     ctx.finish();
     // Start marking
     m.mark_start(*this);
-    generic_eval(*this, ctx, params, always([&](auto ins, auto f) {
+    generic_eval(*this, *this->impl, params, always([&](auto ins, auto f) {
         argument result;
         m.mark_start(ins);
         result = f();
@@ -548,7 +737,7 @@ void program::perf_report(std::ostream& os,
     std::sort(total_vec.begin(), total_vec.end());
     std::unordered_map<instruction_ref, std::vector<double>> ins_vec;
     // Fill the map
-    generic_eval(*this, ctx, params, always([&](auto ins, auto) {
+    generic_eval(*this, *this->impl, params, always([&](auto ins, auto) {
         ins_vec[ins].reserve(n);
         return argument{ins->get_shape(), nullptr};
     }));
@@ -556,7 +745,7 @@ void program::perf_report(std::ostream& os,
     // Run and time each instruction
     for(std::size_t i = 0; i < n; i++)
     {
-        generic_eval(*this, ctx, params, always([&](auto ins, auto f) {
+        generic_eval(*this, *this->impl, params, always([&](auto ins, auto f) {
             argument result;
             ins_vec[ins].push_back(time<milliseconds>([&] {
                 result = f();
@@ -692,8 +881,7 @@ void program::print_cpp(std::ostream& os) const
 
 void program::dry_run(std::unordered_map<std::string, argument> params) const
 {
-    auto& ctx = this->impl->ctx;
-    generic_eval(*this, ctx, std::move(params), always([](auto ins, auto&&...) {
+    generic_eval(*this, *this->impl, std::move(params), always([](auto ins, auto&&...) {
         return argument{ins->get_shape(), nullptr};
     }));
 }
@@ -712,11 +900,17 @@ const module* program::get_module(const std::string& name) const { return &impl-
 module* program::create_module(const std::string& name)
 {
     assert(not contains(impl->modules, name));
+    impl->plan = nullptr;
     auto r = impl->modules.emplace(name, name);
     return &(r.first->second);
 }
 
-module* program::get_module(const std::string& name) { return &impl->modules.at(name); }
+module* program::get_module(const std::string& name)
+{
+    // The module can be modified so the plan needs to be rebuilt
+    impl->plan = nullptr;
+    return &impl->modules.at(name);
+}
 
 module* program::get_main_module() { return get_module("main"); }
 
@@ -812,6 +1006,7 @@ void program::remove_module(const std::string& name)
     }
 
     impl->modules.erase(name);
+    impl->plan = nullptr;
 }
 
 void program::remove_unused_modules()
@@ -825,6 +1020,7 @@ void program::remove_unused_modules()
 
 program& program::sort()
 {
+    impl->plan = nullptr;
     for(auto& pp : this->impl->modules)
     {
         pp.second.sort();
@@ -1,8 +1,11 @@
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/functional.h>
 #include <pybind11/numpy.h>
 #include <migraphx/program.hpp>
+#include <migraphx/session.hpp>
+#include <migraphx/bucketed_program.hpp>
 #include <migraphx/quantization.hpp>
 #include <migraphx/generate.hpp>
 #include <migraphx/ref/target.hpp>
@@ -14,6 +17,9 @@
 #include <migraphx/register_target.hpp>
 #include <migraphx/json.hpp>
 #include <migraphx/make_op.hpp>
+#include <migraphx/ranges.hpp>
+#include <future>
+#include <mutex>
 
 #ifdef HAVE_GPU
 #include <migraphx/gpu/hip.hpp>
@@ -117,6 +123,19 @@ struct npy_format_descriptor<half>
 } // namespace detail
 } // namespace pybind11
 
+// Python has no format for bf16, so its bits are exposed as uint16
+template <class T>
+std::string py_format()
+{
+    return py::format_descriptor<T>::format();
+}
+
+template <>
+std::string py_format<migraphx::bf16>()
+{
+    return py::format_descriptor<std::uint16_t>::format();
+}
+
 template <class F>
 void visit_type(const migraphx::shape& s, F f)
 {
@@ -159,7 +178,7 @@ py::buffer_info to_buffer_info(T& x)
         {
             b = py::buffer_info(x.data(),
                                 as.size(),
-                                py::format_descriptor<decltype(as())>::format(),
+                                py_format<decltype(as())>(),
                                 s.lens().size(),
                                 s.lens(),
                                 strides);
@@ -173,14 +192,17 @@ migraphx::shape to_shape(const py::buffer_info& info)
     migraphx::shape::type_t t;
     std::size_t n = 0;
     visit_types([&](auto as) {
-        if(info.format == py::format_descriptor<decltype(as())>::format() or
-           (info.format == "l" and py::format_descriptor<decltype(as())>::format() == "q") or
-           (info.format == "L" and py::format_descriptor<decltype(as())>::format() == "Q"))
+        // The bits of bf16 have the same format as uint16
+        if(as.type_enum() == migraphx::shape::bf16_type)
+            return;
+        if(info.format == py_format<decltype(as())>() or
+           (info.format == "l" and py_format<decltype(as())>() == "q") or
+           (info.format == "L" and py_format<decltype(as())>() == "Q"))
         {
             t = as.type_enum();
             n = sizeof(as());
         }
-        else if(info.format == "?" and py::format_descriptor<decltype(as())>::format() == "b")
+        else if(info.format == "?" and py_format<decltype(as())>() == "b")
         {
             t = migraphx::shape::bool_type;
             n = sizeof(bool);
@@ -208,6 +230,131 @@ migraphx::shape to_shape(const py::buffer_info& info)
     }
 }
 
+// The argument holds on to the python buffer, so its data stays valid for as long as the argument
+// or any result aliasing it is alive, even after python drops the buffer.
+migraphx::argument to_argument(const py::buffer& b, bool writable = false)
+{
+    auto* info = new py::buffer_info(b.request(writable)); // NOLINT
+    std::shared_ptr<char> data(reinterpret_cast<char*>(info->ptr), [info](char*) {
+        py::gil_scoped_acquire gil;
+        delete info; // NOLINT
+    });
+    return {to_shape(*info), data};
+}
+
+migraphx::parameter_map to_parameter_map(const py::dict& params)
+{
+    migraphx::parameter_map pm;
+    for(auto x : params)
+    {
+        std::string key = x.first.cast<std::string>();
+        pm[key]         = to_argument(x.second.cast<py::buffer>());
+    }
+    return pm;
+}
+
+std::vector<migraphx::argument> to_output_arguments(const py::list& outputs)
+{
+    std::vector<migraphx::argument> result;
+    for(auto x : outputs)
+        result.push_back(to_argument(x.cast<py::buffer>(), true));
+    return result;
+}
+
+// Eval uses the context of the program or session, so runs of the same one are serialized while
+// runs of different ones can overlap.
+std::shared_ptr<std::mutex> get_eval_mutex(const void* x)
+{
+    static std::mutex m;
+    static std::unordered_map<const void*, std::weak_ptr<std::mutex>> mutexes;
+    std::lock_guard<std::mutex> lock(m);
+    auto result = mutexes[x].lock();
+    if(result == nullptr)
+    {
+        for(auto it = mutexes.begin(); it != mutexes.end();)
+            it = it->second.expired() ? mutexes.erase(it) : std::next(it);
+        result      = std::make_shared<std::mutex>();
+        mutexes[x]  = result;
+    }
+    return result;
+}
+
+void copy_result(const migraphx::argument& result, const migraphx::argument& output)
+{
+    auto rs = result.get_shape();
+    auto os = output.get_shape();
+    if(rs.type() != os.type() or rs.lens() != os.lens())
+        MIGRAPHX_THROW("MIGRAPHX PYTHON: Output buffer has shape " + migraphx::to_string(os) +
+                       " but the result has shape " + migraphx::to_string(rs));
+    migraphx::visit_all(output, result)(
+        [&](auto out, auto in) { std::copy(in.begin(), in.end(), out.begin()); });
+}
+
+// Runs the program, or a session of it, without the GIL. Output buffers are bound to the output
+// parameters of the program when it has them (gpu without offload_copy), otherwise the results are
+// copied into them.
+template <class T>
+std::vector<migraphx::argument> run_program(T& x,
+                                            const migraphx::program& p,
+                                            migraphx::parameter_map pm,
+                                            const std::vector<migraphx::argument>& outputs)
+{
+    if(outputs.empty())
+    {
+        auto m = get_eval_mutex(&x);
+        std::lock_guard<std::mutex> lock(*m);
+        return x.eval(pm);
+    }
+    auto output_shapes = p.get_output_shapes();
+    if(outputs.size() != output_shapes.size())
+        MIGRAPHX_THROW("MIGRAPHX PYTHON: Expected " + std::to_string(output_shapes.size()) +
+                       " output buffers but got " + std::to_string(outputs.size()));
+    auto param_shapes = p.get_parameter_shapes();
+    auto prefix       = p.get_main_module()->name() + ":#output_";
+    for(std::size_t i = 0; i < outputs.size(); i++)
+    {
+        auto name = prefix + std::to_string(i);
+        if(migraphx::contains(param_shapes, name))
+            pm[name] = outputs[i];
+    }
+    auto m = get_eval_mutex(&x);
+    std::lock_guard<std::mutex> lock(*m);
+    auto results = x.eval(pm);
+    for(std::size_t i = 0; i < outputs.size(); i++)
+    {
+        if(results[i].data() != outputs[i].data())
+            copy_result(results[i], outputs[i]);
+    }
+    return outputs;
+}
+
+// A run started by run_async. The program is kept alive by the python object until the run is
+// finished, the buffers are held by the arguments.
+struct run_future
+{
+    std::shared_future<std::vector<migraphx::argument>> result;
+
+    void wait() const { result.wait(); }
+
+    bool done() const
+    {
+        return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+};
+
+template <class T>
+run_future
+start_run(T& x, const migraphx::program& p, const py::dict& params, const py::list& outputs)
+{
+    auto pm   = to_parameter_map(params);
+    auto outs = to_output_arguments(outputs);
+    run_future f;
+    f.result = std::async(std::launch::async, [&x, &p, pm, outs] {
+                   return run_program(x, p, pm, outs);
+               }).share();
+    return f;
+}
+
 MIGRAPHX_PYBIND11_MODULE(migraphx, m)
 {
     py::class_<migraphx::shape>(m, "shape")
@@ -231,8 +378,7 @@ MIGRAPHX_PYBIND11_MODULE(migraphx, m)
         .def_buffer([](migraphx::argument& x) -> py::buffer_info { return to_buffer_info(x); })
         .def("__init__",
              [](migraphx::argument& x, py::buffer b) {
-                 py::buffer_info info = b.request();
-                 new(&x) migraphx::argument(to_shape(info), info.ptr);
+                 new(&x) migraphx::argument(to_argument(b));
              })
         .def("get_shape", &migraphx::argument::get_shape)
         .def("tolist",
@@ -273,24 +419,107 @@ MIGRAPHX_PYBIND11_MODULE(migraphx, m)
                  auto* mm = p.get_main_module();
                  return *mm;
              })
-        .def("run",
-             [](migraphx::program& p, py::dict params) {
-                 migraphx::parameter_map pm;
-                 for(auto x : params)
-                 {
-                     std::string key      = x.first.cast<std::string>();
-                     py::buffer b         = x.second.cast<py::buffer>();
-                     py::buffer_info info = b.request();
-                     pm[key]              = migraphx::argument(to_shape(info), info.ptr);
-                 }
-                 return p.eval(pm);
-             })
+        .def(
+            "run",
+            [](migraphx::program& p, const py::dict& params, const py::list& outputs) {
+                auto pm   = to_parameter_map(params);
+                auto outs = to_output_arguments(outputs);
+                py::gil_scoped_release release;
+                return run_program(p, p, std::move(pm), outs);
+            },
+            py::arg("params"),
+            py::arg("outputs") = py::list())
+        .def(
+            "run_async",
+            [](migraphx::program& p, const py::dict& params, const py::list& outputs) {
+                return start_run(p, p, params, outputs);
+            },
+            py::arg("params"),
+            py::arg("outputs") = py::list(),
+            py::keep_alive<0, 1>())
         .def("sort", &migraphx::program::sort)
         .def("print", [](const migraphx::program& p) { std::cout << p << std::endl; })
         .def("__eq__", std::equal_to<migraphx::program>{})
         .def("__ne__", std::not_equal_to<migraphx::program>{})
         .def("__repr__", [](const migraphx::program& p) { return migraphx::to_string(p); });
 
+    py::class_<migraphx::session>(m, "session")
+        .def(py::init<const migraphx::program&>(), py::arg("p"), py::keep_alive<1, 2>())
+        .def(
+            "run",
+            [](migraphx::session& s, const py::dict& params, const py::list& outputs) {
+                auto pm   = to_parameter_map(params);
+                auto outs = to_output_arguments(outputs);
+                py::gil_scoped_release release;
+                return run_program(s, s.get_program(), std::move(pm), outs);
+            },
+            py::arg("params"),
+            py::arg("outputs") = py::list())
+        .def(
+            "run_async",
+            [](migraphx::session& s, const py::dict& params, const py::list& outputs) {
+                return start_run(s, s.get_program(), params, outputs);
+            },
+            py::arg("params"),
+            py::arg("outputs") = py::list(),
+            py::keep_alive<0, 1>());
+
+    py::class_<migraphx::bucketed_program>(m, "bucketed_program")
+        .def(py::init([](migraphx::bucketed_program::program_factory f,
+                         const migraphx::target& t,
+                         std::unordered_map<std::string, std::vector<std::size_t>> buckets,
+                         std::unordered_map<std::string, std::vector<std::string>> parameter_dims,
+                         std::vector<std::vector<std::string>> output_dims,
+                         bool offload_copy,
+                         bool fast_math,
+                         bool lazy,
+                         const std::string& cache_dir) {
+                 migraphx::bucket_options options;
+                 options.buckets              = std::move(buckets);
+                 options.parameter_dims       = std::move(parameter_dims);
+                 options.output_dims          = std::move(output_dims);
+                 options.options.offload_copy = offload_copy;
+                 options.options.fast_math    = fast_math;
+                 options.lazy                 = lazy;
+                 options.cache_dir            = cache_dir;
+                 return std::make_unique<migraphx::bucketed_program>(
+                     std::move(f), t, std::move(options));
+             }),
+             py::arg("factory"),
+             py::arg("t"),
+             py::arg("buckets"),
+             py::arg("parameter_dims"),
+             py::arg("output_dims")  = std::vector<std::vector<std::string>>{},
+             py::arg("offload_copy") = true,
+             py::arg("fast_math")    = true,
+             py::arg("lazy")         = false,
+             py::arg("cache_dir")    = "")
+        .def("get_buckets", &migraphx::bucketed_program::get_buckets)
+        .def("find_bucket", &migraphx::bucketed_program::find_bucket)
+        .def("get_program",
+             &migraphx::bucketed_program::get_program,
+             py::return_value_policy::reference_internal,
+             py::call_guard<py::gil_scoped_release>())
+        .def(
+            "run",
+            [](migraphx::bucketed_program& bp, const py::dict& params) {
+                auto pm = to_parameter_map(params);
+                py::gil_scoped_release release;
+                auto m = get_eval_mutex(&bp);
+                std::lock_guard<std::mutex> lock(*m);
+                return bp.eval(pm);
+            },
+            py::arg("params"));
+
+    py::class_<run_future>(m, "run_future")
+        .def("done", &run_future::done)
+        .def("wait", &run_future::wait, py::call_guard<py::gil_scoped_release>())
+        .def("result",
+             [](const run_future& f) {
+                 py::gil_scoped_release release;
+                 return f.result.get();
+             });
+
     py::class_<migraphx::operation>(m, "op")
         .def(py::init([](const std::string& name, py::kwargs kwargs) {
             migraphx::value v = migraphx::value::object{};
@@ -0,0 +1,134 @@
+#include <migraphx/rewrite_resize.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/op/resize.hpp>
+#include <migraphx/shape_for_each.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/module.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+static void rewrite_resize_ins(module& m, instruction_ref ins)
+{
+    auto op      = any_cast<op::resize>(ins->get_operator());
+    auto x       = ins->inputs().front();
+    auto in_lens = x->get_shape().lens();
+    auto out_s   = ins->get_shape();
+    auto type    = out_s.type();
+    auto samples = op.get_samples(in_lens);
+    auto ndim    = in_lens.size();
+    shape in_s{type, in_lens};
+
+    // Only the axes that blend two input elements need the high neighbor
+    std::vector<std::size_t> axes;
+    for(std::size_t d = 0; d < ndim; d++)
+    {
+        if(std::any_of(
+               samples[d].begin(), samples[d].end(), [](auto s) { return s.weight != 0.0; }))
+            axes.push_back(d);
+    }
+
+    // Corner c of every output element is stored in the c-th block along axis 0, where bit k
+    // of c selects the high neighbor of axes[k]
+    std::size_t ncorners     = std::size_t{1} << axes.size();
+    std::size_t out_elements = out_s.elements();
+    std::vector<int> ind(ncorners * out_elements);
+    std::vector<std::size_t> in_idx(ndim);
+    bool extrapolate = false;
+    std::vector<float> keep(out_elements, 1.0f);
+    shape_for_each(out_s, [&](const auto& idx) {
+        auto out_idx = out_s.index(idx);
+        for(std::size_t c = 0; c < ncorners; c++)
+        {
+            for(std::size_t d = 0; d < ndim; d++)
+                in_idx[d] = samples[d][idx[d]].lo;
+            for(std::size_t k = 0; k < axes.size(); k++)
+            {
+                if(((c >> k) & 1) != 0)
+                    in_idx[axes[k]] = samples[axes[k]][idx[axes[k]]].hi;
+            }
+            ind[c * out_elements + out_idx] = static_cast<int>(in_s.index(in_idx));
+        }
+        for(std::size_t d = 0; d < ndim; d++)
+        {
+            if(samples[d][idx[d]].extrapolate)
+            {
+                keep[out_idx] = 0.0f;
+                extrapolate   = true;
+            }
+        }
+    });
+
+    if(not x->get_shape().standard())
+        x = m.insert_instruction(ins, make_op("contiguous"), x);
+    std::vector<int64_t> rsp_lens = {static_cast<int64_t>(in_s.elements())};
+    auto rsp = m.insert_instruction(ins, make_op("reshape", {{"dims", rsp_lens}}), x);
+
+    auto ind_lens = out_s.lens();
+    ind_lens[0] *= ncorners;
+    auto ins_ind = m.add_literal(literal{shape{shape::int32_type, ind_lens}, ind});
+    auto data    = m.insert_instruction(ins, make_op("gather", {{"axis", 0}}), rsp, ins_ind);
+
+    // Blend the low and high halves along the last axis in axes first
+    auto out_lens = out_s.lens();
+    for(auto k = axes.size(); k > 0; k--)
+    {
+        auto axis = axes[k - 1];
+        auto half = std::size_t{1} << (k - 1);
+        std::vector<float> delta;
+        shape_for_each(out_s, [&](const auto& idx) {
+            delta.push_back(samples[axis][idx[axis]].weight);
+        });
+        std::vector<float> delta_data;
+        for(std::size_t j = 0; j < half; j++)
+            delta_data.insert(delta_data.end(), delta.begin(), delta.end());
+        auto dim_lens = out_lens;
+        dim_lens[0] *= half;
+        auto ins_delta = m.add_literal(literal{shape{type, dim_lens}, delta_data});
+
+        int64_t slc_stride = dim_lens[0];
+        auto low           = m.insert_instruction(
+            ins, make_op("slice", {{"axes", {0}}, {"starts", {0}}, {"ends", {slc_stride}}}), data);
+        auto hi = m.insert_instruction(
+            ins,
+            make_op("slice", {{"axes", {0}}, {"starts", {slc_stride}}, {"ends", {2 * slc_stride}}}),
+            data);
+        auto diff = m.insert_instruction(ins, make_op("sub"), hi, low);
+        auto ddf  = m.insert_instruction(ins, make_op("mul"), diff, ins_delta);
+        data      = m.insert_instruction(ins, make_op("add"), ddf, low);
+    }
+
+    if(extrapolate)
+    {
+        std::vector<float> fill(keep.size());
+        std::transform(keep.begin(), keep.end(), fill.begin(), [&](auto k) {
+            return k == 0.0f ? op.extrapolation_value : 0.0f;
+        });
+        auto ins_keep = m.add_literal(literal{shape{type, out_lens}, keep});
+        auto ins_fill = m.add_literal(literal{shape{type, out_lens}, fill});
+        data          = m.insert_instruction(ins, make_op("mul"), data, ins_keep);
+        data          = m.insert_instruction(ins, make_op("add"), data, ins_fill);
+    }
+
+    m.replace_instruction(ins, data);
+}
+
+void rewrite_resize::apply(module& m) const
+{
+    for(auto ins : iterator_for(m))
+    {
+        if(ins->name() != "resize")
+            continue;
+        // A scalar has nothing to resize
+        if(ins->get_shape().lens().empty())
+        {
+            m.replace_instruction(ins, ins->inputs().front());
+            continue;
+        }
+        rewrite_resize_ins(m, ins);
+    }
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
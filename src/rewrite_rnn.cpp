@@ -49,6 +49,17 @@ void rewrite_rnn::apply(module& prog) const
     }
 }
 
+std::vector<operation> rewrite_rnn::get_actv_funcs(instruction_ref ins) const
+{
+    if(ins->name() == "rnn")
+        return vanilla_rnn_actv_funcs(ins);
+    else if(ins->name() == "gru")
+        return gru_actv_funcs(ins);
+    else if(ins->name() == "lstm")
+        return lstm_actv_funcs(ins);
+    MIGRAPHX_THROW("REWRITE_RNN: " + ins->name() + " is not an rnn operator");
+}
+
 // NOLINTNEXTLINE(readability-function-cognitive-complexity)
 void rewrite_rnn::apply_vanilla_rnn(module& prog, instruction_ref ins) const
 {
@@ -6,29 +6,74 @@
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
+// NOLINTNEXTLINE
+static thread_local binary_sections* current_sections = nullptr;
+
+binary_sections_scope::binary_sections_scope(binary_sections& s) : prev(current_sections)
+{
+    current_sections = &s;
+}
+
+binary_sections_scope::~binary_sections_scope() { current_sections = prev; }
+
+binary_sections* current_binary_sections() { return current_sections; }
+
 template <class RawData>
 void raw_data_to_value(value& v, const RawData& rd)
 {
     value result;
     result["shape"] = migraphx::to_value(rd.get_shape());
+    auto bytes      = rd.get_shape().bytes();
+    auto* sections  = current_binary_sections();
     if(rd.get_shape().type() == shape::tuple_type)
+    {
         result["sub"] = migraphx::to_value(rd.get_sub_objects());
+    }
+    else if(sections != nullptr and bytes >= sections->min_size)
+    {
+        result["section"] = sections->saved.size();
+        sections->saved.emplace_back(rd.data(), bytes);
+    }
     else
-        result["data"] = migraphx::value::binary(rd.data(), rd.get_shape().bytes());
+    {
+        result["data"] = migraphx::value::binary(rd.data(), bytes);
+    }
     v = result;
 }
 
+static std::shared_ptr<char> get_section(const value& v, const shape& s)
+{
+    auto* sections = current_binary_sections();
+    auto i         = v.at("section").to<std::size_t>();
+    if(sections == nullptr or i >= sections->loaded.size())
+        MIGRAPHX_THROW("Missing data section " + std::to_string(i));
+    const auto& section = sections->loaded[i];
+    if(section.second != s.bytes())
+        MIGRAPHX_THROW("Data section " + std::to_string(i) + " has " +
+                       std::to_string(section.second) + " bytes but expected " +
+                       std::to_string(s.bytes()));
+    return section.first;
+}
+
 void migraphx_to_value(value& v, const literal& l) { raw_data_to_value(v, l); }
 void migraphx_from_value(const value& v, literal& l)
 {
     auto s = migraphx::from_value<shape>(v.at("shape"));
-    l      = literal(s, v.at("data").get_binary().data());
+    if(v.contains("section"))
+        l = literal(s, get_section(v, s));
+    else
+        l = literal(s, v.at("data").get_binary().data());
 }
 
 void migraphx_to_value(value& v, const argument& a) { raw_data_to_value(v, a); }
 void migraphx_from_value(const value& v, argument& a)
 {
-    if(v.contains("data"))
+    if(v.contains("section"))
+    {
+        auto s = migraphx::from_value<shape>(v.at("shape"));
+        a      = argument(s, get_section(v, s));
+    }
+    else if(v.contains("data"))
     {
         literal l = migraphx::from_value<literal>(v);
         a         = l.get_argument();
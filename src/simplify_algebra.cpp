@@ -1017,24 +1017,28 @@ void simplify_algebra::apply(module& p) const
     // Run simplifications multiple times
     for(int i = 0; i < 8; i++)
     {
-        match::find_matches(p,
-                            find_inner_broadcast{},
-                            find_double_add_lit_broadcast{},
-                            find_add_lit_broadcast{},
-                            find_add_convs{},
-                            find_conv_dot_horiz_fusion{},
-                            find_mul_conv{},
-                            find_mul_slice_conv{},
-                            find_mul_add{},
-                            find_div_const{},
-                            find_sub_const{},
-                            find_rsqrt{},
-                            find_concat_op{},
-                            find_split_concat{},
-                            find_splits{},
-                            find_split_reshape{},
-                            find_split_transpose{});
+        bool matched = match::find_matches(p,
+                                           find_inner_broadcast{},
+                                           find_double_add_lit_broadcast{},
+                                           find_add_lit_broadcast{},
+                                           find_add_convs{},
+                                           find_conv_dot_horiz_fusion{},
+                                           find_mul_conv{},
+                                           find_mul_slice_conv{},
+                                           find_mul_add{},
+                                           find_div_const{},
+                                           find_sub_const{},
+                                           find_rsqrt{},
+                                           find_concat_op{},
+                                           find_split_concat{},
+                                           find_splits{},
+                                           find_split_reshape{},
+                                           find_split_transpose{});
         dead_code_elimination{}.apply(p);
+        // The first round can enable more matches by leaving dead code behind, after that the
+        // module no longer changes once nothing matches
+        if(not matched and i > 0)
+            break;
     }
 }
 
@@ -0,0 +1,526 @@
+#include <migraphx/cpu/compile_pointwise.hpp>
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/compile_src.hpp>
+#include <migraphx/cpp_generator.hpp>
+#include <migraphx/dead_code_elimination.hpp>
+#include <migraphx/dynamic_loader.hpp>
+#include <migraphx/eliminate_common_subexpression.hpp>
+#include <migraphx/env.hpp>
+#include <migraphx/file_buffer.hpp>
+#include <migraphx/filesystem.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/module.hpp>
+#include <migraphx/pass_manager.hpp>
+#include <migraphx/reduce_dims.hpp>
+#include <migraphx/register_op.hpp>
+#include <migraphx/stringutils.hpp>
+#include <cerrno>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_CPU_KERNEL_CACHE_DIR)
+
+// Functions used by the point ops. Half and bf16 are stored as their bits and
+// computed in float, since there are no portable types for them on the host.
+static const char* const pointwise_runtime = R"__migraphx__(
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace migraphx {
+
+struct half
+{
+    std::uint16_t bits;
+
+    half() = default;
+    half(float f) : bits(from_float(f)) {}
+    operator float() const { return to_float(bits); }
+
+    static std::uint16_t from_float(float f)
+    {
+        std::uint32_t x;
+        std::memcpy(&x, &f, sizeof(x));
+        std::uint32_t sign = (x >> 16u) & 0x8000u;
+        std::uint32_t absx = x & 0x7fffffffu;
+        // Inf or nan
+        if(absx >= 0x7f800000u)
+            return sign | 0x7c00u | (absx > 0x7f800000u ? 0x200u : 0u);
+        // Too large, rounds to inf
+        if(absx >= 0x47800000u)
+            return sign | 0x7c00u;
+        // Subnormal, the value is a multiple of 2^-24
+        if(absx < 0x38800000u)
+        {
+            float a;
+            std::memcpy(&a, &absx, sizeof(a));
+            return sign | static_cast<std::uint16_t>(std::nearbyint(a * 16777216.0f));
+        }
+        // Rebias the exponent and round the mantissa to nearest even
+        absx += 0xc8000fffu + ((absx >> 13u) & 1u);
+        return sign | (absx >> 13u);
+    }
+
+    static float to_float(std::uint16_t h)
+    {
+        std::uint32_t sign = (h & 0x8000u) << 16u;
+        std::uint32_t e    = (h >> 10u) & 0x1fu;
+        std::uint32_t m    = h & 0x3ffu;
+        if(e == 0)
+        {
+            float r = std::ldexp(static_cast<float>(m), -24);
+            return sign == 0 ? r : -r;
+        }
+        std::uint32_t x = sign | (m << 13u);
+        if(e == 0x1fu)
+            x |= 0x7f800000u;
+        else
+            x |= (e + 112u) << 23u;
+        float r;
+        std::memcpy(&r, &x, sizeof(r));
+        return r;
+    }
+};
+
+struct bf16
+{
+    std::uint16_t bits;
+
+    bf16() = default;
+    bf16(float f) : bits(from_float(f)) {}
+    operator float() const { return to_float(bits); }
+
+    static std::uint16_t from_float(float f)
+    {
+        std::uint32_t x;
+        std::memcpy(&x, &f, sizeof(x));
+        // Keep nan a quiet nan
+        if((x & 0x7fffffffu) > 0x7f800000u)
+            return (x >> 16u) | 0x40u;
+        // Round to nearest even
+        x += 0x7fffu + ((x >> 16u) & 1u);
+        return x >> 16u;
+    }
+
+    static float to_float(std::uint16_t b)
+    {
+        std::uint32_t x = std::uint32_t{b} << 16u;
+        float r;
+        std::memcpy(&r, &x, sizeof(r));
+        return r;
+    }
+};
+
+inline float as_float(half x) { return x; }
+
+inline float as_float(bf16 x) { return x; }
+
+template <class T>
+T as_float(T x)
+{
+    return x;
+}
+
+// NOLINTNEXTLINE
+#define MIGRAPHX_CPU_MATH(name)                                 \
+    template <class... Ts>                                      \
+    auto name(Ts... xs)->decltype(std::name(as_float(xs)...))   \
+    {                                                           \
+        return std::name(as_float(xs)...);                      \
+    }
+
+MIGRAPHX_CPU_MATH(abs)
+MIGRAPHX_CPU_MATH(acos)
+MIGRAPHX_CPU_MATH(acosh)
+MIGRAPHX_CPU_MATH(asin)
+MIGRAPHX_CPU_MATH(asinh)
+MIGRAPHX_CPU_MATH(atan)
+MIGRAPHX_CPU_MATH(atanh)
+MIGRAPHX_CPU_MATH(ceil)
+MIGRAPHX_CPU_MATH(cos)
+MIGRAPHX_CPU_MATH(cosh)
+MIGRAPHX_CPU_MATH(erf)
+MIGRAPHX_CPU_MATH(exp)
+MIGRAPHX_CPU_MATH(floor)
+MIGRAPHX_CPU_MATH(log)
+MIGRAPHX_CPU_MATH(pow)
+MIGRAPHX_CPU_MATH(round)
+MIGRAPHX_CPU_MATH(sin)
+MIGRAPHX_CPU_MATH(sinh)
+MIGRAPHX_CPU_MATH(sqrt)
+MIGRAPHX_CPU_MATH(tan)
+MIGRAPHX_CPU_MATH(tanh)
+
+template <class T>
+auto rsqrt(T x) -> decltype(1 / std::sqrt(as_float(x)))
+{
+    return 1 / std::sqrt(as_float(x));
+}
+
+template <class T, class U>
+typename std::common_type<T, U>::type max(T a, U b)
+{
+    return (a < b) ? b : a;
+}
+
+template <class T, class U>
+typename std::common_type<T, U>::type min(T a, U b)
+{
+    return (a > b) ? b : a;
+}
+
+template <class T, class U>
+T convert(U x)
+{
+    return T(x);
+}
+
+} // namespace migraphx
+)__migraphx__";
+
+// The elements are split in rows along the innermost dimension. The strides of
+// the innermost dimension are constants, so the row loop can be vectorized.
+static const char* const pointwise_kernel = R"__migraphx__(
+namespace migraphx {
+
+${function}
+
+} // namespace migraphx
+
+extern "C" void pointwise_kernel(void** data, std::size_t start, std::size_t end)
+{
+    using migraphx::half;
+    using migraphx::bf16;
+${pointers}
+    std::size_t i = start;
+    while(i < end)
+    {
+        std::size_t row = i / ${inner};
+        std::size_t col = i % ${inner};
+        std::size_t n   = std::min<std::size_t>(${inner} - col, end - i);
+${row_pointers}
+        std::size_t r = row;
+        std::size_t k = 0;
+${offsets}
+        for(std::size_t j = 0; j < n; j++)
+            ${output} = migraphx::pointwise_op(${args});
+        i += n;
+    }
+}
+)__migraphx__";
+
+static std::string generate_literal(const literal& l)
+{
+    std::stringstream ss;
+    ss << std::setprecision(std::numeric_limits<double>::max_digits10);
+    l.visit([&](auto v) {
+        using type = typename decltype(v)::value_type;
+        double x   = v.front();
+        if(std::is_integral<type>{})
+            ss << static_cast<std::int64_t>(v.front());
+        else if(std::isnan(x))
+            ss << "std::numeric_limits<double>::quiet_NaN()";
+        else if(std::isinf(x))
+            ss << (x < 0 ? "-" : "") << "std::numeric_limits<double>::infinity()";
+        else
+            ss << x;
+    });
+    return shape::cpp_type(l.get_shape().type()) + "(" + ss.str() + ")";
+}
+
+static std::string generate_function(const std::vector<shape>& inputs, module m)
+{
+    run_passes(m, {eliminate_common_subexpression{}, dead_code_elimination{}});
+    cpp_generator g;
+    g.fmap([](const std::string& fname) { return "migraphx::" + fname; });
+    cpp_generator::function f;
+    // Parameters are ordered by their index rather than by name, so x10 comes after x9
+    for(std::size_t i = 0; i + 1 < inputs.size(); i++)
+        f.params.push_back({"x" + std::to_string(i), shape::cpp_type(inputs[i].type())});
+    f.return_type = shape::cpp_type(inputs.back().type());
+    f.set_name("pointwise_op")
+        .set_attributes({"inline"})
+        .set_body(m, [&](instruction_ref ins, const auto& names) -> std::string {
+            if(ins->name() == "@literal")
+                return generate_literal(ins->get_literal());
+            std::vector<std::string> args;
+            std::transform(ins->inputs().begin(),
+                           ins->inputs().end(),
+                           std::back_inserter(args),
+                           [&](auto i) { return names.at(i); });
+            // Round every result to its type, so intermediate values match the reference
+            return "migraphx::convert<" + shape::cpp_type(ins->get_shape().type()) + ">(" +
+                   g.generate_point_op(ins->get_operator(), args) + ")";
+        });
+    g.create_function(f);
+    return g.str();
+}
+
+static std::string generate_kernel(const std::vector<shape>& inputs, const module& m)
+{
+    auto shapes = reduce_dims(inputs);
+    auto ndim   = shapes.front().lens().size();
+    auto inner  = shapes.front().lens().back();
+    std::vector<std::string> pointers;
+    std::vector<std::string> row_pointers;
+    std::vector<std::string> args;
+    std::string output;
+    for(std::size_t i = 0; i < shapes.size(); i++)
+    {
+        auto type      = shape::cpp_type(shapes[i].type());
+        auto a         = "a" + std::to_string(i);
+        auto p         = "p" + std::to_string(i);
+        auto stride    = std::to_string(shapes[i].strides().back());
+        bool out       = i + 1 == shapes.size();
+        std::string cv = out ? "" : "const ";
+        pointers.push_back("    " + cv + type + "* " + a + " = static_cast<" + cv + type +
+                           "*>(data[" + std::to_string(i) + "]);");
+        row_pointers.push_back("        " + cv + type + "* " + p + " = " + a + " + col * " +
+                               stride + ";");
+        auto element = p + "[j * " + stride + "]";
+        if(out)
+            output = element;
+        else
+            args.push_back(element);
+    }
+    std::vector<std::string> offsets;
+    for(std::size_t d = ndim - 1; d > 0; d--)
+    {
+        auto len         = std::to_string(shapes.front().lens()[d - 1]);
+        std::string line = "        k = r % " + len + ";\n        r /= " + len + ";";
+        for(std::size_t i = 0; i < shapes.size(); i++)
+            line += "\n        p" + std::to_string(i) + " += k * " +
+                    std::to_string(shapes[i].strides()[d - 1]) + ";";
+        offsets.push_back(line);
+    }
+    auto src = interpolate_string(pointwise_kernel,
+                                  {{"function", generate_function(inputs, m)},
+                                   {"pointers", join_strings(pointers, "\n")},
+                                   {"row_pointers", join_strings(row_pointers, "\n")},
+                                   {"offsets", join_strings(offsets, "\n")},
+                                   {"inner", std::to_string(inner)},
+                                   {"output", output},
+                                   {"args", join_strings(args, ", ")}});
+    return pointwise_runtime + src;
+}
+
+using pointwise_function = std::function<void(void**, std::size_t, std::size_t)>;
+
+static const std::string& kernel_flags()
+{
+    static const std::string flags = "-std=c++14 -O3 -march=native -fno-math-errno -fPIC -shared";
+    return flags;
+}
+
+static std::vector<char> compile_kernel(const std::string& src)
+{
+    src_compiler compiler;
+    compiler.flags  = kernel_flags();
+    compiler.output = "libpointwise.so";
+    src_file f;
+    f.path    = "pointwise.cpp";
+    f.content = std::make_pair(src.data(), src.data() + src.size());
+    return compiler.compile({f});
+}
+
+// The kernels are built with -march=native, so the cache is keyed on the cpu
+// as well, in case the cache directory is shared between machines
+static const std::string& host_isa()
+{
+    static const std::string isa = [] {
+        std::ifstream is("/proc/cpuinfo");
+        std::string model;
+        std::string flags;
+        std::string line;
+        while(std::getline(is, line) and (model.empty() or flags.empty()))
+        {
+            if(starts_with(line, "model name") and model.empty())
+                model = line;
+            else if(starts_with(line, "flags") and flags.empty())
+                flags = line;
+        }
+        return model + "\n" + flags;
+    }();
+    return isa;
+}
+
+// Kernels are cached per user, since a library in the cache is loaded into the
+// process. An empty path disables the cache.
+static fs::path kernel_cache_dir()
+{
+    auto dir = string_value_of(MIGRAPHX_CPU_KERNEL_CACHE_DIR{});
+    if(not dir.empty())
+        return dir;
+    auto xdg = string_value_of("XDG_CACHE_HOME");
+    if(not xdg.empty())
+        return fs::path{xdg} / "migraphx" / "cpu-kernels";
+    auto home = string_value_of("HOME");
+    if(not home.empty())
+        return fs::path{home} / ".cache" / "migraphx" / "cpu-kernels";
+    return {};
+}
+
+// Only files owned by the current user, which nobody else can write to, are
+// trusted. Symlinks are not followed.
+static bool is_private(const fs::path& p, bool directory)
+{
+    struct stat st;
+    if(lstat(p.c_str(), &st) != 0)
+        return false;
+    if(directory ? not S_ISDIR(st.st_mode) : not S_ISREG(st.st_mode))
+        return false;
+    return st.st_uid == geteuid() and (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+static bool make_cache_dir(const fs::path& dir)
+{
+    std::error_code ec;
+    fs::create_directories(dir.parent_path(), ec);
+    if(mkdir(dir.c_str(), S_IRWXU) != 0 and errno != EEXIST)
+        return false;
+    return is_private(dir, true);
+}
+
+// Compiled kernels are stored on disk by the hash of their source, so they are
+// built once per machine rather than once per compile. The source is stored
+// next to the library to detect hash collisions.
+static dynamic_loader load_kernel(const std::string& src)
+{
+    std::stringstream ss;
+    ss << std::hex << std::hash<std::string>{}(kernel_flags() + host_isa() + src);
+    auto dir = kernel_cache_dir();
+    if(dir.empty() or not make_cache_dir(dir))
+        return dynamic_loader{compile_kernel(src)};
+    auto lib_path = dir / (ss.str() + ".so");
+    auto src_path = dir / (ss.str() + ".cpp");
+    if(is_private(lib_path, false) and is_private(src_path, false) and
+       read_string(src_path) == src)
+        return dynamic_loader{lib_path};
+
+    auto image = compile_kernel(src);
+    // Write to a unique file first and rename it, so processes sharing the
+    // cache never see a partial library
+    auto tmp = dir / (ss.str() + "-" + std::to_string(std::random_device{}()));
+    try
+    {
+        std::error_code ec;
+        write_buffer(tmp.string() + ".so", image);
+        write_buffer(tmp.string() + ".cpp", src.data(), src.size());
+        for(const auto* ext : {".so", ".cpp"})
+            fs::permissions(tmp.string() + ext, fs::perms::owner_read | fs::perms::owner_write, ec);
+        fs::rename(tmp.string() + ".so", lib_path, ec);
+        fs::rename(tmp.string() + ".cpp", src_path, ec);
+    }
+    catch(const std::exception&)
+    {
+        // The cache is only an optimization, the kernel is loaded from
+        // memory when it cant be written
+    }
+    return dynamic_loader{image};
+}
+
+static pointwise_function get_kernel(const std::string& src)
+{
+    static std::mutex m;
+    static std::unordered_map<std::string, pointwise_function> kernels;
+    std::lock_guard<std::mutex> lock(m);
+    auto it = kernels.find(src);
+    if(it != kernels.end())
+        return it->second;
+    auto f = load_kernel(src).get_function<void(void**, std::size_t, std::size_t)>(
+        "pointwise_kernel");
+    kernels.emplace(src, f);
+    return f;
+}
+
+struct cpu_pointwise : auto_register_op<cpu_pointwise>
+{
+    std::string source;
+    std::vector<shape> expected_inputs;
+    pointwise_function kernel = nullptr;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.source, "source"), f(self.expected_inputs, "expected_inputs"));
+    }
+
+    std::string name() const { return "cpu::pointwise"; }
+
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        // The strides are compiled into the kernel
+        auto output = inputs.back();
+        std::transform(inputs.begin(), inputs.end(), inputs.begin(), [](const shape& s) {
+            return s.normalize_standard();
+        });
+        auto einputs = expected_inputs;
+        std::transform(einputs.begin(), einputs.end(), einputs.begin(), [](const shape& s) {
+            return s.normalize_standard();
+        });
+        if(einputs != inputs)
+            MIGRAPHX_THROW("Input shapes have changed: [" + to_string_range(einputs) + "] -> [" +
+                           to_string_range(inputs) + "]");
+        return output;
+    }
+
+    void finalize(context&, const shape&, const std::vector<shape>&)
+    {
+        kernel = get_kernel(source);
+    }
+
+    argument
+    compute(context& ctx, const shape& output_shape, const std::vector<argument>& args) const
+    {
+        if(kernel == nullptr)
+            MIGRAPHX_THROW("cpu::pointwise: kernel is not compiled");
+        std::vector<void*> data(args.size());
+        std::transform(
+            args.begin(), args.end(), data.begin(), [](const auto& arg) { return arg.data(); });
+        ctx.bulk_execute(output_shape.elements(), 4096, [&](auto start, auto end) {
+            kernel(data.data(), start, end);
+        });
+        return args.back();
+    }
+
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const cpu_pointwise& op)
+    {
+        os << op.name() << "[source=" << op.source.size() << "]";
+        return os;
+    }
+};
+
+operation compile_pointwise(const std::vector<shape>& inputs, module m)
+{
+    cpu_pointwise op;
+    op.source          = generate_kernel(inputs, m);
+    op.expected_inputs = inputs;
+    return op;
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
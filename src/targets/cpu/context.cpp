@@ -0,0 +1,166 @@
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/make_shared_array.hpp>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+struct context::stream_state
+{
+    std::size_t inter_op = 1;
+    std::size_t intra_op = 1;
+    std::size_t node     = thread_pool::any_node;
+    // Runs the parallel loops of every stream
+    std::shared_ptr<thread_pool> threads = nullptr;
+    // The pool is only started once something runs asynchronously
+    std::unique_ptr<task_pool> pool = nullptr;
+    std::size_t current             = 0;
+    // Last task added to each stream
+    std::vector<task_ref> streams;
+    // Events the next task on each stream has to wait for
+    std::vector<std::vector<task_ref>> waits;
+    std::unordered_map<std::size_t, task_ref> events;
+    std::mutex preallocations_mutex;
+    std::unordered_map<std::string, argument> preallocations;
+
+    stream_state(std::size_t inter, std::size_t intra, std::size_t numa_node)
+        : inter_op(std::max<std::size_t>(inter, 1)), intra_op(intra), node(numa_node)
+    {
+        if(intra_op == 0)
+            intra_op = std::max<std::size_t>(max_threads() / inter_op, 1);
+        streams.resize(inter_op);
+        waits.resize(inter_op);
+        auto& shared = default_thread_pool();
+        if(node == thread_pool::any_node and inter_op * intra_op == shared.size())
+            threads = std::shared_ptr<thread_pool>(&shared, [](thread_pool*) {});
+        else
+            threads = std::make_shared<thread_pool>(inter_op * intra_op, node);
+    }
+
+    stream_state(const stream_state& s)
+        : inter_op(s.inter_op), intra_op(s.intra_op), node(s.node), threads(s.threads)
+    {
+        streams.resize(inter_op);
+        waits.resize(inter_op);
+    }
+
+    task_pool& get_pool()
+    {
+        if(pool == nullptr)
+        {
+            auto n = intra_op;
+            pool   = std::make_unique<task_pool>(inter_op, [=] { set_max_threads(n); });
+        }
+        return *pool;
+    }
+
+    void reset()
+    {
+        std::fill(streams.begin(), streams.end(), nullptr);
+        for(auto& w : waits)
+            w.clear();
+        events.clear();
+    }
+};
+
+context::context(std::size_t inter_op, std::size_t intra_op, std::size_t numa_node)
+    : state(std::make_shared<stream_state>(inter_op, intra_op, numa_node))
+{
+}
+
+context::context(const context& ctx) : state(std::make_shared<stream_state>(*ctx.state)) {}
+
+context& context::operator=(const context& ctx)
+{
+    if(this != &ctx)
+        state = std::make_shared<stream_state>(*ctx.state);
+    return *this;
+}
+
+void context::finish() const
+{
+    if(state->pool != nullptr)
+        state->pool->wait_all();
+    state->reset();
+}
+
+std::size_t context::nstreams() const { return state->inter_op; }
+
+std::size_t context::intra_op_threads() const { return state->intra_op; }
+
+std::size_t context::numa_node() const { return state->node; }
+
+thread_pool& context::get_thread_pool() const { return *state->threads; }
+
+void context::set_stream(std::size_t n) { state->current = n; }
+
+void context::record_event(std::size_t event)
+{
+    state->events[event] = state->streams.at(state->current);
+}
+
+void context::wait_event(std::size_t event)
+{
+    auto it = state->events.find(event);
+    if(it == state->events.end())
+        return;
+    state->waits.at(state->current).push_back(it->second);
+}
+
+task_ref context::async(std::function<void()> f)
+{
+    auto& deps = state->waits.at(state->current);
+    auto& last = state->streams.at(state->current);
+    deps.push_back(last);
+    last = state->get_pool().add(std::move(f), deps);
+    deps.clear();
+    return last;
+}
+
+// Page aligned so the offsets that memory coloring aligns in the scratch memory are aligned in
+// memory as well
+static argument allocate_aligned(const shape& s)
+{
+    const std::size_t alignment = 4096;
+    auto buffer                 = make_shared_array<char>(s.bytes() + alignment);
+    auto misalignment           = reinterpret_cast<std::uintptr_t>(buffer.get()) % alignment;
+    char* data                  = buffer.get() + (alignment - misalignment) % alignment;
+    return {s, [buffer, data] { return data; }};
+}
+
+argument context::get_preallocation(const std::string& id, const shape& s)
+{
+    std::lock_guard<std::mutex> lock(state->preallocations_mutex);
+    auto& a = state->preallocations[id];
+    if(a.get_shape() != s)
+        a = allocate_aligned(s);
+    return a;
+}
+
+value context::to_value() const
+{
+    value result;
+    result["streams"]          = nstreams();
+    result["intra_op_threads"] = intra_op_threads();
+    result["numa_node"]        = numa_node();
+    return result;
+}
+
+void context::from_value(const value& v)
+{
+    if(not v.contains("streams"))
+        return;
+    auto inter_op = v.at("streams").to<std::size_t>();
+    auto intra_op = v.at("intra_op_threads").to<std::size_t>();
+    auto node     = v.get("numa_node", thread_pool::any_node);
+    if(inter_op == nstreams() and intra_op == intra_op_threads() and node == numa_node())
+        return;
+    state = std::make_shared<stream_state>(inter_op, intra_op, node);
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -12,8 +12,8 @@ namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 namespace cpu {
 
-struct dnnl_convolution
-    : dnnl_extend_op<dnnl_convolution, dnnl::convolution_forward, op::convolution>
+template <class Derived, class Op, template <class, class, class> class Base = dnnl_extend_op>
+struct dnnl_convolution_op : Base<Derived, dnnl::convolution_forward, Op>
 {
     std::vector<int> arg_map(int) const
     {
@@ -22,7 +22,8 @@ struct dnnl_convolution
 
     shape adjust_shape(const shape& x, int i) const
     {
-        auto s = base_adjust_shape(x);
+        const auto& op = this->op;
+        auto s         = this->base_adjust_shape(x);
         if(i == 1 and op.group > 1)
         {
             // TODO: Add support for transposed weights
@@ -39,6 +40,7 @@ struct dnnl_convolution
     dnnl::convolution_forward::desc
     get_desc(const std::unordered_map<int, dnnl::memory::desc>& m) const
     {
+        const auto& op = this->op;
         // In DNNL dilation is zero-based
         auto dilation = op.dilation;
         std::transform(
@@ -58,6 +60,15 @@ struct dnnl_convolution
     }
 };
 
+struct dnnl_convolution : dnnl_convolution_op<dnnl_convolution, op::convolution>
+{
+};
+
+struct dnnl_quant_convolution
+    : dnnl_convolution_op<dnnl_quant_convolution, op::quant_convolution, dnnl_quant_extend_op>
+{
+};
+
 } // namespace cpu
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
@@ -30,6 +30,12 @@ dnnl_context& get_dnnl_context()
     return ctx;
 }
 
+dnnl::stream& get_dnnl_stream()
+{
+    static thread_local dnnl::stream stream{get_dnnl_context().engine}; // NOLINT
+    return stream;
+}
+
 #ifdef __clang__
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wswitch-enum"
@@ -41,6 +47,7 @@ dnnl::memory::data_type to_dnnl_memory_data_type(shape::type_t t)
     switch(t)
     {
     case st::half_type: return dt::f16;
+    case st::bf16_type: return dt::bf16;
     case st::float_type: return dt::f32;
     case st::int32_type: return dt::s32;
     case st::int8_type: return dt::s8;
@@ -81,6 +88,94 @@ dnnl::memory to_dnnl_memory(const argument& a)
     return to_dnnl_memory(to_dnnl_memory_desc(a.get_shape()), a);
 }
 
+// clang-format off
+#define MIGRAPHX_VISIT_DNNL_FORMAT_TAG(m) \
+        m(any) \
+        m(ncw) \
+        m(nwc) \
+        m(nchw) \
+        m(nhwc) \
+        m(ncdhw) \
+        m(ndhwc) \
+        m(nCw8c) \
+        m(nCw16c) \
+        m(nChw8c) \
+        m(nChw16c) \
+        m(nCdhw8c) \
+        m(nCdhw16c) \
+        m(ab) \
+        m(ba) \
+        m(hwio) \
+        m(OIw8i8o) \
+        m(OIw16i16o) \
+        m(Owi8o) \
+        m(Owi16o) \
+        m(OIhw8i8o) \
+        m(OIhw16i16o) \
+        m(OIhw8o8i) \
+        m(OIhw16o16i) \
+        m(Ohwi8o) \
+        m(Ohwi16o) \
+        m(OIdhw8i8o) \
+        m(OIdhw16i16o) \
+        m(Odhwi8o) \
+        m(Odhwi16o)
+// clang-format on
+
+const std::unordered_map<std::string, dnnl::memory::format_tag>& dnnl_format_tag_map()
+{
+    static const std::unordered_map<std::string, dnnl::memory::format_tag> m = {
+#define MIGRAPHX_DNNL_FORMAT_TAG_GENERATE_VISITOR(x) {#x, dnnl::memory::format_tag::x},
+        MIGRAPHX_VISIT_DNNL_FORMAT_TAG(MIGRAPHX_DNNL_FORMAT_TAG_GENERATE_VISITOR)
+#undef MIGRAPHX_DNNL_FORMAT_TAG_GENERATE_VISITOR
+    };
+    return m;
+}
+
+dnnl::memory::format_tag to_dnnl_format_tag(const std::string& name)
+{
+    if(dnnl_format_tag_map().count(name) == 0)
+        MIGRAPHX_THROW("Missing dnnl format tag: " + name);
+    return dnnl_format_tag_map().at(name);
+}
+
+dnnl::memory::desc to_dnnl_memory_desc(const shape& s, const std::string& format)
+{
+    if(format.empty())
+        return to_dnnl_memory_desc(s);
+    return {to_dnnl_dims(s.lens()), to_dnnl_memory_data_type(s.type()), to_dnnl_format_tag(format)};
+}
+
+shape get_buffer_shape(const shape& s, const std::string& format)
+{
+    if(format.empty())
+        return s;
+    auto bytes = to_dnnl_memory_desc(s, format).get_size();
+    return shape{s.type(), {bytes / s.type_size()}};
+}
+
+std::string to_format_string(const dnnl::memory::desc& desc, const shape& s)
+{
+    if(desc == to_dnnl_memory_desc(s))
+        return {};
+    for(auto&& p : dnnl_format_tag_map())
+    {
+        if(p.first == "any")
+            continue;
+        try
+        {
+            if(desc == to_dnnl_memory_desc(s, p.first))
+                return p.first;
+        }
+        catch(const dnnl::error&)
+        {
+            // The tag has a different number of dimensions
+            continue;
+        }
+    }
+    return "any";
+}
+
 // clang-format off
 #define MIGRAPHX_VISIT_DNNL_ALGO(m) \
         m(undef) \
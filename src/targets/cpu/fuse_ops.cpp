@@ -12,7 +12,7 @@ namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 namespace cpu {
 
-MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_DISABLE_DNNL_POST_OPS_WORKAROUND);
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_DISABLE_DNNL_POST_OPS);
 
 MIGRAPHX_PRED_MATCHER(has_post_ops, instruction_ref ins)
 {
@@ -20,35 +20,27 @@ MIGRAPHX_PRED_MATCHER(has_post_ops, instruction_ref ins)
     return v.contains("post_ops");
 }
 
-MIGRAPHX_PRED_MATCHER(without_post_ops, instruction_ref ins)
+// dnnl computes some combinations of post ops incorrectly: a post op that has post ops of its
+// own, two eltwise post ops in a row, or the same algorithm applied twice. Those are not fused.
+bool is_fusable_post_op(const operation& op, const operation& post_op)
 {
-    auto v = ins->get_operator().to_value();
-    return v.contains("post_ops") and v["post_ops"].empty();
-}
-
-bool workaround_dnnl_broken_post_ops(const operation& op, const operation& post_op)
-{
-    if(contains({"dnnl::dot", "dnnl::convolution"}, op.name()))
-        return true;
     auto pv = post_op.to_value();
     if(not pv.at("post_ops").empty())
-        return true;
+        return false;
     auto v         = op.to_value();
     auto last_op   = v.at("post_ops").empty() ? v : v.at("post_ops").back();
     auto algo      = last_op.contains("algo") ? last_op.at("algo").to<std::string>() : op.name();
     auto post_algo = pv["algo"].to<std::string>();
     if(starts_with(algo, "eltwise") and starts_with(post_algo, "eltwise"))
-        return true;
-    if(algo == post_algo)
-        return true;
-    return false;
+        return false;
+    return algo != post_algo;
 }
 
-operation merge_post_ops(const operation& op, const operation& post_op)
+operation merge_post_ops(const operation& op, const operation& post_op, const std::string& algo)
 {
     auto pv = post_op.to_value();
     auto v  = op.to_value();
-    v["post_ops"].push_back({{"algo", pv["algo"]},
+    v["post_ops"].push_back({{"algo", algo},
                              {"alpha", pv["alpha"].value_or(0.0f)},
                              {"beta", pv["beta"].value_or(0.0f)}});
     auto post_ops = pv.at("post_ops");
@@ -57,34 +49,61 @@ operation merge_post_ops(const operation& op, const operation& post_op)
     return make_op(op.name(), v);
 }
 
+// The result of a dnnl op can be overwritten by a sum post op when nothing
+// else reads it, since its buffer is an allocation only used by that op
+bool can_accumulate(instruction_ref ins, instruction_ref y)
+{
+    if(y->outputs().size() != 1)
+        return false;
+    if(y->get_shape() != ins->get_shape() or not y->get_shape().standard())
+        return false;
+    auto v = y->get_operator().to_value();
+    return starts_with(y->name(), "dnnl::") and v.contains("post_ops");
+}
+
 struct find_post_ops
 {
     context* ctx = nullptr;
     match::any_matcher matcher() const
     {
-        if(enabled(MIGRAPHX_DISABLE_DNNL_POST_OPS_WORKAROUND{}))
-            return match::name("dnnl::eltwise",
-                               "dnnl::binary")(match::arg(0)(has_post_ops(), match::used_once()));
-        else
-            return match::name("dnnl::eltwise")(
-                without_post_ops(),
-                match::arg(0)(match::name("dnnl::binary")(without_post_ops(), match::used_once())));
+        auto x = match::all_of(has_post_ops(), match::used_once()).bind("x");
+        return match::any_of(
+            match::name("dnnl::eltwise")(match::arg(0)(x)),
+            match::name("dnnl::binary")(match::either_arg(0, 1)(x, match::any().bind("y"))));
     }
 
     void apply(module& m, const match::matcher_result& r) const
     {
         auto ins   = r.result;
-        auto x_ins = ins->inputs().front();
+        auto x_ins = r.instructions.at("x");
         auto x     = x_ins->get_operator();
 
-        if(workaround_dnnl_broken_post_ops(x, ins->get_operator()))
+        if(not is_fusable_post_op(x, ins->get_operator()))
             return;
 
-        auto op       = merge_post_ops(x, ins->get_operator());
+        auto algo     = ins->get_operator().to_value()["algo"].to<std::string>();
         auto inputs   = x_ins->inputs();
         inputs.back() = ins->inputs().back();
         if(ins->name() == "dnnl::binary")
-            inputs.insert(std::prev(inputs.end()), ins->inputs().at(1));
+        {
+            auto y = r.instructions.at("y");
+            if(y == x_ins)
+                return;
+            // Post ops can only take the other operand as the second argument
+            if(y == ins->inputs().front() and algo == "binary_div")
+                return;
+            // Accumulate into the other operand directly when its buffer can be reused
+            if(algo == "binary_add" and can_accumulate(ins, y))
+            {
+                algo          = "sum";
+                inputs.back() = y;
+            }
+            else
+            {
+                inputs.insert(std::prev(inputs.end()), y);
+            }
+        }
+        auto op           = merge_post_ops(x, ins->get_operator(), algo);
         auto input_shapes = to_shapes(inputs);
         auto new_shape    = try_compute_shape(op, input_shapes);
         if(new_shape.empty() or new_shape.front() != ins->get_shape())
@@ -98,10 +117,14 @@ struct find_post_ops
 
 void fuse_ops::apply(module& m) const
 {
+    if(enabled(MIGRAPHX_DISABLE_DNNL_POST_OPS{}))
+        return;
     for(std::size_t i = 0; i < 4; i++)
     {
-        match::find_matches(m, find_post_ops{ctx});
+        bool matched = match::find_matches(m, find_post_ops{ctx});
         dead_code_elimination{}.apply(m);
+        if(not matched and i > 0)
+            break;
     }
 }
 
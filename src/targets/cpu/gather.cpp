@@ -2,6 +2,10 @@
 #include <migraphx/context.hpp>
 #include <migraphx/cpu/context.hpp>
 #include <migraphx/op/gather.hpp>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <numeric>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -27,28 +31,42 @@ struct cpu_gather : auto_register_op<cpu_gather>
 
     argument
     // cppcheck-suppress constParameter
-    compute(context& ctx, const shape& output_shape, const std::vector<argument>& args) const
+    compute(context& ctx, const shape&, const std::vector<argument>& args) const
     {
-        std::size_t nelements = output_shape.elements();
-        auto lens             = args[0].get_shape().lens();
-        auto axis_dim_size    = lens[op.axis];
-        lens[op.axis]         = args[1].get_shape().elements();
-        shape out_comp{output_shape.type(), lens};
+        // View the input as [outer, axis_dim, inner] so every gathered index copies `outer`
+        // contiguous slabs of `inner` elements
+        auto lens          = args[0].get_shape().lens();
+        auto axis          = op.axis;
+        auto axis_dim_size = static_cast<std::int64_t>(lens[axis]);
+        auto outer =
+            std::accumulate(lens.begin(), lens.begin() + axis, std::size_t{1}, std::multiplies<>{});
+        auto inner = std::accumulate(
+            lens.begin() + axis + 1, lens.end(), std::size_t{1}, std::multiplies<>{});
+        auto nindices   = args[1].get_shape().elements();
+        auto slab_bytes = inner * args[0].get_shape().type_size();
+        if(nindices == 0 or slab_bytes == 0)
+            return args.back();
 
-        visit_all(args.back(), args[0])([&](auto output, auto input) {
-            args[1].visit([&](auto indices) {
-                const auto* indices_ptr = indices.data();
-                auto* output_ptr        = output.data();
-                ctx.bulk_execute(nelements, 1024, [=](auto start, auto end) {
-                    for(auto i = start; i < end; i++)
+        const char* input_ptr = args[0].data();
+        char* output_ptr      = args.back().data();
+        // Give each task at least a few pages to copy
+        auto grain = std::max<std::size_t>(1, 16384 / (slab_bytes * outer));
+        args[1].visit([&](auto indices) {
+            const auto* indices_ptr = indices.data();
+            ctx.bulk_execute(nindices, grain, [=](auto start, auto end) {
+                for(auto j = start; j < end; j++)
+                {
+                    auto in_index   = static_cast<std::int64_t>(indices_ptr[j]);
+                    in_index        = (in_index < 0) ? in_index + axis_dim_size : in_index;
+                    const char* src = input_ptr + in_index * slab_bytes;
+                    char* dst       = output_ptr + j * slab_bytes;
+                    for(std::size_t o = 0; o < outer; o++)
                     {
-                        auto idx      = out_comp.multi(i);
-                        auto in_index = indices_ptr[idx[op.axis]];
-                        in_index      = (in_index < 0) ? in_index + axis_dim_size : in_index;
-                        idx[op.axis]  = in_index;
-                        output_ptr[i] = input(idx.begin(), idx.end());
+                        std::memcpy(dst, src, slab_bytes);
+                        src += axis_dim_size * slab_bytes;
+                        dst += nindices * slab_bytes;
                     }
-                });
+                }
             });
         });
 
@@ -11,13 +11,17 @@ namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 namespace cpu {
 
-struct dnnl_gemm : dnnl_extend_op<dnnl_gemm, dnnl::matmul, op::dot>
+template <class Derived, class Op, template <class, class, class> class Base = dnnl_extend_op>
+struct dnnl_gemm_op : Base<Derived, dnnl::matmul, Op>
 {
-    std::vector<int> arg_map(int) const
+    std::vector<int> arg_map(int size) const
     {
-        return {MIGRAPHX_DNNL_PREFIX(ARG_SRC),
-                MIGRAPHX_DNNL_PREFIX(ARG_WEIGHTS),
-                MIGRAPHX_DNNL_PREFIX(ARG_BIAS)};
+        std::vector<int> result = {MIGRAPHX_DNNL_PREFIX(ARG_SRC),
+                                   MIGRAPHX_DNNL_PREFIX(ARG_WEIGHTS),
+                                   MIGRAPHX_DNNL_PREFIX(ARG_BIAS)};
+        // Post op arguments are appended after the inputs of the primitive
+        result.resize(size);
+        return result;
     }
 
     void required(const check_shapes& cs) const { cs.not_broadcasted(); }
@@ -30,6 +34,14 @@ struct dnnl_gemm : dnnl_extend_op<dnnl_gemm, dnnl::matmul, op::dot>
     }
 };
 
+struct dnnl_gemm : dnnl_gemm_op<dnnl_gemm, op::dot>
+{
+};
+
+struct dnnl_quant_gemm : dnnl_gemm_op<dnnl_quant_gemm, op::quant_dot, dnnl_quant_extend_op>
+{
+};
+
 } // namespace cpu
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
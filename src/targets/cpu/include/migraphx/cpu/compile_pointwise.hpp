@@ -0,0 +1,20 @@
+#ifndef MIGRAPHX_GUARD_CPU_COMPILE_POINTWISE_HPP
+#define MIGRAPHX_GUARD_CPU_COMPILE_POINTWISE_HPP
+
+#include <migraphx/config.hpp>
+#include <migraphx/operation.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+struct module;
+
+namespace cpu {
+
+// Generates a host kernel for the pointwise module. The inputs are the shapes
+// of the module parameters x0, x1, ... followed by the output shape.
+operation compile_pointwise(const std::vector<shape>& inputs, module m);
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+#endif // MIGRAPHX_GUARD_CPU_COMPILE_POINTWISE_HPP
@@ -2,22 +2,46 @@
 #define MIGRAPHX_GUARD_RTGLIB_CONTEXT_HPP
 
 #include <migraphx/config.hpp>
+#include <migraphx/argument.hpp>
 #include <migraphx/cpu/dnnl.hpp>
 #include <migraphx/cpu/parallel.hpp>
+#include <migraphx/cpu/task_pool.hpp>
 #include <migraphx/par_for.hpp>
+#include <migraphx/env.hpp>
+#include <migraphx/value.hpp>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 namespace cpu {
 
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_CPU_INTER_OP_THREADS)
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_CPU_INTRA_OP_THREADS)
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_CPU_NUMA_NODE)
+
 struct context
 {
-    void finish() const {}
+    // Independent instructions are scheduled on inter_op streams that run
+    // concurrently, and each one can use intra_op threads. When intra_op is
+    // zero the cores are split evenly between the streams. Parallel loops run
+    // on a thread pool pinned to the NUMA node, which is shared with the rest
+    // of the process unless a thread count or node is chosen.
+    context(std::size_t inter_op  = value_of(MIGRAPHX_CPU_INTER_OP_THREADS{}, 1),
+            std::size_t intra_op  = value_of(MIGRAPHX_CPU_INTRA_OP_THREADS{}, 0),
+            std::size_t numa_node = value_of(MIGRAPHX_CPU_NUMA_NODE{}, thread_pool::any_node));
+
+    // A copy has its own streams and preallocated buffers so it can run at the
+    // same time as the original, only the thread pool is shared
+    context(const context& ctx);
+    context& operator=(const context& ctx);
+    context(context&&) = default;
+    context& operator=(context&&) = default;
+
+    void finish() const;
 
     template <class F>
     void bulk_execute(std::size_t n, std::size_t min_grain, F f)
     {
-        cpu::parallel_for(n, min_grain, f);
+        cpu::parallel_for(get_thread_pool(), n, min_grain, intra_op_threads(), f);
     }
 
     template <class F>
@@ -25,6 +49,28 @@ struct context
     {
         this->bulk_execute(n, 256, f);
     }
+
+    std::size_t nstreams() const;
+    std::size_t intra_op_threads() const;
+    std::size_t numa_node() const;
+    thread_pool& get_thread_pool() const;
+
+    void set_stream(std::size_t n);
+    void record_event(std::size_t event);
+    void wait_event(std::size_t event);
+    // Run f on the current stream once the events it waits for are recorded
+    task_ref async(std::function<void()> f);
+
+    // Preallocated buffers, like the scratch memory, are owned by the context so that separate
+    // contexts can run the same program at the same time. The buffer is allocated on first use.
+    argument get_preallocation(const std::string& id, const shape& s);
+
+    value to_value() const;
+    void from_value(const value& v);
+
+    private:
+    struct stream_state;
+    std::shared_ptr<stream_state> state;
 };
 
 } // namespace cpu
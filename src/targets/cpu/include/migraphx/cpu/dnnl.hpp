@@ -6,6 +6,7 @@
 #include <migraphx/reflect.hpp>
 #include <migraphx/register_op.hpp>
 #include <migraphx/check_shapes.hpp>
+#include <migraphx/float_equal.hpp>
 #include <unordered_map>
 #include <migraphx/errors.hpp>
 #include <migraphx/assert.hpp>
@@ -36,6 +37,10 @@ struct dnnl_context
 
 dnnl_context& get_dnnl_context();
 
+// Each thread executes primitives on its own stream so independent
+// instructions can run concurrently
+dnnl::stream& get_dnnl_stream();
+
 dnnl::memory::data_type to_dnnl_memory_data_type(shape::type_t t);
 
 dnnl::memory::format_tag to_dnnl_memory_format_tag(std::size_t n);
@@ -48,6 +53,19 @@ inline dnnl::memory::dims to_dnnl_dims(R&& r)
 
 dnnl::memory::desc to_dnnl_memory_desc(const shape& s);
 
+dnnl::memory::format_tag to_dnnl_format_tag(const std::string& name);
+
+// An empty format means the plain strided layout described by the shape
+dnnl::memory::desc to_dnnl_memory_desc(const shape& s, const std::string& format);
+
+// Shape of the buffer that holds a tensor in the given layout, blocked
+// layouts can be padded so this is only the size of the data
+shape get_buffer_shape(const shape& s, const std::string& format);
+
+// Name of the format tag that describes the layout chosen by dnnl, this is
+// empty when it matches the shape and "any" when there is no such tag
+std::string to_format_string(const dnnl::memory::desc& desc, const shape& s);
+
 dnnl::memory to_dnnl_memory(const dnnl::memory::desc& desc, const argument& a);
 
 dnnl::memory to_dnnl_memory(const argument& a);
@@ -72,12 +90,14 @@ template <class Derived, class Primitive>
 struct dnnl_op : auto_register_op<Derived>
 {
     std::vector<post_op> post_ops;
+    // Format tag for each input followed by the output
+    std::vector<std::string> formats;
     std::function<argument(context& ctx, const std::vector<argument>& args)> execute;
 
     template <class Self, class F>
     static auto reflect_base(Self& self, F f)
     {
-        return pack(f(self.post_ops, "post_ops"));
+        return pack(f(self.post_ops, "post_ops"), f(self.formats, "formats"));
     }
 
     template <class Self, class F>
@@ -182,6 +202,18 @@ struct dnnl_op : auto_register_op<Derived>
         }
     }
     shape adjust_shape(const shape& s, int) const { return base_adjust_shape(s); }
+    std::string get_format(std::size_t i) const
+    {
+        if(formats.empty())
+            return {};
+        return formats.at(i);
+    }
+    std::string get_output_format() const
+    {
+        if(formats.empty())
+            return {};
+        return formats.back();
+    }
     std::vector<int> create_arg_map(std::size_t input_size) const
     {
         const auto& self     = static_cast<const Derived&>(*this);
@@ -200,13 +232,13 @@ struct dnnl_op : auto_register_op<Derived>
     {
         const auto& self = static_cast<const Derived&>(*this);
         std::unordered_map<int, dnnl::memory::desc> result;
-        result[MIGRAPHX_DNNL_PREFIX(ARG_DST)] =
-            to_dnnl_memory_desc(self.adjust_shape(output_shape, inputs.size()));
+        result[MIGRAPHX_DNNL_PREFIX(ARG_DST)] = to_dnnl_memory_desc(
+            self.adjust_shape(output_shape, inputs.size()), get_output_format());
         auto m = create_arg_map(inputs.size());
         assert(m.size() >= inputs.size());
         for(int i = 0; i < inputs.size(); i++)
         {
-            result[m[i]] = to_dnnl_memory_desc(self.adjust_shape(inputs[i], i));
+            result[m[i]] = to_dnnl_memory_desc(self.adjust_shape(inputs[i], i), get_format(i));
         }
         return result;
     }
@@ -216,14 +248,10 @@ struct dnnl_op : auto_register_op<Derived>
         dnnl::primitive_attr result;
         dnnl::post_ops po;
         for_each_post_op([&](auto&& op, auto arg) {
-            if(contains(op.algo, "binary_add"))
-            {
-                auto desc = m.at(arg);
-                if(desc == m.at(MIGRAPHX_DNNL_PREFIX(ARG_DST)))
-                    po.append_sum(1.0f);
-                else
-                    po.append_binary(to_dnnl_algo(op.algo), m.at(arg));
-            }
+            // The sum post op accumulates into the destination, so the
+            // destination buffer must already hold the other operand
+            if(op.algo == "sum")
+                po.append_sum(1.0f);
             else if(contains(op.algo, "binary"))
             {
                 po.append_binary(to_dnnl_algo(op.algo), m.at(arg));
@@ -242,13 +270,16 @@ struct dnnl_op : auto_register_op<Derived>
     {
         return typename Primitive::primitive_desc(desc, attr, get_dnnl_context().engine);
     }
-    Primitive get_primitive(const std::unordered_map<int, dnnl::memory::desc>& m) const
+    auto make_primitive_desc(const std::unordered_map<int, dnnl::memory::desc>& m) const
     {
         const auto& self = static_cast<const Derived&>(*this);
         auto desc        = self.get_desc(m);
-        auto attr        = MIGRAPHX_ASSERT_NO_THROW(this->get_primitive_attr(m));
-        auto pd          = self.get_primitive_desc(desc, attr);
-        return Primitive(pd);
+        auto attr        = MIGRAPHX_ASSERT_NO_THROW(self.get_primitive_attr(m));
+        return self.get_primitive_desc(desc, attr);
+    }
+    Primitive get_primitive(const std::unordered_map<int, dnnl::memory::desc>& m) const
+    {
+        return Primitive(make_primitive_desc(m));
     }
     argument compute(context& ctx, const shape&, const std::vector<argument>& args) const
     {
@@ -263,10 +294,26 @@ struct dnnl_op : auto_register_op<Derived>
     {
         // Compensate for allocation
         inputs.pop_back();
-        auto md        = to_memory_desc(output_shape, inputs);
-        auto prim      = get_primitive(md);
-        auto impl_name = impl(prim);
-        return {{"impl", impl_name}};
+        const auto& self = static_cast<const Derived&>(*this);
+        auto md          = to_memory_desc(output_shape, inputs);
+        auto pd          = make_primitive_desc(md);
+        auto impl_name   = impl(Primitive(pd));
+        value result     = {{"impl", impl_name}};
+        if(formats.empty())
+            return result;
+        // Report the layouts picked by dnnl for the formats left as any
+        auto arg_lookup = create_arg_map(inputs.size());
+        std::vector<std::string> resolved;
+        for(int i = 0; i < inputs.size(); i++)
+        {
+            auto desc = pd.query_md(dnnl::query::exec_arg_md, arg_lookup[i]);
+            resolved.push_back(to_format_string(desc, self.adjust_shape(inputs[i], i)));
+        }
+        auto desc = pd.query_md(dnnl::query::exec_arg_md, MIGRAPHX_DNNL_PREFIX(ARG_DST));
+        resolved.push_back(
+            to_format_string(desc, self.adjust_shape(output_shape, inputs.size())));
+        result["formats"] = resolved;
+        return result;
     }
 
     void finalize(context&, const shape& output_shape, std::vector<shape> inputs)
@@ -278,15 +325,21 @@ struct dnnl_op : auto_register_op<Derived>
         auto md          = to_memory_desc(output_shape, inputs);
         auto prim        = get_primitive(md);
         auto arg_lookup  = create_arg_map(inputs.size());
+        // Copies of this op keep the lambda, so it must not read from this
+        bool blocked = not get_output_format().empty();
 #ifndef NDEBUG
-        auto prim_attr = get_primitive_attr(md);
+        auto prim_attr       = self.get_primitive_attr(md);
+        auto prim_input_size = inputs.size() - this->get_extra_post_op_args();
+        // A copy of the op to recompute the descriptors from
+        Derived debug_self = self;
+        debug_self.execute = nullptr;
 #endif
         execute = [=](context&, const std::vector<argument>& args) {
 #ifndef NDEBUG
             // Check that the memory descriptors have not changed
             auto debug_args = args;
             debug_args.pop_back();
-            auto debug_md = to_memory_desc(output_shape, to_shapes(debug_args));
+            auto debug_md = debug_self.to_memory_desc(output_shape, to_shapes(debug_args));
             for(auto&& p : debug_md)
             {
                 if(md.count(p.first) == 0)
@@ -298,9 +351,8 @@ struct dnnl_op : auto_register_op<Derived>
                                ": Memory descriptor has changed for: " + std::to_string(p.first));
             }
             // Check post_ops args are correct
-            auto pos             = prim_attr.get_post_ops();
-            auto prim_input_size = inputs.size() - this->get_extra_post_op_args();
-            int j                = 0;
+            auto pos = prim_attr.get_post_ops();
+            int j    = 0;
             for(int i = 0; i < pos.len(); i++)
             {
                 auto arg  = j + prim_input_size;
@@ -329,15 +381,18 @@ struct dnnl_op : auto_register_op<Derived>
                     else if(kind == dnnl::primitive::kind::sum)
                     {
                         pos.get_params_sum(i, scale);
-                        algo = dnnl::algorithm::binary_add;
+                        if(debug_self.post_ops[i].algo != "sum")
+                            MIGRAPHX_THROW(mesg + "Expected sum for post op " +
+                                           debug_self.post_ops[i].algo);
+                        continue;
                     }
                     else
                     {
                         MIGRAPHX_THROW("Unknown kind");
                     }
-                    if(to_dnnl_algo(post_ops[i].algo) != algo)
+                    if(to_dnnl_algo(debug_self.post_ops[i].algo) != algo)
                         MIGRAPHX_THROW(mesg + "Algorithm doesn't match for post op " +
-                                       post_ops[i].algo + " != " + to_string(algo));
+                                       debug_self.post_ops[i].algo + " != " + to_string(algo));
                 }
                 catch(const dnnl::error& e)
                 {
@@ -350,7 +405,11 @@ struct dnnl_op : auto_register_op<Derived>
                 to_dnnl_memory(md.at(MIGRAPHX_DNNL_PREFIX(ARG_DST)), args.back());
             for(int i = 0; i < args.size() - 1; i++)
                 m[arg_lookup[i]] = to_dnnl_memory(md.at(arg_lookup[i]), args[i]);
-            prim.execute(get_dnnl_context().stream, m);
+            prim.execute(get_dnnl_stream(), m);
+            // The buffer for a blocked output is sized by dnnl, so it is
+            // returned with the logical shape
+            if(blocked)
+                return args.back().reshape(output_shape);
             return args.back();
         };
     }
@@ -389,6 +448,48 @@ struct dnnl_extend_op : dnnl_op<Derived, Primitive>
     }
 };
 
+template <class Derived, class Primitive, class Op>
+struct dnnl_quant_extend_op : dnnl_extend_op<Derived, Primitive, Op>
+{
+    // Dequantization scale applied to the int32 accumulator
+    float scale = 1.0f;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack_join(self.reflect_base(self, f),
+                         migraphx::reflect(self.op, f),
+                         pack(f(self.scale, "scale")));
+    }
+
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        const auto& self = static_cast<const Derived&>(*this);
+        // The output type is taken from the allocation, so the accumulator
+        // can be dequantized to float by the primitive itself
+        auto t = inputs.back().type();
+        if(not contains({shape::int32_type, shape::float_type}, t))
+            MIGRAPHX_THROW(self.name() + ": Only int32 or float outputs are supported");
+        // Compensate for allocation
+        inputs.pop_back();
+        self.required(check_shapes(inputs, self));
+        auto r = migraphx::compute_shape(this->op, this->trim_post_op_inputs(inputs));
+        r      = r.with_lens(t, r.lens());
+        // Call to get_primitive to make sure an algo is available
+        this->get_primitive(this->to_memory_desc(r, inputs));
+        return r;
+    }
+
+    dnnl::primitive_attr
+    get_primitive_attr(const std::unordered_map<int, dnnl::memory::desc>& m) const
+    {
+        auto result = dnnl_op<Derived, Primitive>::get_primitive_attr(m);
+        if(not float_equal(scale, 1.0f))
+            result.set_output_scales(0, {scale});
+        return result;
+    }
+};
+
 } // namespace cpu
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
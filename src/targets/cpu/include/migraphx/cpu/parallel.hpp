@@ -4,9 +4,8 @@
 // #define MIGRAPHX_DISABLE_OMP
 
 #include <migraphx/config.hpp>
-#ifdef MIGRAPHX_DISABLE_OMP
-#include <migraphx/par_for.hpp>
-#else
+#include <migraphx/thread_pool.hpp>
+#ifndef MIGRAPHX_DISABLE_OMP
 #include <omp.h>
 #endif
 
@@ -16,10 +15,23 @@ namespace cpu {
 
 #ifdef MIGRAPHX_DISABLE_OMP
 
-inline std::size_t max_threads() { return std::thread::hardware_concurrency(); }
+inline std::size_t max_threads() { return default_thread_pool().size(); }
+
+// Loops run on the context's thread pool, which is limited separately
+inline void set_max_threads(std::size_t) {}
+
+#else
+
+inline std::size_t max_threads() { return omp_get_max_threads(); }
+
+// Limit the threads used by parallel regions started from this thread
+inline void set_max_threads(std::size_t n) { omp_set_num_threads(n); }
+
+#endif
 
 template <class F>
-void parallel_for_impl(std::size_t n, std::size_t threadsize, F f)
+void parallel_for_impl(
+    thread_pool& pool, std::size_t n, std::size_t threadsize, std::size_t min_grain, F f)
 {
     if(threadsize <= 1)
     {
@@ -27,52 +39,26 @@ void parallel_for_impl(std::size_t n, std::size_t threadsize, F f)
     }
     else
     {
-        std::vector<joinable_thread> threads(threadsize);
-// Using const here causes gcc 5 to ICE
-#if(!defined(__GNUC__) || __GNUC__ != 5)
-        const
-#endif
-            std::size_t grainsize = std::ceil(static_cast<double>(n) / threads.size());
-
-        std::size_t work = 0;
-        std::generate(threads.begin(), threads.end(), [=, &work] {
-            auto result =
-                joinable_thread([=]() mutable { f(work, std::min(n, work + grainsize)); });
-            work += grainsize;
-            return result;
+        // Chunks are handed out as threads become free so uneven work is
+        // balanced between the threads
+        pool.run(n, min_grain, threadsize, [&](std::size_t start, std::size_t end, std::size_t) {
+            f(start, end);
         });
-        // cppcheck-suppress unsignedLessThanZero
-        assert(work >= n);
     }
 }
-#else
-
-inline std::size_t max_threads() { return omp_get_max_threads(); }
 
 template <class F>
-void parallel_for_impl(std::size_t n, std::size_t threadsize, F f)
+void parallel_for(
+    thread_pool& pool, std::size_t n, std::size_t min_grain, std::size_t max_threads, F f)
 {
-    if(threadsize <= 1)
-    {
-        f(std::size_t{0}, n);
-    }
-    else
-    {
-        std::size_t grainsize = std::ceil(static_cast<double>(n) / threadsize);
-#pragma omp parallel for num_threads(threadsize) schedule(static, 1) private(grainsize, n)
-        for(std::size_t tid = 0; tid < threadsize; tid++)
-        {
-            std::size_t work = tid * grainsize;
-            f(work, std::min(n, work + grainsize));
-        }
-    }
+    const auto threadsize = std::min<std::size_t>(max_threads, n / min_grain);
+    parallel_for_impl(pool, n, threadsize, min_grain, f);
 }
-#endif
+
 template <class F>
 void parallel_for(std::size_t n, std::size_t min_grain, F f)
 {
-    const auto threadsize = std::min<std::size_t>(max_threads(), n / min_grain);
-    parallel_for_impl(n, threadsize, f);
+    parallel_for(current_thread_pool(), n, min_grain, current_thread_limit(), f);
 }
 
 template <class F>
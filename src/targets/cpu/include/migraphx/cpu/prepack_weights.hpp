@@ -0,0 +1,27 @@
+#ifndef MIGRAPHX_GUARD_CPU_PREPACK_WEIGHTS_HPP
+#define MIGRAPHX_GUARD_CPU_PREPACK_WEIGHTS_HPP
+
+#include <migraphx/config.hpp>
+#include <string>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct module;
+
+namespace cpu {
+
+struct context;
+
+// Reorder constant weights into the layout preferred by dnnl at compile time
+struct prepack_weights
+{
+    context* ctx = nullptr;
+    std::string name() const { return "cpu::prepack_weights"; }
+    void apply(module& m) const;
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+#endif // MIGRAPHX_GUARD_CPU_PREPACK_WEIGHTS_HPP
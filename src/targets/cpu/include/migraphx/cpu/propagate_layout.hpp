@@ -0,0 +1,28 @@
+#ifndef MIGRAPHX_GUARD_CPU_PROPAGATE_LAYOUT_HPP
+#define MIGRAPHX_GUARD_CPU_PROPAGATE_LAYOUT_HPP
+
+#include <migraphx/config.hpp>
+#include <string>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct module;
+
+namespace cpu {
+
+struct context;
+
+// Let chains of dnnl ops agree on the blocked layouts dnnl prefers, with
+// reorders only at the boundaries to the rest of the graph
+struct propagate_layout
+{
+    context* ctx = nullptr;
+    std::string name() const { return "cpu::propagate_layout"; }
+    void apply(module& m) const;
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+#endif // MIGRAPHX_GUARD_CPU_PROPAGATE_LAYOUT_HPP
@@ -0,0 +1,81 @@
+#ifndef MIGRAPHX_GUARD_CPU_TASK_POOL_HPP
+#define MIGRAPHX_GUARD_CPU_TASK_POOL_HPP
+
+#include <migraphx/config.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+struct task
+{
+    std::function<void()> f;
+    // Number of tasks that must finish before this one can run
+    std::atomic<std::size_t> pending{1};
+    std::mutex m;
+    std::condition_variable cv;
+    bool done = false;
+    std::exception_ptr error;
+    std::vector<std::shared_ptr<task>> successors;
+
+    // Fail the task with the error of a dependency, keeping the first error
+    void fail(const std::exception_ptr& e);
+    // Wait for the task to finish and rethrow any exception it threw, or the
+    // exception of a dependency
+    void wait();
+};
+
+using task_ref = std::shared_ptr<task>;
+
+// Each worker owns a queue of ready tasks and steals from the other queues
+// when its own queue is empty
+struct task_pool
+{
+    explicit task_pool(std::size_t n, const std::function<void()>& init = nullptr);
+    task_pool(const task_pool&) = delete;
+    task_pool& operator=(const task_pool&) = delete;
+    ~task_pool();
+
+    std::size_t size() const;
+    // Run f once all of the tasks in deps have finished. If any of them
+    // failed, f is not run and the task fails with the same error.
+    task_ref add(std::function<void()> f, const std::vector<task_ref>& deps = {});
+    // Wait for every task added to the pool to finish
+    void wait_all();
+
+    private:
+    struct queue
+    {
+        std::mutex m;
+        std::deque<task_ref> tasks;
+    };
+    void push(task_ref t);
+    task_ref pop(std::size_t i);
+    void run(const task_ref& t);
+    void work(std::size_t i);
+
+    std::vector<std::unique_ptr<queue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex m;
+    std::condition_variable ready_cv;
+    std::condition_variable finished_cv;
+    std::size_t ready       = 0;
+    std::size_t outstanding = 0;
+    std::atomic<std::size_t> next{0};
+    bool stop = false;
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
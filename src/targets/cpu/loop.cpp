@@ -0,0 +1,82 @@
+#include <migraphx/config.hpp>
+#include <migraphx/context.hpp>
+#include <migraphx/op/loop.hpp>
+#include <migraphx/register_op.hpp>
+#include <migraphx/run_loop.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+struct cpu_loop_model : op::loop::ref_loop
+{
+    explicit cpu_loop_model(int64_t n) { max_iterations = n; }
+
+    // The outputs of the body are written directly into the buffers bound to these parameters
+    std::unordered_map<std::string, int> get_output_params(const module& m) const
+    {
+        const std::string prefix = "#output_";
+        std::unordered_map<std::string, int> result;
+        for(const auto& name : m.get_parameter_names())
+        {
+            auto loc = name.find(prefix);
+            if(loc == std::string::npos)
+                continue;
+            result[name] = std::stoi(name.substr(loc + prefix.size()));
+        }
+        return result;
+    }
+};
+
+struct cpu_loop : auto_register_op<cpu_loop>
+{
+    op::loop op;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return migraphx::reflect(self.op, f);
+    }
+
+    std::string name() const { return "cpu::loop"; }
+
+    shape compute_shape(std::vector<shape> inputs, std::vector<module_ref> mods) const
+    {
+        auto input_num = (inputs.size() - 2) / 2;
+        inputs.erase(inputs.begin() + input_num, inputs.end());
+        return op.compute_shape(inputs, std::move(mods));
+    }
+
+    argument compute(migraphx::context& ctx,
+                     const shape&,
+                     const std::vector<argument>& args,
+                     const std::vector<module_ref>& mods,
+                     const std::function<std::vector<argument>(
+                         module_ref&, const std::unordered_map<std::string, argument>&)>& run) const
+    {
+        auto results =
+            run_loop(cpu_loop_model{op.max_iterations}, ctx, args, mods, run).get_sub_objects();
+        // The loop carried outputs alternate with the buffers passed in for them between
+        // iterations, so they are only copied when the last iteration didn't write to the output
+        auto output  = args.back();
+        auto outputs = output.get_sub_objects();
+        for(std::size_t i = 0; i < results.size(); i++)
+        {
+            if(results[i].data() == outputs[i].data())
+                continue;
+            visit_all(outputs[i], results[i])([&](auto y, auto x) {
+                std::copy(x.begin(), x.end(), y.begin());
+            });
+        }
+        return output;
+    }
+
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -20,11 +20,13 @@
 #include <migraphx/op/argmax.hpp>
 #include <migraphx/op/argmin.hpp>
 #include <migraphx/op/rnn_var_sl_last_output.hpp>
+#include <migraphx/rewrite_rnn.hpp>
 #include <migraphx/shape_for_each.hpp>
 #include <migraphx/iterator_for.hpp>
 #include <migraphx/par_dfor.hpp>
 #include <migraphx/clamp.hpp>
 #include <migraphx/cpu/context.hpp>
+#include <migraphx/cpu/compile_pointwise.hpp>
 #include <migraphx/register_op.hpp>
 #include <migraphx/make_op.hpp>
 #include <migraphx/program.hpp>
@@ -33,6 +35,8 @@
 #include <migraphx/match/gelu_erf.hpp>
 #include <migraphx/match/gelu_tanh.hpp>
 #include <migraphx/matcher.hpp>
+#include <functional>
+#include <numeric>
 #include <unordered_map>
 #include <utility>
 #include <iostream>
@@ -131,8 +135,11 @@ struct cpu_op
     }
     std::string name() const { return "cpu::op"; }
     shape compute_shape(const std::vector<shape>& inputs) const { return op.compute_shape(inputs); }
-    argument compute(context&, const shape& output_shape, const std::vector<argument>& args) const
+    argument
+    compute(context& ctx, const shape& output_shape, const std::vector<argument>& args) const
     {
+        // Run the reference op's parallel loops on the context's threads
+        thread_pool_scope scope{ctx.get_thread_pool(), ctx.intra_op_threads()};
         return op.compute(output_shape, args);
     }
     value to_value() const
@@ -325,6 +332,70 @@ struct cpu_apply
         });
     }
 
+    // Not every cpu has an int8 implementation of the quantized primitives, those are computed
+    // by the float primitive instead. The int32 result is only exact while every partial sum fits
+    // in the float mantissa, so longer reductions are split into chunks that are each computed in
+    // float and then added together as int32.
+    void extend_quant_op(const std::string& op_name, const std::string& float_name)
+    {
+        apply_map.emplace(op_name, [=](instruction_ref ins) {
+            auto v  = ins->get_operator().to_value();
+            auto op = make_op("dnnl::" + op_name, v);
+            if(is_supported(ins, op, ins->inputs()))
+                return replace(ins, op);
+            auto a    = ins->inputs().at(0);
+            auto b    = ins->inputs().at(1);
+            auto lens = b->get_shape().lens();
+            // The reduced axis of each input, and the number of products per index of that axis
+            std::size_t axis_a = 1;
+            std::size_t axis_b = 1;
+            std::size_t n      = 1;
+            if(op_name == "quant_dot")
+            {
+                axis_a = lens.size() - 1;
+                axis_b = lens.size() - 2;
+            }
+            else
+            {
+                n = std::accumulate(
+                    lens.begin() + 2, lens.end(), std::size_t{1}, std::multiplies<>{});
+            }
+            // The products of two int8 values are at most 128 * 128
+            std::size_t chunk = (std::size_t{1} << 24) / (128 * 128 * n);
+            std::size_t k     = lens[axis_b];
+            bool grouped      = v.contains("group") and v.at("group").to<int>() != 1;
+            if(k > chunk and (chunk == 0 or grouped))
+                MIGRAPHX_THROW("CPU: " + op_name + " can not be computed exactly in float");
+            auto s      = ins->get_shape();
+            auto result = modl->end();
+            for(std::size_t start = 0; start < k; start += chunk)
+            {
+                auto end   = std::min(k, start + chunk);
+                auto slice = [&](instruction_ref x, std::size_t axis) {
+                    if(start == 0 and end == k)
+                        return x;
+                    return modl->insert_instruction(
+                        ins,
+                        make_op("slice", {{"axes", {axis}}, {"starts", {start}}, {"ends", {end}}}),
+                        x);
+                };
+                auto fa = insert_convert(ins, slice(a, axis_a), shape::type_t::float_type);
+                auto fb = insert_convert(ins, slice(b, axis_b), shape::type_t::float_type);
+                auto output =
+                    insert_allocation(ins, s.with_lens(shape::type_t::float_type, s.lens()));
+                auto partial =
+                    modl->insert_instruction(ins, make_op(float_name, v), fa, fb, output);
+                partial = modl->insert_instruction(
+                    ins, make_op("convert", {{"target_type", s.type()}}), partial);
+                if(result == modl->end())
+                    result = partial;
+                else
+                    result = modl->insert_instruction(ins, make_op("add"), result, partial);
+            }
+            return modl->replace_instruction(ins, result);
+        });
+    }
+
     void extend_dnnl_algos(const std::string& dnnl_name,
                            const std::vector<std::pair<std::string, std::string>>& algos)
     {
@@ -353,11 +424,40 @@ struct cpu_apply
                            bind_inputs.end(),
                            std::back_inserter(inputs),
                            [&](const auto& s) { return r.instructions.at(s); });
-            inputs.push_back(this->insert_allocation(ins, ins->get_shape()));
-            modl->replace_instruction(ins, op, inputs);
+            this->replace(ins, op, inputs);
         });
     }
 
+    // Fold the scale of the dequantizelinear following a quantized operator
+    // into the dnnl primitive, so it directly outputs float
+    auto fuse_dequantize()
+    {
+        auto quant_op = match::name("quant_convolution", "quant_dot")(match::used_once());
+        auto dequantize =
+            match::name("convert")(match::used_once(), match::arg(0)(quant_op.bind("q")));
+        auto scale = match::skip_broadcasts(match::is_constant().bind("scale"));
+        return match::make_match_finder(
+            match::name("mul")(match::either_arg(0, 1)(dequantize, scale)),
+            [=](auto&, const auto& r) {
+                auto ins = r.result;
+                auto q   = r.instructions.at("q");
+                if(ins->get_shape().type() != shape::type_t::float_type)
+                    return;
+                if(not has_op("dnnl::" + q->name()))
+                    return;
+                auto scale = read_scalar<float>(r.instructions.at("scale"));
+                if(scale.empty())
+                    return;
+                auto v     = q->get_operator().to_value();
+                v["scale"] = scale.front();
+                auto op    = make_op("dnnl::" + q->name(), v);
+                // Leave it to the float fallback of the quantized operator
+                if(not is_supported(ins, op, q->inputs()))
+                    return;
+                this->replace(ins, op, q->inputs());
+            });
+    }
+
     void init()
     {
         create_output_names();
@@ -389,17 +489,24 @@ struct cpu_apply
                               {"reduce_sum", "reduction_sum"},
                           });
 
+        apply_map.emplace("pointwise", [=](instruction_ref ins) { return apply_pointwise(ins); });
+        apply_map.emplace("loop", [=](instruction_ref ins) { return apply_loop(ins); });
+        for(const std::string& name : {"rnn", "gru", "lstm"})
+            apply_map.emplace(name, [=](instruction_ref ins) { return apply_rnn(ins); });
         extend_op("concat", "dnnl::concat");
         extend_op("contiguous", "dnnl::reorder");
         extend_op("convolution", "dnnl::convolution");
 #ifndef MIGRAPHX_ENABLE_ZENDNN
         extend_op("deconvolution", "dnnl::deconvolution");
         extend_op("dot", "dnnl::dot");
+        extend_quant_op("quant_dot", "dnnl::dot");
 #endif
         extend_op("erf", "cpu::erf");
         extend_op("gather", "cpu::gather");
         extend_op("logsoftmax", "dnnl::logsoftmax");
         extend_op("lrn", "dnnl::lrn");
+        extend_quant_op("quant_convolution", "dnnl::convolution");
+        extend_op("resize", "cpu::resize");
         extend_op("softmax", "dnnl::softmax");
         extend_op("sub", "cpu::sub");
 
@@ -420,7 +527,8 @@ struct cpu_apply
                             fuse_match(match::gelu_tanh(),
                                        make_op("dnnl::eltwise", {{"algo", "eltwise_gelu_tanh"}}),
                                        {"x"}),
-                            fuse_match(match::layernorm(), make_op("dnnl::layernorm"), {"x"}));
+                            fuse_match(match::layernorm(), make_op("dnnl::layernorm"), {"x"}),
+                            fuse_dequantize());
         // Apply these operators first so the inputs can be const folded
         for(auto it : iterator_for(*modl))
         {
@@ -453,13 +561,317 @@ struct cpu_apply
                        {ins->inputs().front()});
     }
 
+    instruction_ref apply_pointwise(instruction_ref ins) const
+    {
+        auto inputs = ins->inputs();
+        inputs.push_back(insert_allocation(ins, ins->get_shape()));
+        auto op = compile_pointwise(to_shapes(inputs), *ins->module_inputs().front());
+        return modl->replace_instruction(ins, op, inputs, {});
+    }
+
+    // The outputs of the body are written to the buffers passed in by the loop, which alternate
+    // between iterations for the loop carried outputs so the body doesn't overwrite its own
+    // inputs, and are slices of the output for the scan outputs
+    instruction_ref apply_loop(instruction_ref ins) const
+    {
+        auto* body = ins->module_inputs().front();
+        auto ret   = std::prev(body->end());
+        if(ret->name() == "@return")
+        {
+            auto outputs = ret->inputs();
+            for(std::size_t i = 0; i < outputs.size(); i++)
+            {
+                auto alias = instruction::get_output_alias(outputs[i]);
+                if(alias->name() != "cpu::allocate" or alias->get_shape() != outputs[i]->get_shape())
+                    continue;
+                auto param = body->add_parameter(body->name() + ":#output_" + std::to_string(i),
+                                                 alias->get_shape());
+                body->replace_instruction(alias, param);
+            }
+        }
+
+        auto inputs = ins->inputs();
+        std::transform(ins->inputs().begin(),
+                       ins->inputs().end(),
+                       std::back_inserter(inputs),
+                       [&](auto input) { return insert_allocation(ins, input->get_shape()); });
+        inputs.push_back(insert_allocation(ins, body->get_output_shapes().front()));
+        inputs.push_back(insert_allocation(ins, ins->get_shape()));
+        return modl->replace_instruction(
+            ins, make_op("cpu::loop", ins->get_operator().to_value()), inputs, ins->module_inputs());
+    }
+
+    // The rnn operators are computed whole instead of being unrolled into every timestep. They
+    // compute a tuple of the hidden states and the last states, which are used for the
+    // rnn_last_hs_output and rnn_last_cell_output instructions.
+    instruction_ref apply_rnn(instruction_ref ins) const
+    {
+        auto cell   = ins->name();
+        auto v      = ins->get_operator().to_value();
+        value attrs = {{"cell", cell},
+                       {"direction", v.at("direction")},
+                       {"linear_before_reset", v.get("linear_before_reset", 0)}};
+        auto result = insert_dnnl_rnn(ins, attrs);
+        if(result == ins)
+            result = insert_cpu_rnn(ins, attrs);
+
+        auto outputs = ins->outputs();
+        for(auto output : outputs)
+        {
+            if(output->name() == "rnn_last_hs_output")
+                modl->replace_instruction(
+                    output, make_op("get_tuple_elem", {{"index", 1}}), result);
+            else if(output->name() == "rnn_last_cell_output")
+                modl->replace_instruction(
+                    output, make_op("get_tuple_elem", {{"index", 2}}), result);
+        }
+        if(result->name() == "cpu::rnn")
+            return modl->replace_instruction(
+                ins, make_op("get_tuple_elem", {{"index", 0}}), result);
+        // The hidden states of dnnl are [T, N, D, C]
+        auto hs = modl->insert_instruction(ins, make_op("get_tuple_elem", {{"index", 0}}), result);
+        auto ths = modl->insert_instruction(
+            ins, make_op("transpose", {{"permutation", {0, 2, 1, 3}}}), hs);
+        return replace(ins, make_op("dnnl::reorder"), {ths});
+    }
+
+    static bool has_rnn_input(instruction_ref ins, std::size_t i)
+    {
+        return i < ins->inputs().size() and ins->inputs()[i]->name() != "undefined";
+    }
+
+    static std::vector<shape> get_rnn_output_shapes(const std::string& cell, const shape& hs)
+    {
+        auto lens = hs.lens();
+        shape last{hs.type(), {lens[1], lens[2], lens[3]}};
+        if(cell == "lstm")
+            return {hs, last, last};
+        return {hs, last};
+    }
+
+    // dnnl supports the default activations without peepholes, when every sequence has the full
+    // length. Returns ins when it can't be used.
+    instruction_ref insert_dnnl_rnn(instruction_ref ins, value attrs) const
+    {
+        auto args  = ins->inputs();
+        auto s     = ins->get_shape();
+        auto lens  = s.lens();
+        auto cell  = attrs.at("cell").to<std::string>();
+        auto algo  = get_dnnl_rnn_algo(cell, rewrite_rnn{}.get_actv_funcs(ins));
+        bool lbr   = cell == "gru" and attrs.at("linear_before_reset").to<int>() != 0;
+        auto gates = args[2]->get_shape().lens()[1] / lens[3];
+        if(not has_op("dnnl::rnn") or s.type() != shape::float_type or algo.empty() or
+           has_rnn_input(ins, 7))
+            return ins;
+        if(has_rnn_input(ins, 4) and not is_full_seq_lens(args[4], lens[0]))
+            return ins;
+        attrs["algo"] = algo;
+        auto op       = make_op("dnnl::rnn", attrs);
+
+        // dnnl orders the gates of an lstm as input, forget, cell and output
+        std::vector<int64_t> order(gates);
+        std::iota(order.begin(), order.end(), 0);
+        if(cell == "lstm")
+            order = {0, 2, 3, 1};
+        std::vector<instruction_ref> inputs = {args[0],
+                                               insert_rnn_weights(ins, args[1], order),
+                                               insert_rnn_weights(ins, args[2], order)};
+        if(has_rnn_input(ins, 3))
+            inputs.push_back(insert_rnn_bias(ins, args[3], order, lbr));
+        else
+            inputs.push_back(
+                insert_zeros({s.type(), {1, lens[1], lbr ? gates + 1 : gates, lens[3]}}));
+        std::size_t nstates = cell == "lstm" ? 2 : 1;
+        for(std::size_t i = 5; i < 5 + nstates; i++)
+        {
+            if(has_rnn_input(ins, i))
+                inputs.push_back(modl->insert_instruction(
+                    ins, make_op("unsqueeze", {{"axes", {0}}}), args[i]));
+            else
+                inputs.push_back(insert_zeros({s.type(), {1, lens[1], lens[2], lens[3]}}));
+        }
+
+        // The allocation is not checked, so size it from the shape the op computes
+        auto shapes = to_shapes(inputs);
+        shapes.push_back(s);
+        auto output_shapes = try_compute_shape(op, shapes);
+        if(output_shapes.empty())
+            return ins;
+        inputs.push_back(insert_allocation(ins, output_shapes.front()));
+        return modl->insert_instruction(ins, op, inputs);
+    }
+
+    // The missing inputs are filled in, so the sequence lengths default to the full length and
+    // the states and biases to zero
+    instruction_ref insert_cpu_rnn(instruction_ref ins, value attrs) const
+    {
+        auto args  = ins->inputs();
+        auto s     = ins->get_shape();
+        auto lens  = s.lens();
+        auto cell  = attrs.at("cell").to<std::string>();
+        auto gates = args[2]->get_shape().lens()[1] / lens[3];
+        shape state_shape{s.type(), {lens[1], lens[2], lens[3]}};
+        attrs["actv_func"] = to_value(rewrite_rnn{}.get_actv_funcs(ins));
+
+        std::vector<instruction_ref> inputs = {args[0], args[1], args[2]};
+        if(has_rnn_input(ins, 3))
+            inputs.push_back(args[3]);
+        else
+            inputs.push_back(insert_zeros({s.type(), {lens[1], 2 * gates * lens[3]}}));
+        if(has_rnn_input(ins, 4))
+        {
+            inputs.push_back(args[4]);
+        }
+        else
+        {
+            std::vector<int32_t> seq_lens(lens[2], lens[0]);
+            inputs.push_back(modl->add_literal(literal{{shape::int32_type, {lens[2]}}, seq_lens}));
+        }
+        std::size_t nstates = cell == "lstm" ? 2 : 1;
+        for(std::size_t i = 5; i < 5 + nstates; i++)
+            inputs.push_back(has_rnn_input(ins, i) ? args[i] : insert_zeros(state_shape));
+        if(cell == "lstm")
+        {
+            if(has_rnn_input(ins, 7))
+                inputs.push_back(args[7]);
+            else
+                inputs.push_back(insert_zeros({s.type(), {lens[1], 3 * lens[3]}}));
+        }
+        inputs.push_back(insert_allocation(ins, shape{get_rnn_output_shapes(cell, s)}));
+        return modl->insert_instruction(ins, make_op("cpu::rnn", attrs), inputs);
+    }
+
+    // Only the vanilla rnn can choose its activation in dnnl, the gru and lstm use the defaults
+    static std::string get_dnnl_rnn_algo(const std::string& cell,
+                                         const std::vector<operation>& actv_funcs)
+    {
+        std::vector<std::string> names;
+        std::transform(actv_funcs.begin(),
+                       actv_funcs.end(),
+                       std::back_inserter(names),
+                       [](const auto& op) { return op.name(); });
+        std::vector<std::string> defaults = {"sigmoid", "tanh"};
+        if(cell == "lstm")
+            defaults.push_back("tanh");
+        if(cell == "rnn")
+        {
+            const std::unordered_map<std::string, std::string> algos = {
+                {"relu", "eltwise_relu"},
+                {"sigmoid", "eltwise_logistic"},
+                {"tanh", "eltwise_tanh"}};
+            if(names.empty() or not contains(algos, names.front()) or
+               not std::all_of(names.begin(), names.end(), [&](const auto& name) {
+                   return name == names.front();
+               }))
+                return {};
+            return algos.at(names.front());
+        }
+        for(std::size_t i = 0; i < names.size(); i++)
+        {
+            if(names[i] != defaults[i % defaults.size()])
+                return {};
+        }
+        return cell == "gru" ? "vanilla_gru" : "vanilla_lstm";
+    }
+
+    // dnnl computes every timestep for the whole batch
+    static bool is_full_seq_lens(instruction_ref seq_lens, std::size_t seq_len)
+    {
+        if(not seq_lens->can_eval())
+            return false;
+        bool result = false;
+        seq_lens->eval().visit([&](auto sl) {
+            result = std::all_of(sl.begin(), sl.end(), [&](auto l) {
+                return static_cast<std::size_t>(l) == seq_len;
+            });
+        });
+        return result;
+    }
+
+    // Rearrange the weights [D, G*C, I] to the ldigo layout [1, D, I, G, C] of dnnl
+    instruction_ref insert_rnn_weights(instruction_ref ins,
+                                       instruction_ref w,
+                                       const std::vector<int64_t>& order) const
+    {
+        auto lens  = w->get_shape().lens();
+        auto gates = order.size();
+        auto x     = modl->insert_instruction(
+            ins,
+            make_op("reshape", {{"dims", {lens[0], gates, lens[1] / gates, lens[2]}}}),
+            w);
+        x = insert_gate_order(ins, x, order, 1);
+        x = modl->insert_instruction(ins, make_op("transpose", {{"permutation", {0, 3, 1, 2}}}), x);
+        x = modl->insert_instruction(ins, make_op("unsqueeze", {{"axes", {0}}}), x);
+        return insert_folded(modl->insert_instruction(ins, make_op("contiguous"), x));
+    }
+
+    // Sum the input and recurrence biases [D, 2*G*C] to the ldgo layout [1, D, G, C] of dnnl,
+    // with a linear_before_reset gru the biases of the hidden gate are separate gates
+    instruction_ref insert_rnn_bias(instruction_ref ins,
+                                    instruction_ref b,
+                                    const std::vector<int64_t>& order,
+                                    bool lbr) const
+    {
+        auto lens  = b->get_shape().lens();
+        auto gates = order.size();
+        auto x     = modl->insert_instruction(
+            ins,
+            make_op("reshape", {{"dims", {lens[0], 2, gates, lens[1] / (2 * gates)}}}),
+            b);
+        auto sum = modl->insert_instruction(ins, make_op("reduce_sum", {{"axes", {1}}}), x);
+        if(lbr)
+        {
+            auto zr = modl->insert_instruction(
+                ins, make_op("slice", {{"axes", {2}}, {"starts", {0}}, {"ends", {2}}}), sum);
+            auto h = modl->insert_instruction(
+                ins, make_op("slice", {{"axes", {2}}, {"starts", {2}}, {"ends", {3}}}), x);
+            h = modl->insert_instruction(
+                ins, make_op("transpose", {{"permutation", {0, 2, 1, 3}}}), h);
+            sum = modl->insert_instruction(ins, make_op("concat", {{"axis", 2}}), zr, h);
+        }
+        sum = insert_gate_order(ins, sum, order, 2);
+        sum = modl->insert_instruction(
+            ins, make_op("transpose", {{"permutation", {1, 0, 2, 3}}}), sum);
+        return insert_folded(modl->insert_instruction(ins, make_op("contiguous"), sum));
+    }
+
+    instruction_ref insert_gate_order(instruction_ref ins,
+                                      instruction_ref x,
+                                      const std::vector<int64_t>& order,
+                                      int64_t axis) const
+    {
+        if(std::is_sorted(order.begin(), order.end()))
+            return x;
+        auto indices = modl->add_literal(literal{{shape::int64_type, {order.size()}}, order});
+        return modl->insert_instruction(ins, make_op("gather", {{"axis", axis}}), x, indices);
+    }
+
+    instruction_ref insert_zeros(const shape& s) const
+    {
+        return modl->add_literal(literal{s, std::vector<float>(s.elements())});
+    }
+
+    // Rearrange constant weights once at compile time
+    instruction_ref insert_folded(instruction_ref x) const
+    {
+        if(not x->can_eval())
+            return x;
+        auto r = x->eval();
+        modl->remove_instruction(x);
+        return modl->add_literal(literal{r.get_shape(), r.data()});
+    }
+
     instruction_ref apply_pooling(instruction_ref ins) const
     {
         auto&& op = ins->get_operator();
         auto v    = op.to_value();
-        if(has_op("dnnl::pooling") and ins->get_shape().type() == shape::type_t::float_type and
-           not v["ceil_mode"].to<bool>())
-            return replace(ins, make_op("dnnl::pooling", op.to_value()));
+        if(has_op("dnnl::pooling") and not v["ceil_mode"].to<bool>())
+        {
+            auto pooling = make_op("dnnl::pooling", op.to_value());
+            if(ins->get_shape().type() == shape::type_t::float_type or
+               is_supported(ins, pooling, ins->inputs()))
+                return replace(ins, pooling);
+        }
         std::string mode = v["mode"].to<std::string>();
         if(mode == "max")
             return replace(ins, make_op("cpu::pooling_max", v));
@@ -489,10 +901,65 @@ struct cpu_apply
     instruction_ref
     replace(instruction_ref ins, const operation& op, std::vector<instruction_ref> inputs) const
     {
+        if(can_compute_in_float(ins, inputs) and not is_supported(ins, op, inputs))
+            return replace_with_float(ins, op, std::move(inputs));
         inputs.push_back(insert_allocation(ins, ins->get_shape()));
         return modl->replace_instruction(ins, op, inputs);
     }
 
+    static bool
+    is_supported(instruction_ref ins, const operation& op, const std::vector<instruction_ref>& inputs)
+    {
+        auto shapes = to_shapes(inputs);
+        shapes.push_back(ins->get_shape());
+        return not try_compute_shape(op, shapes).empty();
+    }
+
+    // The fallback only converts the inputs with the type of the output, so an
+    // operator with a different output type, like the int32 of the quantized
+    // operators, can not be computed in float this way
+    static bool
+    can_compute_in_float(instruction_ref ins, const std::vector<instruction_ref>& inputs)
+    {
+        auto t = ins->get_shape().type();
+        if(t == shape::type_t::float_type)
+            return false;
+        return std::any_of(inputs.begin(), inputs.end(), [&](auto input) {
+            return input->get_shape().type() == t;
+        });
+    }
+
+    // Not every dnnl primitive has a half or int8 implementation on every
+    // cpu, so compute those in float and convert the result back
+    instruction_ref replace_with_float(instruction_ref ins,
+                                       const operation& op,
+                                       std::vector<instruction_ref> inputs) const
+    {
+        auto t = ins->get_shape().type();
+        std::transform(inputs.begin(), inputs.end(), inputs.begin(), [&](auto input) {
+            if(input->get_shape().type() != t)
+                return input;
+            return insert_convert(ins, input, shape::type_t::float_type);
+        });
+        auto s = ins->get_shape();
+        inputs.push_back(insert_allocation(ins, s.with_lens(shape::type_t::float_type, s.lens())));
+        auto result = modl->insert_instruction(ins, op, inputs);
+        return modl->replace_instruction(
+            ins, make_op("convert", {{"target_type", s.type()}}), result);
+    }
+
+    instruction_ref insert_convert(instruction_ref ins, instruction_ref input, shape::type_t t) const
+    {
+        auto result =
+            modl->insert_instruction(ins, make_op("convert", {{"target_type", t}}), input);
+        // Convert weights once at compile time
+        if(not input->can_eval())
+            return result;
+        auto r = result->eval();
+        modl->remove_instruction(result);
+        return modl->add_literal(literal{r.get_shape(), r.data()});
+    }
+
     instruction_ref insert_allocation(instruction_ref ins, const shape& s) const
     {
         return modl->insert_instruction(ins, make_op("cpu::allocate", {{"shape", to_value(s)}}));
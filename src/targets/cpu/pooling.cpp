@@ -71,8 +71,9 @@ struct cpu_pooling : auto_register_op<cpu_pooling<Op>>
         return shapes.size() - 1;
     }
 
-    argument compute(context&, const shape& output_shape, std::vector<argument> args) const
+    argument compute(context& ctx, const shape& output_shape, std::vector<argument> args) const
     {
+        thread_pool_scope scope{ctx.get_thread_pool(), ctx.intra_op_threads()};
         visit_all(args.back(), args[0])([&](auto output, auto input) {
             using type   = typename decltype(output)::value_type;
             auto in_s    = input.get_shape();
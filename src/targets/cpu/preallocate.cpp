@@ -13,7 +13,6 @@ struct cpu_preallocate : auto_register_op<cpu_preallocate>
 {
     shape s;
     std::string id = "";
-    argument data;
 
     template <class Self, class F>
     static auto reflect(Self& self, F f)
@@ -27,8 +26,14 @@ struct cpu_preallocate : auto_register_op<cpu_preallocate>
         check_shapes{inputs, *this}.has(0);
         return s;
     }
-    argument compute(context&, const shape&, const std::vector<argument>&) const { return data; }
-    void finalize(context&, const shape&, const std::vector<shape>&) { data = argument(s); }
+    argument compute(context& ctx, const shape&, const std::vector<argument>&) const
+    {
+        return ctx.get_preallocation(id, s);
+    }
+    void finalize(context& ctx, const shape&, const std::vector<shape>&) const
+    {
+        ctx.get_preallocation(id, s);
+    }
     lifetime get_lifetime() const { return lifetime::global; }
 };
 
@@ -0,0 +1,145 @@
+#include <migraphx/cpu/prepack_weights.hpp>
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/cpu/dnnl.hpp>
+#include <migraphx/module.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/register_op.hpp>
+#include <migraphx/context.hpp>
+#include <migraphx/ranges.hpp>
+#include <unordered_map>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// Weights already in a dnnl layout, the data is stored as a flat buffer
+// since blocked layouts can be padded
+struct cpu_packed_literal
+{
+    shape s;
+    argument data;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.s, "shape"), f(self.data, "data"));
+    }
+
+    std::string name() const { return "cpu::packed_literal"; }
+
+    shape compute_shape(const std::vector<shape>&) const { return s; }
+
+    argument compute(const shape&, const std::vector<argument>&) const { return data.reshape(s); }
+
+    friend std::ostream& operator<<(std::ostream& os, const cpu_packed_literal& x)
+    {
+        os << x.name();
+        return os;
+    }
+};
+MIGRAPHX_REGISTER_OP(cpu_packed_literal);
+
+static argument pack(context& ctx, const argument& a, const std::string& format)
+{
+    auto s       = a.get_shape();
+    auto reorder = make_op("dnnl::reorder", {{"formats", std::vector<std::string>{"", format}}});
+    std::vector<shape> shapes = {s, get_buffer_shape({s.type(), s.lens()}, format)};
+    auto output_shape         = reorder.compute_shape(shapes);
+    migraphx::context gctx    = std::ref(ctx);
+    reorder.finalize(gctx, output_shape, shapes);
+    argument result{shapes.back()};
+    reorder.compute(gctx, output_shape, {a, result});
+    return result;
+}
+
+// Every literal is packed once per format, the packed copy is shared by all the consumers
+struct packed_weights
+{
+    module* m;
+    context* ctx;
+    std::unordered_map<instruction_ref, std::vector<std::pair<std::string, instruction_ref>>>
+        cache;
+
+    instruction_ref get(instruction_ref w, const shape& s, const std::string& format)
+    {
+        auto& packed = cache[w];
+        auto it      = std::find_if(packed.begin(), packed.end(), [&](const auto& p) {
+            return p.first == format and p.second->get_shape() == s;
+        });
+        if(it != packed.end())
+            return it->second;
+        // Inserted at the start so it comes before every consumer
+        auto result = m->insert_instruction(
+            m->begin(),
+            cpu_packed_literal{s, pack(*ctx, w->get_literal().get_argument(), format)});
+        packed.emplace_back(format, result);
+        return result;
+    }
+
+    // Weights that were reordered to a blocked layout for the consumer
+    void pack_reorder(instruction_ref reorder)
+    {
+        auto v = reorder->get_operator().to_value();
+        if(v.at("formats").empty())
+            return;
+        auto format = v.at("formats").back().to<std::string>();
+        auto w      = reorder->inputs().front();
+        m->replace_instruction(reorder, get(w, reorder->get_shape(), format));
+    }
+
+    // Ask dnnl for the layout it prefers for the weights
+    void pack_literal(instruction_ref ins)
+    {
+        auto v = ins->get_operator().to_value();
+        std::vector<std::string> formats(ins->inputs().size());
+        if(not v.at("formats").empty())
+            formats = v.at("formats").to_vector<std::string>();
+        formats[1]   = "any";
+        v["formats"] = formats;
+        auto op      = make_op(ins->name(), v);
+        value info;
+        try
+        {
+            info = compile(op, *ctx, ins->get_shape(), to_shapes(ins->inputs()));
+        }
+        catch(...)
+        {
+            return;
+        }
+        if(not info.contains("formats"))
+            return;
+        auto format = info.at("formats").at(1).to<std::string>();
+        // Nothing to do for plain weights or layouts without a format tag
+        if(format.empty() or format == "any")
+            return;
+        formats[1]   = format;
+        v["formats"] = formats;
+        auto w       = ins->inputs().at(1);
+        auto inputs  = ins->inputs();
+        inputs[1]    = get(w, w->get_shape(), format);
+        m->replace_instruction(ins, make_op(ins->name(), v), inputs);
+    }
+};
+
+void prepack_weights::apply(module& m) const
+{
+    packed_weights pw{&m, ctx, {}};
+    for(auto ins : iterator_for(m))
+    {
+        if(not contains(
+               {"dnnl::convolution", "dnnl::quant_convolution", "dnnl::dot", "dnnl::quant_dot"},
+               ins->name()))
+            continue;
+        auto w = ins->inputs().at(1);
+        if(w->name() == "dnnl::reorder" and w->inputs().front()->name() == "@literal")
+            pw.pack_reorder(w);
+        else if(w->name() == "@literal")
+            pw.pack_literal(ins);
+    }
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,233 @@
+#include <migraphx/cpu/propagate_layout.hpp>
+#include <migraphx/cpu/allocation_model.hpp>
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/cpu/dnnl.hpp>
+#include <migraphx/module.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/stringutils.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/env.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_DISABLE_DNNL_BLOCKED_LAYOUT);
+
+static std::string get_output_format(instruction_ref ins)
+{
+    if(not starts_with(ins->name(), "dnnl::"))
+        return {};
+    auto v = ins->get_operator().to_value();
+    if(not v.contains("formats") or v.at("formats").empty())
+        return {};
+    return v.at("formats").back().to<std::string>();
+}
+
+static std::size_t get_post_op_args(const value& v)
+{
+    return std::count_if(v.at("post_ops").begin(), v.at("post_ops").end(), [](const auto& po) {
+        return contains(po.at("algo").template to<std::string>(), "binary");
+    });
+}
+
+// Inputs that are not broadcasted can use the same layout as the output
+static bool same_layout(instruction_ref input, instruction_ref ins)
+{
+    auto s = input->get_shape();
+    return s.lens() == ins->get_shape().lens() and not s.broadcasted();
+}
+
+struct layout_propagation
+{
+    module* m    = nullptr;
+    context* ctx = nullptr;
+    // Reorders back to the plain layout, shared by all consumers of a blocked output
+    std::unordered_map<instruction_ref, instruction_ref> plain = {};
+
+    instruction_ref
+    insert_reorder(instruction_ref pos, instruction_ref input, const std::string& to)
+    {
+        auto from = get_output_format(input);
+        if(from == to)
+            return input;
+        if(to.empty() and contains(plain, input))
+            return plain.at(input);
+        auto s     = input->get_shape();
+        auto alloc = m->insert_instruction(
+            pos, cpu_allocation_model{}.allocate(get_buffer_shape({s.type(), s.lens()}, to)));
+        auto reorder =
+            make_op("dnnl::reorder", {{"formats", std::vector<std::string>{from, to}}});
+        auto result = m->insert_instruction(pos, reorder, input, alloc);
+        if(to.empty())
+            plain[input] = result;
+        return result;
+    }
+
+    // Let dnnl choose the layouts for the convolution
+    std::vector<std::string>
+    resolve_convolution(instruction_ref ins, value v, std::size_t nargs) const
+    {
+        std::vector<std::string> formats(ins->inputs().size(), "");
+        formats[0]     = "any";
+        formats.back() = "any";
+        // Weights of grouped convolutions have an extra dimension in dnnl, so
+        // they are kept plain
+        if(v.at("group").to<int>() == 1)
+            formats[1] = "any";
+        v["formats"] = formats;
+        auto op      = make_op(ins->name(), v);
+        value info;
+        try
+        {
+            info = compile(op, *ctx, ins->get_shape(), to_shapes(ins->inputs()));
+        }
+        catch(...)
+        {
+            return {};
+        }
+        if(not info.contains("formats"))
+            return {};
+        auto result = info.at("formats").to_vector<std::string>();
+        // Layouts that can't be described by a format tag are left plain
+        if(contains(result, "any"))
+            return {};
+        result.resize(nargs);
+        result.push_back(info.at("formats").back().to<std::string>());
+        return result;
+    }
+
+    // Follow the layout of the first blocked input
+    std::vector<std::string> follow_input(instruction_ref ins, std::size_t nargs) const
+    {
+        auto last = ins->inputs().begin() + nargs;
+        auto it   = std::find_if(ins->inputs().begin(), last, [](auto input) {
+            return not get_output_format(input).empty();
+        });
+        if(it == last)
+            return {};
+        auto format = get_output_format(*it);
+        std::vector<std::string> result;
+        std::transform(ins->inputs().begin(), last, std::back_inserter(result), [&](auto input) {
+            if(ins->name() == "dnnl::binary" and not same_layout(input, ins))
+                return std::string{};
+            return format;
+        });
+        // A reorder already in the graph can convert to its plain output directly
+        if(ins->name() == "dnnl::reorder")
+            result.push_back("");
+        else
+            result.push_back(format);
+        return result;
+    }
+
+    std::vector<std::string> get_formats(instruction_ref ins) const
+    {
+        if(not contains({"dnnl::convolution",
+                         "dnnl::quant_convolution",
+                         "dnnl::pooling",
+                         "dnnl::eltwise",
+                         "dnnl::binary",
+                         "dnnl::reorder"},
+                        ins->name()))
+            return {};
+        auto v = ins->get_operator().to_value();
+        if(not v.at("formats").empty())
+            return {};
+        auto n     = ins->inputs().size() - 1;
+        auto nargs = n - get_post_op_args(v);
+        std::vector<std::string> formats;
+        if(contains(ins->name(), "convolution"))
+            formats = resolve_convolution(ins, v, nargs);
+        else
+            formats = follow_input(ins, nargs);
+        if(formats.empty())
+            return {};
+        // Binary post ops use the layout of the output when they are not broadcasted
+        auto output_format = formats.back();
+        formats.pop_back();
+        std::transform(ins->inputs().begin() + nargs,
+                       ins->inputs().begin() + n,
+                       std::back_inserter(formats),
+                       [&](auto input) {
+                           if(same_layout(input, ins))
+                               return output_format;
+                           return std::string{};
+                       });
+        formats.push_back(output_format);
+        if(std::all_of(formats.begin(), formats.end(), [](const auto& f) { return f.empty(); }))
+            return {};
+        // Make sure dnnl can run with these layouts
+        std::vector<shape> shapes = to_shapes(ins->inputs());
+        shapes.back()             = get_buffer_shape(ins->get_shape(), formats.back());
+        v["formats"]              = formats;
+        auto r                    = try_compute_shape(make_op(ins->name(), v), shapes);
+        if(r.empty() or r.front() != ins->get_shape())
+            return {};
+        return formats;
+    }
+
+    bool try_blocked(instruction_ref ins)
+    {
+        auto formats = get_formats(ins);
+        if(formats.empty())
+            return false;
+        auto inputs = ins->inputs();
+        for(std::size_t i = 0; i < inputs.size() - 1; i++)
+            inputs[i] = insert_reorder(ins, inputs[i], formats[i]);
+        if(inputs.back()->name() == "cpu::allocate")
+            inputs.back() = m->insert_instruction(
+                ins,
+                cpu_allocation_model{}.allocate(
+                    get_buffer_shape(ins->get_shape(), formats.back())));
+        else
+            // The sum post op accumulates into the other operand
+            inputs.back() = insert_reorder(ins, inputs.back(), formats.back());
+        auto v       = ins->get_operator().to_value();
+        v["formats"] = formats;
+        m->replace_instruction(ins, make_op(ins->name(), v), inputs);
+        return true;
+    }
+
+    void to_plain(instruction_ref ins)
+    {
+        auto inputs = ins->inputs();
+        for(auto input : inputs)
+        {
+            if(get_output_format(input).empty())
+                continue;
+            instruction::replace_argument(ins, input, insert_reorder(ins, input, ""));
+        }
+    }
+
+    void apply()
+    {
+        for(auto ins : iterator_for(*m))
+        {
+            if(not try_blocked(ins))
+                to_plain(ins);
+        }
+        // Nothing consumes the last instruction when there is no return, so
+        // the output of the module needs to be reordered as well. Values
+        // passed to or returned from a submodule are used by an op that is
+        // not blocked, so they are already plain.
+        if(m->begin() == m->end())
+            return;
+        auto last = std::prev(m->end());
+        if(last->name() != "@return" and not get_output_format(last).empty())
+            insert_reorder(m->end(), last, "");
+    }
+};
+
+void propagate_layout::apply(module& m) const
+{
+    if(enabled(MIGRAPHX_DISABLE_DNNL_BLOCKED_LAYOUT{}))
+        return;
+    layout_propagation{&m, ctx}.apply();
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
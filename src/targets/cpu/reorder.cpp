@@ -15,6 +15,9 @@ struct dnnl_reorder : dnnl_op<dnnl_reorder, dnnl::reorder>
     {
         check_shapes{inputs, *this}.has(2);
         auto r = inputs.back();
+        // The allocation for a blocked layout only holds its size in bytes
+        if(not this->get_output_format().empty())
+            r = shape{inputs.front().type(), inputs.front().lens()};
         // Call to get_primitive to make sure an algo is available
         this->get_primitive(this->to_memory_desc(r, inputs));
         return r;
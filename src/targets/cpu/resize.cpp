@@ -0,0 +1,236 @@
+#include <migraphx/config.hpp>
+#include <migraphx/context.hpp>
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/op/resize.hpp>
+#include <algorithm>
+#include <numeric>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+using resize_samples = std::vector<op::resize::sample>;
+
+static bool is_identity(const resize_samples& samples, std::size_t l_in)
+{
+    if(samples.size() != l_in)
+        return false;
+    for(std::size_t i = 0; i < samples.size(); i++)
+    {
+        if(samples[i].lo != i or samples[i].weight != 0.0 or samples[i].extrapolate)
+            return false;
+    }
+    return true;
+}
+
+// A standard float input can be read by the first pass without a copy
+static const float* float_data(tensor_view<float> x)
+{
+    return x.get_shape().standard() ? x.data() : nullptr;
+}
+
+template <class T>
+static const float* float_data(const T&)
+{
+    return nullptr;
+}
+
+// Interpolate along the middle axis of a standard [outer, l_in, inner] tensor, each output row
+// of inner elements is a blend of two input rows
+template <class T>
+static void resize_axis(context& ctx,
+                        const float* src,
+                        T* dst,
+                        std::size_t outer,
+                        std::size_t l_in,
+                        std::size_t inner,
+                        const resize_samples& samples,
+                        float extrapolation_value)
+{
+    auto l_out = samples.size();
+    auto grain = std::max<std::size_t>(1, 4096 / inner);
+    ctx.bulk_execute(outer * l_out, grain, [&](auto start, auto end) {
+        for(auto i = start; i < end; i++)
+        {
+            const auto& s = samples[i % l_out];
+            auto o        = i / l_out;
+            T* y          = dst + i * inner;
+            if(s.extrapolate)
+            {
+                std::fill(y, y + inner, static_cast<T>(extrapolation_value));
+                continue;
+            }
+            const float* a = src + (o * l_in + s.lo) * inner;
+            const float* b = src + (o * l_in + s.hi) * inner;
+            auto w         = static_cast<float>(s.weight);
+            for(std::size_t k = 0; k < inner; k++)
+                y[k] = static_cast<T>(a[k] + w * (b[k] - a[k]));
+        }
+    });
+}
+
+struct cpu_resize : auto_register_op<cpu_resize>
+{
+    op::resize op;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return migraphx::reflect(self.op, f);
+    }
+    std::string name() const { return "cpu::" + op.name(); }
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        // Compensate for allocation
+        inputs.pop_back();
+        return migraphx::compute_shape(op, inputs);
+    }
+
+    // Nearest is a gather with a separable offset: the input offset of an output element is
+    // the sum of a per-axis offset table
+    template <class T, class U>
+    void compute_nearest(context& ctx,
+                         T output,
+                         U input,
+                         const std::vector<resize_samples>& samples) const
+    {
+        const auto& in_s = input.get_shape();
+        const auto& lens = output.get_shape().lens();
+        auto ndim        = lens.size();
+        auto last        = ndim == 0 ? 1 : lens.back();
+        auto nrows       = output.get_shape().elements() / last;
+        std::vector<std::vector<std::ptrdiff_t>> offsets(ndim);
+        for(std::size_t d = 0; d < ndim; d++)
+        {
+            std::transform(samples[d].begin(),
+                           samples[d].end(),
+                           std::back_inserter(offsets[d]),
+                           [&](const auto& s) -> std::ptrdiff_t {
+                               if(s.extrapolate)
+                                   return -1;
+                               return s.lo * in_s.strides()[d];
+                           });
+        }
+
+        using type               = typename T::value_type;
+        auto extrapolation_value = static_cast<type>(op.extrapolation_value);
+        const auto* in_ptr       = input.data();
+        auto* out_ptr            = output.data();
+        if(ndim == 0)
+        {
+            out_ptr[0] = in_ptr[0];
+            return;
+        }
+        auto grain = std::max<std::size_t>(1, 4096 / last);
+        ctx.bulk_execute(nrows, grain, [&](auto start, auto end) {
+            for(auto r = start; r < end; r++)
+            {
+                std::ptrdiff_t base = 0;
+                bool extrapolate    = false;
+                auto idx            = r;
+                for(auto d = ndim - 1; d > 0; d--)
+                {
+                    auto off    = offsets[d - 1][idx % lens[d - 1]];
+                    extrapolate = extrapolate or off < 0;
+                    base += off;
+                    idx /= lens[d - 1];
+                }
+                auto* y = out_ptr + r * last;
+                for(std::size_t j = 0; j < last; j++)
+                {
+                    auto off = offsets.back()[j];
+                    if(extrapolate or off < 0)
+                        y[j] = extrapolation_value;
+                    else
+                        y[j] = in_ptr[base + off];
+                }
+            }
+        });
+    }
+
+    // Linear runs one pass per resized axis over standard float buffers, shrinking axes first
+    // so the intermediate tensors stay small
+    template <class T, class U>
+    void compute_linear(context& ctx,
+                        T output,
+                        U input,
+                        const std::vector<resize_samples>& samples) const
+    {
+        auto lens = input.get_shape().lens();
+        std::vector<std::size_t> axes;
+        for(std::size_t d = 0; d < lens.size(); d++)
+        {
+            if(not is_identity(samples[d], lens[d]))
+                axes.push_back(d);
+        }
+        std::stable_sort(axes.begin(), axes.end(), [&](auto x, auto y) {
+            return samples[x].size() * lens[y] < samples[y].size() * lens[x];
+        });
+
+        if(axes.empty())
+        {
+            std::copy(input.begin(), input.end(), output.data());
+            return;
+        }
+
+        std::vector<float> buffer;
+        std::vector<float> next;
+        const float* src = float_data(input);
+        if(src == nullptr)
+        {
+            buffer.assign(input.begin(), input.end());
+            src = buffer.data();
+        }
+
+        for(std::size_t i = 0; i < axes.size(); i++)
+        {
+            auto axis  = axes[i];
+            auto outer = std::accumulate(
+                lens.begin(), lens.begin() + axis, std::size_t{1}, std::multiplies<>{});
+            auto inner = std::accumulate(
+                lens.begin() + axis + 1, lens.end(), std::size_t{1}, std::multiplies<>{});
+            auto l_in  = lens[axis];
+            lens[axis] = samples[axis].size();
+            if(i + 1 == axes.size())
+            {
+                resize_axis(ctx,
+                            src,
+                            output.data(),
+                            outer,
+                            l_in,
+                            inner,
+                            samples[axis],
+                            op.extrapolation_value);
+                break;
+            }
+            next.resize(outer * lens[axis] * inner);
+            resize_axis(
+                ctx, src, next.data(), outer, l_in, inner, samples[axis], op.extrapolation_value);
+            buffer.swap(next);
+            src = buffer.data();
+        }
+    }
+
+    argument
+    // cppcheck-suppress constParameter
+    compute(context& ctx, const shape&, const std::vector<argument>& args) const
+    {
+        auto samples = op.get_samples(args[0].get_shape().lens());
+        visit_all(args.back(), args[0])([&](auto output, auto input) {
+            if(op.mode == "nearest")
+                compute_nearest(ctx, output, input, samples);
+            else
+                compute_linear(ctx, output, input, samples);
+        });
+        return args.back();
+    }
+
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
+};
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
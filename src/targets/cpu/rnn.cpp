@@ -0,0 +1,494 @@
+#include <migraphx/config.hpp>
+#include <migraphx/context.hpp>
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/cpu/dnnl.hpp>
+#include <migraphx/op/common.hpp>
+#include <migraphx/check_shapes.hpp>
+#include <migraphx/register_op.hpp>
+#include <migraphx/ranges.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// The hidden states of every timestep followed by the last hidden state, and the last cell state
+// for an lstm
+static shape rnn_output_shape(const std::string& cell, const shape& hs, const shape& last)
+{
+    if(cell == "lstm")
+        return shape{{hs, last, last}};
+    return shape{{hs, last}};
+}
+
+template <class T, class U>
+static float dot(const T* x, const U* y, std::size_t n)
+{
+    float result = 0;
+    for(std::size_t i = 0; i < n; i++)
+        result += static_cast<float>(x[i]) * static_cast<float>(y[i]);
+    return result;
+}
+
+static void apply_actv(const operation& op, float* x, std::size_t n)
+{
+    auto name = op.name();
+    if(name == "sigmoid")
+        std::transform(x, x + n, x, [](float v) { return 1.0f / (1.0f + std::exp(-v)); });
+    else if(name == "tanh")
+        std::transform(x, x + n, x, [](float v) { return std::tanh(v); });
+    else if(name == "relu")
+        std::transform(x, x + n, x, [](float v) { return std::max(v, 0.0f); });
+    else if(name == "leaky_relu" or name == "elu")
+    {
+        auto alpha = op.to_value().at("alpha").to<float>();
+        bool elu   = name == "elu";
+        std::transform(x, x + n, x, [&](float v) {
+            if(v > 0)
+                return v;
+            return elu ? alpha * std::expm1(v) : alpha * v;
+        });
+    }
+    else
+    {
+        argument a{shape{shape::float_type, {n}}, x};
+        auto r = op.compute(a.get_shape(), {a});
+        r.visit([&](auto y) { std::copy(y.begin(), y.end(), x); });
+    }
+}
+
+// Computes an rnn, gru or lstm one timestep at a time. The input projection of every timestep is
+// computed up front, so each step is only the recurrence on the hidden state. Every sequence of
+// the batch has its own length, and the hidden states past the end are zero.
+struct cpu_rnn : auto_register_op<cpu_rnn>
+{
+    std::string cell                  = "rnn";
+    op::rnn_direction direction       = op::rnn_direction::forward;
+    std::vector<operation> actv_funcs = {};
+    int linear_before_reset           = 0;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.cell, "cell"),
+                    f(self.direction, "direction"),
+                    f(self.actv_funcs, "actv_func"),
+                    f(self.linear_before_reset, "linear_before_reset"));
+    }
+
+    std::string name() const { return "cpu::rnn"; }
+
+    std::size_t gates() const
+    {
+        if(cell == "lstm")
+            return 4;
+        if(cell == "gru")
+            return 3;
+        return 1;
+    }
+
+    // The inputs are the sequence, weights, recurrence weights, biases, sequence lengths and
+    // initial hidden state, followed by the initial cell state and peepholes for an lstm
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        // Compensate for allocation
+        inputs.pop_back();
+        check_shapes{inputs, *this}.has(cell == "lstm" ? 8 : 6).standard();
+        auto x = inputs[0].lens();
+        auto r = inputs[2].lens();
+        if(r[1] != gates() * r[2])
+            MIGRAPHX_THROW("CPU_RNN: Recurrence weights don't match the " + cell + " gates");
+        if(actv_funcs.size() % r[0] != 0)
+            MIGRAPHX_THROW("CPU_RNN: Wrong number of activation functions");
+        shape hs{inputs[0].type(), {x[0], r[0], x[1], r[2]}};
+        shape last{inputs[0].type(), {r[0], x[1], r[2]}};
+        return rnn_output_shape(cell, hs, last);
+    }
+
+    // NOLINTNEXTLINE(readability-function-cognitive-complexity)
+    argument compute(context& ctx, const shape&, const std::vector<argument>& args) const
+    {
+        auto result     = args.back();
+        auto outputs    = result.get_sub_objects();
+        auto lens       = outputs.front().get_shape().lens();
+        auto seq_len    = lens[0];
+        auto ndir       = lens[1];
+        auto batch      = lens[2];
+        auto hidden     = lens[3];
+        auto input_size = args[0].get_shape().lens()[2];
+        auto gh         = gates() * hidden;
+        auto actv_num   = actv_funcs.size() / ndir;
+        bool lstm       = cell == "lstm";
+        bool gru        = cell == "gru";
+        // The recurrent bias of the hidden gate of a gru is added after the reset gate is applied
+        // when linear_before_reset is set, all the other biases are added to the input projection
+        auto folded_bias = (gru and linear_before_reset != 0) ? 2 * hidden : gh;
+
+        std::vector<std::size_t> lengths(batch);
+        args[4].visit([&](auto sl) {
+            std::transform(sl.begin(), sl.end(), lengths.begin(), [&](auto l) {
+                return std::min<std::size_t>(std::max<int64_t>(l, 0), seq_len);
+            });
+        });
+
+        visit_all(outputs.front(), args[0])([&](auto hs, auto x) {
+            using type     = typename decltype(x)::value_type;
+            auto w         = args[1].get<type>();
+            auto r         = args[2].get<type>();
+            auto b         = args[3].get<type>();
+            auto h0        = args[5].get<type>();
+            auto last_hs   = outputs[1].get<type>();
+            auto* hs_ptr   = hs.data();
+            const auto* xp = x.data();
+            std::fill(hs.begin(), hs.end(), type{0});
+
+            std::vector<float> xw(seq_len * batch * gh);
+            std::vector<float> a(batch * gh);
+            std::vector<float> h(batch * hidden);
+            std::vector<float> c(batch * hidden);
+            // Recurrence of the hidden gate of a gru, which depends on the reset gate
+            std::vector<float> rec(batch * hidden);
+            for(std::size_t d = 0; d < ndir; d++)
+            {
+                bool reverse    = direction == op::rnn_direction::reverse or d == 1;
+                const auto* f   = actv_funcs.data() + d * actv_num;
+                const auto* wd  = w.data() + d * gh * input_size;
+                const auto* rd  = r.data() + d * gh * hidden;
+                const auto* wb  = b.data() + d * 2 * gh;
+                const auto* rb  = wb + gh;
+                const auto* rhd = rd + 2 * hidden * hidden;
+                // Peepholes of the input, output and forget gates of an lstm
+                const type* pi = nullptr;
+                const type* po = nullptr;
+                const type* pf = nullptr;
+                if(lstm)
+                {
+                    pi = args[7].get<type>().data() + d * 3 * hidden;
+                    po = pi + hidden;
+                    pf = pi + 2 * hidden;
+                }
+
+                ctx.bulk_execute(seq_len * batch * gh, 256, [&](auto start, auto end) {
+                    for(auto i = start; i < end; i++)
+                    {
+                        auto row  = i / gh;
+                        auto j    = i % gh;
+                        float bia = static_cast<float>(wb[j]);
+                        if(j < folded_bias)
+                            bia += static_cast<float>(rb[j]);
+                        xw[i] = dot(xp + row * input_size, wd + j * input_size, input_size) + bia;
+                    }
+                });
+                std::copy(h0.begin() + d * batch * hidden,
+                          h0.begin() + (d + 1) * batch * hidden,
+                          h.begin());
+                if(lstm)
+                {
+                    auto c0 = args[6].get<type>();
+                    std::copy(c0.begin() + d * batch * hidden,
+                              c0.begin() + (d + 1) * batch * hidden,
+                              c.begin());
+                }
+
+                for(std::size_t s = 0; s < seq_len; s++)
+                {
+                    auto time = [&](std::size_t bi) { return reverse ? lengths[bi] - 1 - s : s; };
+                    ctx.bulk_execute(batch * gh, 256, [&](auto start, auto end) {
+                        for(auto i = start; i < end; i++)
+                        {
+                            auto bi = i / gh;
+                            auto j  = i % gh;
+                            if(s >= lengths[bi])
+                                continue;
+                            a[i] = xw[(time(bi) * batch + bi) * gh + j];
+                            if(gru and j >= 2 * hidden)
+                            {
+                                auto k = j - 2 * hidden;
+                                if(linear_before_reset != 0)
+                                    rec[bi * hidden + k] =
+                                        dot(h.data() + bi * hidden, rd + j * hidden, hidden) +
+                                        static_cast<float>(rb[j]);
+                                continue;
+                            }
+                            a[i] += dot(h.data() + bi * hidden, rd + j * hidden, hidden);
+                        }
+                    });
+
+                    if(gru)
+                    {
+                        ctx.bulk_execute(batch, 1, [&](auto start, auto end) {
+                            for(auto bi = start; bi < end; bi++)
+                            {
+                                if(s >= lengths[bi])
+                                    continue;
+                                auto* az = a.data() + bi * gh;
+                                auto* ar = az + hidden;
+                                auto* ah = ar + hidden;
+                                apply_actv(f[0], az, 2 * hidden);
+                                for(std::size_t k = 0; k < hidden; k++)
+                                {
+                                    if(linear_before_reset != 0)
+                                        ah[k] += ar[k] * rec[bi * hidden + k];
+                                    else
+                                        rec[bi * hidden + k] = ar[k] * h[bi * hidden + k];
+                                }
+                            }
+                        });
+                        if(linear_before_reset == 0)
+                        {
+                            ctx.bulk_execute(batch * hidden, 256, [&](auto start, auto end) {
+                                for(auto i = start; i < end; i++)
+                                {
+                                    auto bi = i / hidden;
+                                    auto k  = i % hidden;
+                                    if(s >= lengths[bi])
+                                        continue;
+                                    a[bi * gh + 2 * hidden + k] += dot(
+                                        rec.data() + bi * hidden, rhd + k * hidden, hidden);
+                                }
+                            });
+                        }
+                    }
+
+                    ctx.bulk_execute(batch, 1, [&](auto start, auto end) {
+                        for(auto bi = start; bi < end; bi++)
+                        {
+                            if(s >= lengths[bi])
+                                continue;
+                            auto* ab = a.data() + bi * gh;
+                            auto* hb = h.data() + bi * hidden;
+                            if(lstm)
+                            {
+                                auto* ai = ab;
+                                auto* ao = ab + hidden;
+                                auto* af = ab + 2 * hidden;
+                                auto* ac = ab + 3 * hidden;
+                                auto* cb = c.data() + bi * hidden;
+                                for(std::size_t k = 0; k < hidden; k++)
+                                {
+                                    ai[k] += static_cast<float>(pi[k]) * cb[k];
+                                    af[k] += static_cast<float>(pf[k]) * cb[k];
+                                }
+                                apply_actv(f[0], ai, hidden);
+                                apply_actv(f[0], af, hidden);
+                                apply_actv(f[1], ac, hidden);
+                                for(std::size_t k = 0; k < hidden; k++)
+                                {
+                                    cb[k] = af[k] * cb[k] + ai[k] * ac[k];
+                                    ao[k] += static_cast<float>(po[k]) * cb[k];
+                                }
+                                apply_actv(f[0], ao, hidden);
+                                std::copy(cb, cb + hidden, ac);
+                                apply_actv(f[2], ac, hidden);
+                                std::transform(ao, ao + hidden, ac, hb, std::multiplies<>{});
+                            }
+                            else if(gru)
+                            {
+                                auto* az = ab;
+                                auto* ah = ab + 2 * hidden;
+                                apply_actv(f[1], ah, hidden);
+                                for(std::size_t k = 0; k < hidden; k++)
+                                    hb[k] = (1 - az[k]) * ah[k] + az[k] * hb[k];
+                            }
+                            else
+                            {
+                                apply_actv(f[0], ab, hidden);
+                                std::copy(ab, ab + hidden, hb);
+                            }
+                            auto* out = hs_ptr + ((time(bi) * ndir + d) * batch + bi) * hidden;
+                            std::copy(hb, hb + hidden, out);
+                        }
+                    });
+                }
+
+                std::copy(h.begin(), h.end(), last_hs.begin() + d * batch * hidden);
+                if(lstm)
+                {
+                    auto last_cell = outputs[2].get<type>();
+                    std::copy(c.begin(), c.end(), last_cell.begin() + d * batch * hidden);
+                }
+            }
+        });
+        return result;
+    }
+
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
+};
+
+#ifndef MIGRAPHX_ENABLE_ZENDNN
+// The fused rnn primitives of dnnl, which compute every timestep of the whole batch. The weights
+// are in the ldigo layout with the gates in the order used by dnnl, and the biases are summed.
+struct dnnl_rnn : auto_register_op<dnnl_rnn>
+{
+    std::string cell            = "rnn";
+    op::rnn_direction direction = op::rnn_direction::forward;
+    // Activation of a vanilla rnn
+    std::string algo        = "eltwise_tanh";
+    int linear_before_reset = 0;
+    std::function<argument(context& ctx, const std::vector<argument>& args)> execute;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.cell, "cell"),
+                    f(self.direction, "direction"),
+                    f(self.algo, "algo"),
+                    f(self.linear_before_reset, "linear_before_reset"));
+    }
+
+    std::string name() const { return "dnnl::rnn"; }
+
+    // The inputs are the sequence [T, N, I], the weights [1, D, I, G, C], the recurrence
+    // weights [1, D, C, G, C], the biases [1, D, G, C] and the initial hidden state [1, D, N, C],
+    // followed by the initial cell state for an lstm. The hidden states are computed as
+    // [T, N, D, C], which is the layout of a bidirectional rnn in dnnl.
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        // Compensate for allocation
+        inputs.pop_back();
+        check_shapes{inputs, *this}.has(cell == "lstm" ? 6 : 5).standard();
+        auto x = inputs[0].lens();
+        auto r = inputs[2].lens();
+        shape hs{inputs[0].type(), {x[0], x[1], r[1], r[2]}};
+        shape last{inputs[0].type(), {r[1], x[1], r[2]}};
+        // Call to get_primitive to make sure an algo is available
+        get_primitive(to_memory_desc(inputs));
+        return rnn_output_shape(cell, hs, last);
+    }
+
+    std::vector<int> arg_map() const
+    {
+        std::vector<int> result = {MIGRAPHX_DNNL_PREFIX(ARG_SRC_LAYER),
+                                   MIGRAPHX_DNNL_PREFIX(ARG_WEIGHTS_LAYER),
+                                   MIGRAPHX_DNNL_PREFIX(ARG_WEIGHTS_ITER),
+                                   MIGRAPHX_DNNL_PREFIX(ARG_BIAS),
+                                   MIGRAPHX_DNNL_PREFIX(ARG_SRC_ITER)};
+        if(cell == "lstm")
+            result.push_back(MIGRAPHX_DNNL_PREFIX(ARG_SRC_ITER_C));
+        return result;
+    }
+
+    std::vector<int> output_arg_map() const
+    {
+        std::vector<int> result = {MIGRAPHX_DNNL_PREFIX(ARG_DST_LAYER),
+                                   MIGRAPHX_DNNL_PREFIX(ARG_DST_ITER)};
+        if(cell == "lstm")
+            result.push_back(MIGRAPHX_DNNL_PREFIX(ARG_DST_ITER_C));
+        return result;
+    }
+
+    std::unordered_map<int, dnnl::memory::desc>
+    to_memory_desc(const std::vector<shape>& inputs) const
+    {
+        std::unordered_map<int, dnnl::memory::desc> result;
+        auto m = arg_map();
+        for(std::size_t i = 0; i < inputs.size(); i++)
+            result[m[i]] = to_dnnl_memory_desc(inputs[i]);
+        auto x    = to_dnnl_dims(inputs[0].lens());
+        auto r    = to_dnnl_dims(inputs[2].lens());
+        auto t    = to_dnnl_memory_data_type(inputs[0].type());
+        auto ndir = r[1];
+        auto c    = r[2];
+        result[MIGRAPHX_DNNL_PREFIX(ARG_DST_LAYER)] =
+            dnnl::memory::desc({x[0], x[1], ndir * c}, t, dnnl::memory::format_tag::tnc);
+        for(auto arg : {MIGRAPHX_DNNL_PREFIX(ARG_DST_ITER), MIGRAPHX_DNNL_PREFIX(ARG_DST_ITER_C)})
+            result[arg] = dnnl::memory::desc({1, ndir, x[1], c}, t, dnnl::memory::format_tag::ldnc);
+        return result;
+    }
+
+    dnnl::rnn_direction get_direction() const
+    {
+        switch(direction)
+        {
+        case op::rnn_direction::forward: return dnnl::rnn_direction::unidirectional_left2right;
+        case op::rnn_direction::reverse: return dnnl::rnn_direction::unidirectional_right2left;
+        case op::rnn_direction::bidirectional: return dnnl::rnn_direction::bidirectional_concat;
+        }
+        MIGRAPHX_THROW("Unknown rnn direction");
+    }
+
+    template <class Primitive, class... Ts>
+    static Primitive make_primitive(Ts&&... xs)
+    {
+        typename Primitive::desc desc(dnnl::prop_kind::forward_inference, std::forward<Ts>(xs)...);
+        return Primitive(typename Primitive::primitive_desc(desc, get_dnnl_context().engine));
+    }
+
+    dnnl::primitive get_primitive(const std::unordered_map<int, dnnl::memory::desc>& m) const
+    {
+        auto dir           = get_direction();
+        auto src_layer     = m.at(MIGRAPHX_DNNL_PREFIX(ARG_SRC_LAYER));
+        auto src_iter      = m.at(MIGRAPHX_DNNL_PREFIX(ARG_SRC_ITER));
+        auto weights_layer = m.at(MIGRAPHX_DNNL_PREFIX(ARG_WEIGHTS_LAYER));
+        auto weights_iter  = m.at(MIGRAPHX_DNNL_PREFIX(ARG_WEIGHTS_ITER));
+        auto bias          = m.at(MIGRAPHX_DNNL_PREFIX(ARG_BIAS));
+        auto dst_layer     = m.at(MIGRAPHX_DNNL_PREFIX(ARG_DST_LAYER));
+        auto dst_iter      = m.at(MIGRAPHX_DNNL_PREFIX(ARG_DST_ITER));
+        if(cell == "lstm")
+            return make_primitive<dnnl::lstm_forward>(dir,
+                                                      src_layer,
+                                                      src_iter,
+                                                      m.at(MIGRAPHX_DNNL_PREFIX(ARG_SRC_ITER_C)),
+                                                      weights_layer,
+                                                      weights_iter,
+                                                      bias,
+                                                      dst_layer,
+                                                      dst_iter,
+                                                      m.at(MIGRAPHX_DNNL_PREFIX(ARG_DST_ITER_C)));
+        if(cell == "gru" and linear_before_reset != 0)
+            return make_primitive<dnnl::lbr_gru_forward>(
+                dir, src_layer, src_iter, weights_layer, weights_iter, bias, dst_layer, dst_iter);
+        if(cell == "gru")
+            return make_primitive<dnnl::gru_forward>(
+                dir, src_layer, src_iter, weights_layer, weights_iter, bias, dst_layer, dst_iter);
+        return make_primitive<dnnl::vanilla_rnn_forward>(to_dnnl_algo(algo),
+                                                         dir,
+                                                         src_layer,
+                                                         src_iter,
+                                                         weights_layer,
+                                                         weights_iter,
+                                                         bias,
+                                                         dst_layer,
+                                                         dst_iter);
+    }
+
+    void finalize(context&, const shape&, std::vector<shape> inputs)
+    {
+        // Compensate for allocation
+        inputs.pop_back();
+        auto md         = to_memory_desc(inputs);
+        auto prim       = get_primitive(md);
+        auto arg_lookup = arg_map();
+        auto out_lookup = output_arg_map();
+        execute         = [=](context&, const std::vector<argument>& args) {
+            std::unordered_map<int, dnnl::memory> m;
+            for(std::size_t i = 0; i < args.size() - 1; i++)
+                m[arg_lookup[i]] = to_dnnl_memory(md.at(arg_lookup[i]), args[i]);
+            auto outputs = args.back().get_sub_objects();
+            for(std::size_t i = 0; i < outputs.size(); i++)
+                m[out_lookup[i]] = to_dnnl_memory(md.at(out_lookup[i]), outputs[i]);
+            prim.execute(get_dnnl_stream(), m);
+            return args.back();
+        };
+    }
+
+    argument compute(context& ctx, const shape&, const std::vector<argument>& args) const
+    {
+        return execute(ctx, args);
+    }
+
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
+};
+#endif
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
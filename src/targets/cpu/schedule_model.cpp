@@ -0,0 +1,205 @@
+#include <migraphx/cpu/schedule_model.hpp>
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/register_op.hpp>
+#include <migraphx/module.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/operation.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/op/identity.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+struct record_event
+{
+    std::size_t event = 0;
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.event, "event"));
+    }
+    std::string name() const { return "cpu::record_event"; }
+    shape compute_shape(const std::vector<shape>&) const { return {}; }
+
+    argument compute(context& ctx, const shape&, const std::vector<argument>&) const
+    {
+        ctx.record_event(event);
+        return {};
+    }
+};
+
+struct wait_event
+{
+    std::size_t event = 0;
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.event, "event"));
+    }
+    std::string name() const { return "cpu::wait_event"; }
+    shape compute_shape(const std::vector<shape>&) const { return {}; }
+
+    argument compute(context& ctx, const shape&, const std::vector<argument>&) const
+    {
+        ctx.wait_event(event);
+        return {};
+    }
+};
+
+struct set_stream
+{
+    std::size_t stream = 0;
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.stream, "stream"));
+    }
+    std::string name() const { return "cpu::set_stream"; }
+    shape compute_shape(const std::vector<shape>&) const { return {}; }
+
+    argument compute(context& ctx, const shape&, const std::vector<argument>&) const
+    {
+        ctx.set_stream(stream);
+        return {};
+    }
+};
+
+// Wait for every stream to finish before returning from the module
+struct finish_streams
+{
+    std::string name() const { return "cpu::finish_streams"; }
+    shape compute_shape(const std::vector<shape>&) const { return {}; }
+
+    argument compute(context& ctx, const shape&, const std::vector<argument>&) const
+    {
+        ctx.finish();
+        return {};
+    }
+};
+
+// Runs the operator as a task on the current stream. The result is returned
+// straight away and waits for the task when its data is accessed.
+struct async_op
+{
+    operation op = op::identity{};
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return migraphx::reflect(self.op, f);
+    }
+    std::string name() const { return "cpu::async"; }
+    shape compute_shape(const std::vector<shape>& inputs) const { return op.compute_shape(inputs); }
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return op.output_alias(shapes);
+    }
+    void finalize(context& ctx, const shape& output_shape, const std::vector<shape>& inputs)
+    {
+        migraphx::context gctx = std::ref(ctx);
+        op.finalize(gctx, output_shape, inputs);
+    }
+    argument compute(context& ctx, const shape& output_shape, const std::vector<argument>& args) const
+    {
+        auto result = std::make_shared<argument>();
+        auto t      = ctx.async([=, &ctx] {
+            migraphx::context gctx = std::ref(ctx);
+            *result                = op.compute(gctx, output_shape, args);
+        });
+        return {output_shape, [=] {
+                    t->wait();
+                    return result->data();
+                }};
+    }
+    value to_value() const
+    {
+        value v;
+        v["name"]     = op.name();
+        v["operator"] = op.to_value();
+        return v;
+    }
+    void from_value(const value& v)
+    {
+        op = make_op(v.at("name").to<std::string>(), v.at("operator"));
+    }
+    friend std::ostream& operator<<(std::ostream& os, const async_op& x)
+    {
+        os << "cpu::async::" << x.op;
+        return os;
+    }
+};
+
+MIGRAPHX_REGISTER_OP(record_event)
+MIGRAPHX_REGISTER_OP(wait_event)
+MIGRAPHX_REGISTER_OP(set_stream)
+MIGRAPHX_REGISTER_OP(finish_streams)
+MIGRAPHX_REGISTER_OP(async_op)
+
+// The tasks write to scratch memory that the next eval reuses, so all streams
+// are finished before the last instruction, which is the output of the module
+// when there is no return. The last instruction runs after the streams finish.
+static void finish_module(module& p)
+{
+    auto last = std::prev(p.end());
+    if(last == p.begin() or std::prev(last)->name() != "cpu::finish_streams")
+        p.insert_instruction(last, finish_streams{});
+}
+
+std::size_t schedule_model::concurrency() const { return streams; }
+void schedule_model::sched(module& p, instruction_ref ins, std::size_t n) const
+{
+    finish_module(p);
+    if(ins == std::prev(p.end()))
+        return;
+    auto last_stream = std::find_if(std::make_reverse_iterator(ins),
+                                    std::make_reverse_iterator(p.begin()),
+                                    [&](auto&& i) { return i.name() == "cpu::set_stream"; });
+    if(last_stream == std::make_reverse_iterator(p.begin()) or
+       any_cast<set_stream>(last_stream->get_operator()).stream != n)
+        p.insert_instruction(ins, set_stream{n});
+    if(ins->name().front() != '@')
+        p.replace_instruction(ins, async_op{ins->get_operator()}, ins->inputs());
+}
+
+void schedule_model::wait(module& p, instruction_ref ins, std::size_t wait_id) const
+{
+    p.insert_instruction(ins, wait_event{wait_id});
+}
+void schedule_model::record(module& p, instruction_ref ins, std::size_t wait_id) const
+{
+    p.insert_instruction(std::next(ins), record_event{wait_id});
+}
+
+static std::unordered_map<std::string, std::size_t> create_weight_map()
+{
+    return {{"cpu::allocate", 0},
+            {"cpu::literal", 0},
+            {"cpu::packed_literal", 0},
+            {"cpu::preallocate", 0},
+            {"dnnl::convolution", 8},
+            {"dnnl::quant_convolution", 8},
+            {"dnnl::deconvolution", 8},
+            {"dnnl::pooling", 4},
+            {"dnnl::dot", 4},
+            {"dnnl::quant_dot", 4}};
+}
+
+static const std::unordered_map<std::string, std::size_t>& weight_map()
+{
+    static const std::unordered_map<std::string, std::size_t> m = create_weight_map();
+    return m;
+}
+
+std::size_t schedule_model::weight(const operation& op) const
+{
+    if(weight_map().count(op.name()) == 0)
+    {
+        return 2;
+    }
+    return weight_map().at(op.name());
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -10,13 +10,14 @@
 #include <migraphx/eliminate_data_type.hpp>
 #include <migraphx/eliminate_identity.hpp>
 #include <migraphx/eliminate_pad.hpp>
+#include <migraphx/env.hpp>
+#include <migraphx/fuse_pointwise.hpp>
 #include <migraphx/memory_coloring.hpp>
 #include <migraphx/propagate_constant.hpp>
 #include <migraphx/register_target.hpp>
 #include <migraphx/rewrite_batchnorm.hpp>
 #include <migraphx/rewrite_pooling.hpp>
 #include <migraphx/rewrite_quantization.hpp>
-#include <migraphx/rewrite_rnn.hpp>
 #include <migraphx/schedule.hpp>
 #include <migraphx/memory_coloring.hpp>
 #include <migraphx/simplify_algebra.hpp>
@@ -24,6 +25,9 @@
 #include <migraphx/simplify_reshapes.hpp>
 #include <migraphx/preallocate_param.hpp>
 #include <migraphx/cpu/fuse_ops.hpp>
+#include <migraphx/cpu/prepack_weights.hpp>
+#include <migraphx/cpu/schedule_model.hpp>
+#include <migraphx/cpu/propagate_layout.hpp>
 #include <migraphx/cpu/write_literals.hpp>
 #include <migraphx/cpu/allocation_model.hpp>
 #include <migraphx/cpu/target.hpp>
@@ -37,15 +41,38 @@ namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 namespace cpu {
 
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_ENABLE_POINTWISE_FUSION)
+
 std::string target::name() const { return "cpu"; }
 
+struct id_pass
+{
+    std::string name() const { return "id"; }
+    void apply(const module&) const {}
+};
+
+pass enable_pass(bool enabled, pass p)
+{
+    if(enabled)
+        return p;
+    return id_pass{};
+}
+
 // cppcheck-suppress constParameter
 std::vector<pass> target::get_passes(migraphx::context& gctx, const compile_options&) const
 {
     auto& ctx = any_cast<context>(gctx);
     std::set<shape::type_t> unsupported_types(shape::types().begin(), shape::types().end());
     unsupported_types.erase(shape::type_t::float_type);
+    // Half, bf16 and int8 are kept end-to-end, lowering falls back to float for
+    // the dnnl primitives that lack an implementation for them
+    unsupported_types.erase(shape::type_t::half_type);
+    unsupported_types.erase(shape::type_t::bf16_type);
+    unsupported_types.erase(shape::type_t::int8_type);
+    unsupported_types.erase(shape::type_t::uint8_type);
     return {normalize_ops{},
+            dead_code_elimination{},
+            simplify_qdq{},
             rewrite_quantization{},
             dead_code_elimination{},
             eliminate_data_type{unsupported_types, shape::type_t::float_type},
@@ -56,8 +83,6 @@ std::vector<pass> target::get_passes(migraphx::context& gctx, const compile_opti
             dead_code_elimination{},
             rewrite_batchnorm{},
             dead_code_elimination{},
-            rewrite_rnn{},
-            dead_code_elimination{},
             eliminate_common_subexpression{},
             dead_code_elimination{},
             simplify_algebra{},
@@ -67,6 +92,8 @@ std::vector<pass> target::get_passes(migraphx::context& gctx, const compile_opti
             simplify_reshapes{},
             propagate_constant{},
             dead_code_elimination{},
+            enable_pass(enabled(MIGRAPHX_ENABLE_POINTWISE_FUSION{}), fuse_pointwise{}),
+            dead_code_elimination{},
             lowering{},
             eliminate_contiguous{"dnnl::reorder"},
             dead_code_elimination{},
@@ -74,9 +101,15 @@ std::vector<pass> target::get_passes(migraphx::context& gctx, const compile_opti
             dead_code_elimination{},
             fuse_ops{&ctx},
             dead_code_elimination{},
+            propagate_layout{&ctx},
+            dead_code_elimination{},
+            prepack_weights{&ctx},
+            dead_code_elimination{},
             write_literals{},
             dead_code_elimination{},
-            memory_coloring{"cpu::allocate"},
+            schedule{cpu::schedule_model{ctx.nstreams()}, ctx.nstreams() > 1},
+            // Cache line alignment for the vector loads, and page alignment for large buffers
+            memory_coloring{"cpu::allocate", false, 64, 1024 * 1024, 4096},
             dead_code_elimination{},
             preallocate_param{"scratch", cpu_allocation_model{}},
             dead_code_elimination{}};
@@ -0,0 +1,194 @@
+#include <migraphx/cpu/task_pool.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// Index of the worker running on this thread, used to push new tasks to the
+// worker's own queue
+// NOLINTNEXTLINE
+static thread_local const task_pool* current_pool = nullptr;
+// NOLINTNEXTLINE
+static thread_local std::size_t current_worker = 0;
+
+void task::fail(const std::exception_ptr& e)
+{
+    if(e == nullptr)
+        return;
+    std::lock_guard<std::mutex> lock(m);
+    if(error == nullptr)
+        error = e;
+}
+
+void task::wait()
+{
+    std::unique_lock<std::mutex> lock(m);
+    cv.wait(lock, [&] { return done; });
+    if(error)
+        std::rethrow_exception(error);
+}
+
+task_pool::task_pool(std::size_t n, const std::function<void()>& init)
+{
+    queues.resize(n);
+    std::generate(queues.begin(), queues.end(), [] { return std::make_unique<queue>(); });
+    for(std::size_t i = 0; i < n; i++)
+    {
+        threads.emplace_back([=] {
+            current_pool   = this;
+            current_worker = i;
+            if(init)
+                init();
+            this->work(i);
+        });
+    }
+}
+
+task_pool::~task_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stop = true;
+    }
+    ready_cv.notify_all();
+    for(auto& t : threads)
+        t.join();
+}
+
+std::size_t task_pool::size() const { return threads.size(); }
+
+task_ref task_pool::add(std::function<void()> f, const std::vector<task_ref>& deps)
+{
+    auto t = std::make_shared<task>();
+    t->f   = std::move(f);
+    {
+        std::lock_guard<std::mutex> lock(m);
+        outstanding++;
+    }
+    for(const auto& dep : deps)
+    {
+        if(dep == nullptr)
+            continue;
+        std::lock_guard<std::mutex> lock(dep->m);
+        if(dep->done)
+        {
+            t->fail(dep->error);
+            continue;
+        }
+        t->pending++;
+        dep->successors.push_back(t);
+    }
+    // Release the reference held while adding the dependencies
+    if(--t->pending == 0)
+        push(t);
+    return t;
+}
+
+void task_pool::wait_all()
+{
+    std::unique_lock<std::mutex> lock(m);
+    finished_cv.wait(lock, [&] { return outstanding == 0; });
+}
+
+void task_pool::push(task_ref t)
+{
+    std::size_t i = current_pool == this ? current_worker : next++ % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[i]->m);
+        queues[i]->tasks.push_back(std::move(t));
+    }
+    // The task is only counted once it is queued, so a worker that takes the
+    // count always finds a task
+    {
+        std::lock_guard<std::mutex> lock(m);
+        ready++;
+    }
+    ready_cv.notify_one();
+}
+
+task_ref task_pool::pop(std::size_t i)
+{
+    // Take the most recent task from our own queue first since its inputs are
+    // likely still in cache, then steal the oldest tasks from the others
+    for(std::size_t k = 0; k < queues.size(); k++)
+    {
+        auto& q = *queues[(i + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(q.m);
+        if(q.tasks.empty())
+            continue;
+        task_ref t;
+        if(k == 0)
+        {
+            t = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        }
+        else
+        {
+            t = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+        return t;
+    }
+    return nullptr;
+}
+
+void task_pool::run(const task_ref& t)
+{
+    // A task whose dependencies failed is not run and fails with the same error
+    if(t->error == nullptr)
+    {
+        try
+        {
+            t->f();
+        }
+        catch(...)
+        {
+            t->error = std::current_exception();
+        }
+    }
+    t->f = nullptr;
+    std::vector<task_ref> successors;
+    {
+        std::lock_guard<std::mutex> lock(t->m);
+        t->done = true;
+        successors.swap(t->successors);
+    }
+    t->cv.notify_all();
+    for(auto& s : successors)
+    {
+        s->fail(t->error);
+        if(--s->pending == 0)
+            push(s);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m);
+        outstanding--;
+    }
+    finished_cv.notify_all();
+}
+
+void task_pool::work(std::size_t i)
+{
+    for(;;)
+    {
+        task_ref t = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            ready_cv.wait(lock, [&] { return stop or ready > 0; });
+            if(ready == 0)
+                return;
+            ready--;
+            // Tasks are only taken while holding the lock, so there is a
+            // queued task for every ready count
+            t = pop(i);
+        }
+        assert(t != nullptr);
+        run(t);
+    }
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -2,6 +2,7 @@
 #include <migraphx/module.hpp>
 #include <migraphx/instruction.hpp>
 #include <migraphx/iterator_for.hpp>
+#include <migraphx/register_op.hpp>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -29,6 +30,7 @@ struct cpu_literal
         return os;
     }
 };
+MIGRAPHX_REGISTER_OP(cpu_literal);
 
 void write_literals::apply(module& m) const
 {
@@ -36,7 +38,7 @@ void write_literals::apply(module& m) const
     {
         if(ins->name() != "@literal")
             continue;
-        m.replace_instruction(ins, cpu_literal{ins->get_literal().get_argument()});
+        m.replace_instruction(ins, cpu_literal{ins->get_literal().get_shared_argument()});
     }
 }
 
@@ -93,6 +93,7 @@ struct mlir_apply
             case shape::int64_type:
             case shape::uint32_type:
             case shape::uint64_type:
+            case shape::bf16_type:
             case shape::tuple_type: break;
             }
             return nullptr;
@@ -374,6 +374,7 @@ shape::type_t tf_parser::parse_type(const tensorflow::DataType t) const
     case tensorflow::DataType::DT_INT64: shape_type = shape::int64_type; break;
     case tensorflow::DataType::DT_UINT16: shape_type = shape::uint16_type; break;
     case tensorflow::DataType::DT_HALF: shape_type = shape::half_type; break;
+    case tensorflow::DataType::DT_BFLOAT16: shape_type = shape::bf16_type; break;
     case tensorflow::DataType::DT_UINT32: shape_type = shape::uint32_type; break;
     case tensorflow::DataType::DT_UINT64: shape_type = shape::uint64_type; break;
 
@@ -385,7 +386,6 @@ shape::type_t tf_parser::parse_type(const tensorflow::DataType t) const
     case tensorflow::DataType::DT_QINT8:
     case tensorflow::DataType::DT_QUINT8:
     case tensorflow::DataType::DT_QINT32:
-    case tensorflow::DataType::DT_BFLOAT16:
     case tensorflow::DataType::DT_QINT16:
     case tensorflow::DataType::DT_QUINT16:
     case tensorflow::DataType::DT_COMPLEX128:
@@ -438,6 +438,7 @@ literal tf_parser::parse_tensor(const tensorflow::TensorProto& t) const
         case tensorflow::DataType::DT_INT32: return literal{{shape::int32_type, dims}, s.data()};
         case tensorflow::DataType::DT_INT64: return literal{{shape::int64_type, dims}, s.data()};
         case tensorflow::DataType::DT_HALF: return literal{{shape::half_type, dims}, s.data()};
+        case tensorflow::DataType::DT_BFLOAT16: return literal{{shape::bf16_type, dims}, s.data()};
         case tensorflow::DataType::DT_DOUBLE: return literal{{shape::double_type, dims}, s.data()};
         case tensorflow::DataType::DT_INVALID:
         case tensorflow::DataType::DT_UINT8:
@@ -449,7 +450,6 @@ literal tf_parser::parse_tensor(const tensorflow::TensorProto& t) const
         case tensorflow::DataType::DT_QINT8:
         case tensorflow::DataType::DT_QUINT8:
         case tensorflow::DataType::DT_QINT32:
-        case tensorflow::DataType::DT_BFLOAT16:
         case tensorflow::DataType::DT_QINT16:
         case tensorflow::DataType::DT_QUINT16:
         case tensorflow::DataType::DT_RESOURCE:
@@ -0,0 +1,303 @@
+#include <migraphx/thread_pool.hpp>
+#include <migraphx/env.hpp>
+#include <migraphx/errors.hpp>
+#include <migraphx/stringutils.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_NUM_THREADS)
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_DISABLE_THREAD_PINNING)
+
+constexpr std::size_t thread_pool::any_node;
+
+// NOLINTNEXTLINE
+static thread_local thread_pool* current_pool = nullptr;
+// NOLINTNEXTLINE
+static thread_local std::size_t current_limit = 0;
+
+static std::vector<std::size_t> parse_cpu_list(const std::string& s)
+{
+    // The list looks like 0-3,8-11
+    std::vector<std::size_t> result;
+    for(auto&& r : split_string(trim(s), ','))
+    {
+        if(r.empty())
+            continue;
+        auto bounds = split_string(r, '-');
+        auto first  = std::stoul(bounds.front());
+        auto last   = std::stoul(bounds.back());
+        for(auto cpu = first; cpu <= last; cpu++)
+            result.push_back(cpu);
+    }
+    return result;
+}
+
+static std::vector<std::size_t> get_allowed_cpus()
+{
+    std::vector<std::size_t> result;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if(sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for(std::size_t cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if(CPU_ISSET(cpu, &set))
+                result.push_back(cpu);
+        }
+    }
+#endif
+    if(result.empty())
+    {
+        result.resize(std::max(std::thread::hardware_concurrency(), 1u));
+        std::iota(result.begin(), result.end(), 0);
+    }
+    return result;
+}
+
+std::vector<std::vector<std::size_t>> get_numa_cpus()
+{
+    auto allowed = get_allowed_cpus();
+    std::vector<std::vector<std::size_t>> result;
+    for(std::size_t node = 0;; node++)
+    {
+        std::ifstream is("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if(not is)
+            break;
+        std::string line;
+        std::getline(is, line);
+        auto cpus = parse_cpu_list(line);
+        cpus.erase(std::remove_if(cpus.begin(),
+                                  cpus.end(),
+                                  [&](auto cpu) {
+                                      return not std::binary_search(
+                                          allowed.begin(), allowed.end(), cpu);
+                                  }),
+                   cpus.end());
+        result.push_back(cpus);
+    }
+    // Without NUMA information every cpu is on one node
+    if(std::all_of(result.begin(), result.end(), [](const auto& cpus) { return cpus.empty(); }))
+        return {allowed};
+    return result;
+}
+
+static std::vector<std::size_t> get_pool_cpus(std::size_t node)
+{
+    auto nodes = get_numa_cpus();
+    if(node == thread_pool::any_node)
+    {
+        std::vector<std::size_t> result;
+        for(auto&& cpus : nodes)
+            result.insert(result.end(), cpus.begin(), cpus.end());
+        return result;
+    }
+    if(node >= nodes.size() or nodes[node].empty())
+        MIGRAPHX_THROW("No cpus available on NUMA node " + std::to_string(node));
+    return nodes[node];
+}
+
+static void pin_thread(std::thread& t, std::size_t cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    // Pinning is only a hint for performance, so a failure is ignored
+    pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#else
+    (void)t;
+    (void)cpu;
+#endif
+}
+
+struct parallel_job
+{
+    const std::function<void(std::size_t, std::size_t, std::size_t)>* f = nullptr;
+    std::size_t n                                                       = 0;
+    std::size_t chunk                                                   = 1;
+    std::size_t nthreads                                                = 1;
+    std::atomic<std::size_t> next{0};
+    // Guarded by the pool's mutex
+    std::size_t joined = 1;
+    std::size_t active = 0;
+    std::mutex m;
+    std::exception_ptr error;
+
+    void work(std::size_t tid)
+    {
+        for(;;)
+        {
+            auto start = next.fetch_add(chunk);
+            if(start >= n)
+                return;
+            try
+            {
+                (*f)(start, std::min(n, start + chunk), tid);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if(not error)
+                    error = std::current_exception();
+                // Skip the remaining chunks
+                next = n;
+            }
+        }
+    }
+};
+
+struct thread_pool_impl
+{
+    std::size_t size = 1;
+    std::size_t node = thread_pool::any_node;
+    std::vector<std::thread> workers;
+    std::mutex m;
+    std::condition_variable job_cv;
+    std::condition_variable done_cv;
+    std::deque<parallel_job*> jobs;
+    bool stop = false;
+
+    void work(thread_pool* pool)
+    {
+        current_pool = pool;
+        std::unique_lock<std::mutex> lock(m);
+        for(;;)
+        {
+            job_cv.wait(lock, [&] { return stop or not jobs.empty(); });
+            if(stop)
+                return;
+            auto* job = jobs.front();
+            auto tid  = job->joined++;
+            if(job->joined == job->nthreads)
+                jobs.pop_front();
+            job->active++;
+            lock.unlock();
+            job->work(tid);
+            lock.lock();
+            if(--job->active == 0)
+                done_cv.notify_all();
+        }
+    }
+};
+
+thread_pool::thread_pool(std::size_t n, std::size_t node)
+    : impl(std::make_unique<thread_pool_impl>())
+{
+    auto cpus  = get_pool_cpus(node);
+    impl->size = n == 0 ? cpus.size() : n;
+    impl->node = node;
+    bool pin   = not enabled(MIGRAPHX_DISABLE_THREAD_PINNING{}) and impl->size <= cpus.size();
+    // The caller is the first thread of every loop, so the workers start at
+    // the second cpu
+    for(std::size_t i = 1; i < impl->size; i++)
+    {
+        impl->workers.emplace_back([this] { impl->work(this); });
+        if(pin)
+            pin_thread(impl->workers.back(), cpus[i % cpus.size()]);
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(impl->m);
+        impl->stop = true;
+    }
+    impl->job_cv.notify_all();
+    for(auto& t : impl->workers)
+        t.join();
+}
+
+std::size_t thread_pool::size() const { return impl->size; }
+
+std::size_t thread_pool::node() const { return impl->node; }
+
+void thread_pool::run(std::size_t n,
+                      std::size_t grain,
+                      std::size_t nthreads,
+                      const std::function<void(std::size_t, std::size_t, std::size_t)>& f)
+{
+    if(n == 0)
+        return;
+    grain    = std::max<std::size_t>(grain, 1);
+    nthreads = std::min({nthreads, this->size(), (n + grain - 1) / grain});
+    if(nthreads <= 1)
+    {
+        f(0, n, 0);
+        return;
+    }
+    parallel_job job;
+    job.f        = &f;
+    job.n        = n;
+    job.nthreads = nthreads;
+    // Use a few chunks per thread so threads that finish early can take over
+    // the work of slower ones
+    job.chunk = std::max(grain, n / (nthreads * 4));
+    {
+        std::lock_guard<std::mutex> lock(impl->m);
+        impl->jobs.push_back(&job);
+    }
+    for(std::size_t i = 1; i < nthreads; i++)
+        impl->job_cv.notify_one();
+    job.work(0);
+    {
+        std::unique_lock<std::mutex> lock(impl->m);
+        auto it = std::find(impl->jobs.begin(), impl->jobs.end(), &job);
+        if(it != impl->jobs.end())
+            impl->jobs.erase(it);
+        impl->done_cv.wait(lock, [&] { return job.active == 0; });
+    }
+    if(job.error)
+        std::rethrow_exception(job.error);
+}
+
+thread_pool& default_thread_pool()
+{
+    static thread_pool pool{value_of(MIGRAPHX_NUM_THREADS{}, 0)}; // NOLINT
+    return pool;
+}
+
+thread_pool& current_thread_pool()
+{
+    if(current_pool == nullptr)
+        return default_thread_pool();
+    return *current_pool;
+}
+
+std::size_t current_thread_limit()
+{
+    if(current_limit == 0)
+        return current_thread_pool().size();
+    return current_limit;
+}
+
+thread_pool_scope::thread_pool_scope(thread_pool& p, std::size_t max_threads)
+    : prev_pool(current_pool), prev_limit(current_limit)
+{
+    current_pool  = &p;
+    current_limit = max_threads;
+}
+
+thread_pool_scope::~thread_pool_scope()
+{
+    current_pool  = prev_pool;
+    current_limit = prev_limit;
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
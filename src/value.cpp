@@ -10,6 +10,8 @@
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
+struct object_value_holder;
+
 struct value_base_impl : cloneable<value_base_impl>
 {
     virtual value::type_t get_type() { return value::null_type; }
@@ -17,12 +19,15 @@ struct value_base_impl : cloneable<value_base_impl>
     virtual const cpp_type* if_##vt() const { return nullptr; }
     MIGRAPHX_VISIT_VALUE_TYPES(MIGRAPHX_VALUE_GENERATE_BASE_FUNCTIONS)
     virtual std::vector<value>* if_array() { return nullptr; }
-    virtual std::unordered_map<std::string, std::size_t>* if_object() { return nullptr; }
+    virtual object_value_holder* if_object() { return nullptr; }
     virtual value_base_impl* if_value() const { return nullptr; }
-    value_base_impl()                       = default;
-    value_base_impl(const value_base_impl&) = default;
+    value_base_impl() = default;
+    // A clone has not returned any references yet
+    value_base_impl(const value_base_impl& rhs) : cloneable<value_base_impl>(rhs) {}
     value_base_impl& operator=(const value_base_impl&) = default;
     virtual ~value_base_impl() override {}
+    // Set once a non-const reference into an array or object has been returned
+    bool referenced = false;
 };
 
 #define MIGRAPHX_VALUE_GENERATE_BASE_TYPE(vt, cpp_type)                        \
@@ -46,19 +51,95 @@ struct array_value_holder : value_base_impl::derive<array_value_holder>
 
 struct object_value_holder : value_base_impl::derive<object_value_holder>
 {
+    // Most objects only have a few members, like the attributes of an operator, so the keys are
+    // only indexed for larger objects
+    static constexpr std::size_t lookup_threshold = 8;
+
     object_value_holder() {}
-    object_value_holder(std::vector<value> d, std::unordered_map<std::string, std::size_t> l)
-        : data(std::move(d)), lookup(std::move(l))
+    object_value_holder(std::vector<value> d) : data(std::move(d))
     {
+        if(data.size() > lookup_threshold)
+            build_lookup();
     }
     virtual value::type_t get_type() override { return value::object_type; }
     virtual std::vector<value>* if_array() override { return &data; }
-    virtual std::unordered_map<std::string, std::size_t>* if_object() override { return &lookup; }
+    virtual object_value_holder* if_object() override { return this; }
+
+    // Returns the index of the last member with the key, or the size when there is none
+    std::size_t find(const std::string& pkey) const
+    {
+        if(lookup.empty())
+        {
+            auto it = std::find_if(data.rbegin(), data.rend(), [&](const value& v) {
+                return v.get_key() == pkey;
+            });
+            if(it == data.rend())
+                return data.size();
+            return std::distance(it, data.rend()) - 1;
+        }
+        auto it = lookup.find(pkey);
+        if(it == lookup.end())
+            return data.size();
+        return it->second;
+    }
+
+    std::pair<std::size_t, bool> insert(const value& v)
+    {
+        auto i = find(v.get_key());
+        if(i != data.size())
+            return std::make_pair(i, false);
+        data.push_back(v);
+        if(not lookup.empty())
+            lookup.emplace(v.get_key(), i);
+        else if(data.size() > lookup_threshold)
+            build_lookup();
+        return std::make_pair(i, true);
+    }
+
+    void clear()
+    {
+        data.clear();
+        lookup.clear();
+    }
+
+    void build_lookup()
+    {
+        lookup.clear();
+        for(std::size_t i = 0; i < data.size(); i++)
+            lookup[data[i].get_key()] = i;
+    }
+
     std::vector<value> data;
     std::unordered_map<std::string, std::size_t> lookup;
 };
 
-value::value(const value& rhs) : x(rhs.x ? rhs.x->clone() : nullptr), key(rhs.key) {}
+constexpr std::size_t object_value_holder::lookup_threshold;
+
+// Arrays and objects are shared by copies of a value until one of the copies is modified, so
+// this needs to be called before any non-const access to the holder
+static void unshare(std::shared_ptr<value_base_impl>& x)
+{
+    if(x != nullptr and x.use_count() > 1)
+        x = x->clone();
+}
+
+// A reference into the holder can still be written through after the value is copied, so once
+// one has been returned the holder is cloned by every copy instead of being shared
+static void unshare_for_reference(std::shared_ptr<value_base_impl>& x)
+{
+    unshare(x);
+    if(x != nullptr and x->if_array() != nullptr)
+        x->referenced = true;
+}
+
+static std::shared_ptr<value_base_impl> share_holder(const std::shared_ptr<value_base_impl>& x)
+{
+    if(x != nullptr and x->referenced)
+        return x->clone();
+    return x;
+}
+
+value::value(const value& rhs) : x(share_holder(rhs.x)), key(rhs.key) {}
 value& value::operator=(value rhs)
 {
     std::swap(rhs.x, x);
@@ -85,14 +166,7 @@ void set_vector(std::shared_ptr<value_base_impl>& x,
     }
     else
     {
-        std::unordered_map<std::string, std::size_t> lookup;
-        std::size_t i = 0;
-        for(auto&& e : v)
-        {
-            lookup[e.get_key()] = i;
-            i++;
-        }
-        x = std::make_shared<object_value_holder>(v, lookup);
+        x = std::make_shared<object_value_holder>(v);
     }
 }
 
@@ -101,8 +175,7 @@ value::value(const std::initializer_list<value>& i) : x(nullptr)
     if(i.size() == 2 and i.begin()->is_string() and i.begin()->get_key().empty())
     {
         key    = i.begin()->get_string();
-        auto r = (i.begin() + 1)->x;
-        x      = r ? r->clone() : nullptr;
+        x      = (i.begin() + 1)->x;
         return;
     }
     set_vector(x, std::vector<value>(i.begin(), i.end()));
@@ -133,10 +206,7 @@ value::value(const std::string& pkey, std::nullptr_t) : x(nullptr), key(pkey) {}
 
 value::value(std::nullptr_t) : x(nullptr) {}
 
-value::value(const std::string& pkey, const value& rhs)
-    : x(rhs.x ? rhs.x->clone() : nullptr), key(pkey)
-{
-}
+value::value(const std::string& pkey, const value& rhs) : x(share_holder(rhs.x)), key(pkey) {}
 
 value::value(const char* i) : value(std::string(i)) {}
 
@@ -216,8 +286,9 @@ std::vector<value>& get_array_impl(const std::shared_ptr<value_base_impl>& x)
     return *a;
 }
 
-std::vector<value>& get_array_throw(const std::shared_ptr<value_base_impl>& x)
+std::vector<value>& get_array_throw(std::shared_ptr<value_base_impl>& x)
 {
+    unshare(x);
     auto* a = if_array_impl(x);
     if(a == nullptr)
         MIGRAPHX_THROW("Expected an array or object");
@@ -227,19 +298,22 @@ std::vector<value>& get_array_throw(const std::shared_ptr<value_base_impl>& x)
 template <class T>
 T* find_impl(const std::shared_ptr<value_base_impl>& x, const std::string& key, T* end)
 {
-    auto* a = if_array_impl(x);
-    if(a == nullptr)
+    if(x == nullptr)
         return end;
-    auto* lookup = x->if_object();
-    if(lookup == nullptr)
+    auto* obj = x->if_object();
+    if(obj == nullptr)
         return end;
-    auto it = lookup->find(key);
-    if(it == lookup->end())
+    auto i = obj->find(key);
+    if(i == obj->data.size())
         return end;
-    return std::addressof((*a)[it->second]);
+    return std::addressof(obj->data[i]);
 }
 
-value* value::find(const std::string& pkey) { return find_impl(x, pkey, this->end()); }
+value* value::find(const std::string& pkey)
+{
+    unshare_for_reference(x);
+    return find_impl(x, pkey, this->end());
+}
 
 const value* value::find(const std::string& pkey) const { return find_impl(x, pkey, this->end()); }
 bool value::contains(const std::string& pkey) const
@@ -268,6 +342,7 @@ const value* value::data() const
 }
 value* value::data()
 {
+    unshare_for_reference(x);
     auto* a = if_array_impl(x);
     if(a == nullptr)
         return nullptr;
@@ -309,6 +384,7 @@ const value& value::back() const
 }
 value& value::at(std::size_t i)
 {
+    unshare_for_reference(x);
     auto* a = if_array_impl(x);
     if(a == nullptr)
         MIGRAPHX_THROW("Not an array");
@@ -351,22 +427,32 @@ const value& value::operator[](std::size_t i) const
 }
 value& value::operator[](const std::string& pkey) { return *emplace(pkey, nullptr).first; }
 
-void value::clear() { get_array_throw(x).clear(); }
+void value::clear()
+{
+    auto& a = get_array_throw(x);
+    if(auto* obj = x->if_object())
+        obj->clear();
+    else
+        a.clear();
+}
 void value::resize(std::size_t n)
 {
     if(not is_array())
         MIGRAPHX_THROW("Expected an array.");
+    unshare(x);
     get_array_impl(x).resize(n);
 }
 void value::resize(std::size_t n, const value& v)
 {
     if(not is_array())
         MIGRAPHX_THROW("Expected an array.");
+    unshare(x);
     get_array_impl(x).resize(n, v);
 }
 
 std::pair<value*, bool> value::insert(const value& v)
 {
+    unshare_for_reference(x);
     if(v.key.empty())
     {
         if(!x)
@@ -379,16 +465,18 @@ std::pair<value*, bool> value::insert(const value& v)
     {
         if(!x)
             x = std::make_shared<object_value_holder>();
-        auto p = x->if_object()->emplace(v.key, get_array_impl(x).size());
-        if(p.second)
-            get_array_impl(x).push_back(v);
+        auto* obj = x->if_object();
+        if(obj == nullptr)
+            MIGRAPHX_THROW("Expected an object");
+        auto p = obj->insert(v);
         assert(this->if_object());
-        return std::make_pair(&get_array_impl(x)[p.first->second], p.second);
+        return std::make_pair(&obj->data[p.first], p.second);
     }
 }
 value* value::insert(const value* pos, const value& v)
 {
     assert(v.key.empty());
+    unshare_for_reference(x);
     if(!x)
         x = std::make_shared<array_value_holder>();
     auto&& a = get_array_impl(x);
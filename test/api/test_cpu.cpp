@@ -41,6 +41,25 @@ TEST_CASE(load_and_run_init_list)
     CHECK(bool{shapes_before.front() == outputs.front().get_shape()});
 }
 
+TEST_CASE(load_and_run_session)
+{
+    auto p = migraphx::parse_onnx("conv_relu_maxpool_test.onnx");
+    p.compile(migraphx::target("ref"));
+    migraphx::program_parameters pp;
+    auto param_shapes = p.get_parameter_shapes();
+    for(auto&& name : param_shapes.names())
+    {
+        pp.add(name, migraphx::argument::generate(param_shapes[name]));
+    }
+    auto expected = p.eval(pp);
+    migraphx::session s1{p};
+    migraphx::session s2{p};
+    auto outputs1 = s1.eval(pp);
+    auto outputs2 = s2.eval(pp);
+    CHECK(bool{outputs1.front() == expected.front()});
+    CHECK(bool{outputs2.front() == expected.front()});
+}
+
 TEST_CASE(quantize_fp16)
 {
     auto p1        = migraphx::parse_onnx("gemm_ex_test.onnx");
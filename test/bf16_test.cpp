@@ -0,0 +1,56 @@
+#include <migraphx/bf16.hpp>
+#include <migraphx/literal.hpp>
+#include <migraphx/shape.hpp>
+#include <cmath>
+#include <limits>
+#include "test.hpp"
+
+TEST_CASE(bf16_round_trip)
+{
+    for(float f : {0.0f, 1.0f, -2.5f, 0.15625f, 256.0f, -1024.0f})
+        EXPECT(float(migraphx::bf16(f)) == f);
+}
+
+TEST_CASE(bf16_round_to_nearest_even)
+{
+    // 1 + 2^-8 is halfway between 1 and 1 + 2^-7, so it rounds to the even 1
+    EXPECT(float(migraphx::bf16(1.00390625f)) == 1.0f);
+    // 1 + 3 * 2^-8 is halfway between 1 + 2^-7 and 1 + 2^-6, so it rounds to the even 1 + 2^-6
+    EXPECT(float(migraphx::bf16(1.01171875f)) == 1.015625f);
+    EXPECT(float(migraphx::bf16(1.005f)) == 1.0078125f);
+}
+
+TEST_CASE(bf16_special_values)
+{
+    auto inf = std::numeric_limits<float>::infinity();
+    EXPECT(std::isinf(float(migraphx::bf16(inf))));
+    EXPECT(std::isinf(float(migraphx::bf16(-inf))));
+    EXPECT(std::isnan(float(migraphx::bf16(std::numeric_limits<float>::quiet_NaN()))));
+    // A nan with only low mantissa bits stays a nan instead of rounding to inf
+    EXPECT(std::isnan(float(migraphx::bf16(std::nanf("1")))));
+    // Values past the largest bf16 round to inf
+    EXPECT(std::isinf(float(migraphx::bf16(std::numeric_limits<float>::max()))));
+}
+
+TEST_CASE(bf16_limits)
+{
+    using limits = std::numeric_limits<migraphx::bf16>;
+    EXPECT(float(limits::max()) == 0x1.fep127f);
+    EXPECT(float(limits::lowest()) == -0x1.fep127f);
+    EXPECT(float(limits::min()) == std::numeric_limits<float>::min());
+    EXPECT(float(limits::epsilon()) == 0x1p-7f);
+    EXPECT(std::isinf(float(limits::infinity())));
+    EXPECT(std::isnan(float(limits::quiet_NaN())));
+}
+
+TEST_CASE(bf16_literal)
+{
+    migraphx::shape s{migraphx::shape::bf16_type, {3}};
+    EXPECT(s.type_size() == 2);
+    migraphx::literal l{s, {1.0f, -0.5f, 3.0f}};
+    EXPECT(l.at<float>(0) == 1.0f);
+    EXPECT(l.at<float>(1) == -0.5f);
+    EXPECT(l.at<float>(2) == 3.0f);
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -0,0 +1,174 @@
+#include <migraphx/bucketed_program.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/ref/target.hpp>
+#include <migraphx/tmp_dir.hpp>
+#include "test.hpp"
+
+using input_dims = std::unordered_map<std::string, std::vector<std::size_t>>;
+
+struct counted_factory
+{
+    std::shared_ptr<std::size_t> count = std::make_shared<std::size_t>(0);
+    unsigned long seed                 = 1;
+
+    migraphx::program operator()(const input_dims& dims) const
+    {
+        (*count)++;
+        std::vector<std::size_t> lens = {1, 1, 4};
+        if(dims.count("x") > 0)
+            lens = dims.at("x");
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        migraphx::shape ws{migraphx::shape::float_type, {4}};
+        auto x = mm->add_parameter("x", {migraphx::shape::float_type, lens});
+        auto w = mm->add_literal(migraphx::generate_literal(ws, seed));
+        auto wb =
+            mm->add_instruction(migraphx::make_op("multibroadcast", {{"out_lens", lens}}), w);
+        auto mul = mm->add_instruction(migraphx::make_op("mul"), x, wb);
+        auto sum = mm->add_instruction(migraphx::make_op("reduce_sum", {{"axes", {1}}}), mul);
+        mm->add_return({mul, sum});
+        return p;
+    }
+};
+
+migraphx::bucket_options create_options()
+{
+    migraphx::bucket_options options;
+    options.buckets        = {{"batch", {4, 1}}, {"seq", {8, 16}}};
+    options.parameter_dims = {{"x", {"batch", "seq", ""}}};
+    options.output_dims    = {{"batch", "seq", ""}, {"batch", "", ""}};
+    return options;
+}
+
+std::vector<migraphx::argument> run_unbucketed(const migraphx::argument& x)
+{
+    auto p = counted_factory{}({{"x", x.get_shape().lens()}});
+    p.compile(migraphx::ref::target{});
+    return p.eval({{"x", x}});
+}
+
+std::vector<const char*> get_literal_data(const migraphx::program& p)
+{
+    std::vector<const char*> result;
+    for(auto ins : iterator_for(*p.get_main_module()))
+    {
+        if(ins->name() == "@literal")
+            result.push_back(ins->get_literal().data());
+    }
+    return result;
+}
+
+TEST_CASE(find_bucket)
+{
+    migraphx::bucketed_program bp{counted_factory{}, migraphx::ref::target{}, create_options()};
+    EXPECT(bp.get_buckets().size() == 4);
+    using dim_map = migraphx::bucketed_program::dim_map;
+    EXPECT(bool{bp.find_bucket({{"batch", 1}, {"seq", 3}}) == dim_map{{"batch", 1}, {"seq", 8}}});
+    EXPECT(bool{bp.find_bucket({{"batch", 2}, {"seq", 9}}) == dim_map{{"batch", 4}, {"seq", 16}}});
+    EXPECT(bool{bp.find_bucket({{"batch", 4}, {"seq", 16}}) == dim_map{{"batch", 4}, {"seq", 16}}});
+    EXPECT(test::throws([&] { bp.find_bucket({{"batch", 1}, {"seq", 17}}); }));
+}
+
+TEST_CASE(pad_and_slice)
+{
+    migraphx::bucketed_program bp{counted_factory{}, migraphx::ref::target{}, create_options()};
+    for(auto lens : {std::vector<std::size_t>{1, 3, 4},
+                     std::vector<std::size_t>{3, 8, 4},
+                     std::vector<std::size_t>{2, 13, 4},
+                     std::vector<std::size_t>{4, 16, 4}})
+    {
+        auto x        = migraphx::generate_argument({migraphx::shape::float_type, lens});
+        auto results  = bp.eval({{"x", x}});
+        auto expected = run_unbucketed(x);
+        EXPECT(results.size() == 2);
+        EXPECT(results.front().get_shape().lens() == lens);
+        EXPECT(results.front() == expected.front());
+        EXPECT(results.back().get_shape().lens() == expected.back().get_shape().lens());
+        EXPECT(results.back() == expected.back());
+    }
+}
+
+TEST_CASE(shared_literals)
+{
+    migraphx::bucketed_program bp{counted_factory{}, migraphx::ref::target{}, create_options()};
+    auto buckets = bp.get_buckets();
+    auto first   = get_literal_data(bp.get_program(buckets.front()));
+    EXPECT(first.size() == 1);
+    for(auto&& bucket : buckets)
+        EXPECT(get_literal_data(bp.get_program(bucket)) == first);
+}
+
+TEST_CASE(lazy_compile)
+{
+    counted_factory f;
+    auto options = create_options();
+    options.lazy = true;
+    migraphx::bucketed_program bp{f, migraphx::ref::target{}, options};
+    EXPECT(*f.count == 1);
+    auto x = migraphx::generate_argument({migraphx::shape::float_type, {1, 5, 4}});
+    bp.eval({{"x", x}});
+    bp.eval({{"x", x}});
+    EXPECT(*f.count == 2);
+    EXPECT(test::throws([&] { bp.get_program({{"batch", 2}, {"seq", 8}}); }));
+}
+
+TEST_CASE(cache_dir)
+{
+    migraphx::tmp_dir td{"bucketed_program"};
+    auto options      = create_options();
+    options.cache_dir = (td.path / "cache").string();
+    auto x = migraphx::generate_argument({migraphx::shape::float_type, {2, 10, 4}});
+    std::vector<migraphx::argument> expected;
+    {
+        migraphx::bucketed_program bp{counted_factory{}, migraphx::ref::target{}, options};
+        expected = bp.eval({{"x", x}});
+    }
+    counted_factory f;
+    options.lazy = true;
+    migraphx::bucketed_program bp{f, migraphx::ref::target{}, options};
+    auto results = bp.eval({{"x", x}});
+    // Only called to find the parameter shapes, the bucket is loaded from the cache
+    EXPECT(*f.count == 1);
+    EXPECT(results == expected);
+}
+
+TEST_CASE(cache_dir_other_model)
+{
+    migraphx::tmp_dir td{"bucketed_program"};
+    auto options      = create_options();
+    options.cache_dir = (td.path / "cache").string();
+    options.lazy      = true;
+    auto x = migraphx::generate_argument({migraphx::shape::float_type, {2, 10, 4}});
+    {
+        migraphx::bucketed_program bp{counted_factory{}, migraphx::ref::target{}, options};
+        bp.eval({{"x", x}});
+    }
+    // Different weights are a different model, so the cached bucket is not used
+    counted_factory f;
+    f.seed = 2;
+    migraphx::bucketed_program bp{f, migraphx::ref::target{}, options};
+    auto results = bp.eval({{"x", x}});
+    EXPECT(*f.count == 2);
+    migraphx::bucketed_program uncached{f, migraphx::ref::target{}, create_options()};
+    EXPECT(results == uncached.eval({{"x", x}}));
+
+    // As are different compile options
+    counted_factory g;
+    options.options.fast_math = false;
+    migraphx::bucketed_program bp2{g, migraphx::ref::target{}, options};
+    bp2.eval({{"x", x}});
+    EXPECT(*g.count == 2);
+}
+
+TEST_CASE(fixed_axis)
+{
+    migraphx::bucketed_program bp{counted_factory{}, migraphx::ref::target{}, create_options()};
+    auto x = migraphx::generate_argument({migraphx::shape::float_type, {2, 10, 5}});
+    EXPECT(test::throws([&] { bp.eval({{"x", x}}); }));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -0,0 +1,89 @@
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/register_target.hpp>
+#include <migraphx/ref/target.hpp>
+#include <migraphx/verify.hpp>
+#include <pointwise.hpp>
+#include <test.hpp>
+#include <algorithm>
+
+migraphx::program create_program(const std::vector<migraphx::shape>& inputs)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    std::vector<migraphx::instruction_ref> params;
+    for(const auto& s : inputs)
+        params.push_back(mm->add_parameter("x" + std::to_string(params.size()), s));
+    auto r = add_pointwise(p, "main:pointwise0", params, [](auto* pm, const auto& xs) {
+        auto half = pm->add_literal(migraphx::literal{migraphx::shape{xs[0]->get_shape().type()},
+                                                      {0.5}});
+        auto mul  = pm->add_instruction(migraphx::make_op("mul"), xs[0], half);
+        auto tanh = pm->add_instruction(migraphx::make_op("tanh"), mul);
+        auto sum  = tanh;
+        for(auto it = xs.begin() + 1; it != xs.end(); ++it)
+            sum = pm->add_instruction(migraphx::make_op("add"), sum, *it);
+        return pm->add_instruction(migraphx::make_op("relu"), sum);
+    });
+    mm->add_return({r});
+    return p;
+}
+
+std::vector<float> run(migraphx::program p, const migraphx::target& t)
+{
+    p.compile(t);
+    migraphx::parameter_map m;
+    for(auto&& x : p.get_parameter_shapes())
+        m[x.first] = migraphx::generate_argument(x.second, std::hash<std::string>{}(x.first));
+    std::vector<float> result;
+    p.eval(m).back().visit([&](auto v) { result.assign(v.begin(), v.end()); });
+    return result;
+}
+
+bool verify_pointwise(const std::vector<migraphx::shape>& inputs)
+{
+    auto p = create_program(inputs);
+    return migraphx::verify_range(run(p, migraphx::make_target("cpu")),
+                                  run(p, migraphx::ref::target{}));
+}
+
+TEST_CASE(pointwise_compiled)
+{
+    migraphx::shape s{migraphx::shape::float_type, {2, 3}};
+    auto p = create_program({s, s});
+    p.compile(migraphx::make_target("cpu"));
+    auto* mm = p.get_main_module();
+    EXPECT(std::any_of(
+        mm->begin(), mm->end(), [](const auto& ins) { return ins.name() == "cpu::pointwise"; }));
+}
+
+TEST_CASE(pointwise_standard)
+{
+    migraphx::shape s{migraphx::shape::float_type, {2, 3, 4, 5}};
+    EXPECT(verify_pointwise({s, s}));
+}
+
+TEST_CASE(pointwise_broadcast)
+{
+    migraphx::shape s1{migraphx::shape::float_type, {2, 3, 4, 5}};
+    migraphx::shape s2{migraphx::shape::float_type, {2, 3, 4, 5}, {0, 1, 0, 0}};
+    EXPECT(verify_pointwise({s1, s2}));
+}
+
+TEST_CASE(pointwise_transposed)
+{
+    migraphx::shape s1{migraphx::shape::float_type, {2, 3, 4, 5}, {60, 1, 15, 3}};
+    migraphx::shape s2{migraphx::shape::float_type, {2, 3, 4, 5}};
+    migraphx::shape s3{migraphx::shape::float_type, {2, 3, 4, 5}, {0, 0, 0, 1}};
+    EXPECT(verify_pointwise({s1, s2, s3}));
+}
+
+TEST_CASE(pointwise_int8)
+{
+    migraphx::shape s{migraphx::shape::int8_type, {37}};
+    EXPECT(verify_pointwise({s, s}));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -0,0 +1,68 @@
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/load_save.hpp>
+#include <migraphx/register_target.hpp>
+#include <migraphx/ref/target.hpp>
+#include <migraphx/verify.hpp>
+#include <test.hpp>
+#include <algorithm>
+
+migraphx::program create_program()
+{
+    migraphx::program p;
+    auto* mm  = p.get_main_module();
+    auto conv = migraphx::make_op("convolution", {{"padding", {1, 1}}});
+    migraphx::shape ws{migraphx::shape::float_type, {8, 8, 3, 3}};
+    migraphx::shape ds{migraphx::shape::float_type, {8 * 16 * 16, 16}};
+    auto x     = mm->add_parameter("x", {migraphx::shape::float_type, {1, 8, 16, 16}});
+    auto w     = mm->add_literal(migraphx::generate_literal(ws, 1));
+    auto d     = mm->add_literal(migraphx::generate_literal(ds, 2));
+    auto conv1 = mm->add_instruction(conv, x, w);
+    auto relu  = mm->add_instruction(migraphx::make_op("relu"), conv1);
+    auto conv2 = mm->add_instruction(conv, relu, w);
+    auto flat =
+        mm->add_instruction(migraphx::make_op("reshape", {{"dims", {1, 8 * 16 * 16}}}), conv2);
+    auto dot = mm->add_instruction(migraphx::make_op("dot"), flat, d);
+    mm->add_return({dot});
+    return p;
+}
+
+std::vector<float> run(const migraphx::program& p, const migraphx::argument& x)
+{
+    std::vector<float> result;
+    p.eval({{"x", x}}).back().visit([&](auto v) { result.assign(v.begin(), v.end()); });
+    return result;
+}
+
+TEST_CASE(prepack_shared_weights)
+{
+    auto p = create_program();
+    auto r = create_program();
+    p.compile(migraphx::make_target("cpu"));
+    r.compile(migraphx::ref::target{});
+    auto* mm    = p.get_main_module();
+    // The dot weights can be packed too, so only count the packs used by the convolutions
+    auto npacks = std::count_if(mm->begin(), mm->end(), [](const auto& ins) {
+        return ins.name() == "cpu::packed_literal" and
+               std::any_of(ins.outputs().begin(), ins.outputs().end(), [](auto output) {
+                   return output->name() == "dnnl::convolution";
+               });
+    });
+    // Both convolutions use the same weights in the same layout, so they share one copy
+    EXPECT(npacks == 1);
+    auto x = migraphx::generate_argument(p.get_parameter_shape("x"));
+    EXPECT(migraphx::verify_range(run(p, x), run(r, x)));
+}
+
+TEST_CASE(prepack_save_load)
+{
+    auto p = create_program();
+    p.compile(migraphx::make_target("cpu"));
+    auto x      = migraphx::generate_argument(p.get_parameter_shape("x"));
+    auto loaded = migraphx::load_buffer(migraphx::save_buffer(p));
+    EXPECT(migraphx::verify_range(run(loaded, x), run(p, x)));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -0,0 +1,94 @@
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/register_target.hpp>
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/ref/target.hpp>
+#include <migraphx/verify.hpp>
+#include <test.hpp>
+#include <algorithm>
+
+// The cpu target with several streams, the default context only uses one unless
+// MIGRAPHX_CPU_INTER_OP_THREADS is set
+struct multi_stream_target
+{
+    migraphx::target t = migraphx::make_target("cpu");
+
+    std::string name() const { return t.name(); }
+    std::vector<migraphx::pass> get_passes(migraphx::context& ctx,
+                                           const migraphx::compile_options& options) const
+    {
+        return t.get_passes(ctx, options);
+    }
+    migraphx::context get_context() const { return migraphx::cpu::context{4, 1}; }
+    migraphx::argument allocate(const migraphx::shape& s) const { return t.allocate(s); }
+};
+
+migraphx::program create_program()
+{
+    migraphx::program p;
+    auto* mm  = p.get_main_module();
+    auto conv = migraphx::make_op("convolution", {{"padding", {1, 1}}});
+    migraphx::shape ws{migraphx::shape::float_type, {8, 8, 3, 3}};
+    auto x = mm->add_parameter("x", {migraphx::shape::float_type, {1, 8, 16, 16}});
+    // Independent branches that can run on separate streams
+    std::vector<migraphx::instruction_ref> branches;
+    for(std::size_t i = 0; i < 4; i++)
+    {
+        auto w     = mm->add_literal(migraphx::generate_literal(ws, i));
+        auto conv1 = mm->add_instruction(conv, x, w);
+        auto relu  = mm->add_instruction(migraphx::make_op("relu"), conv1);
+        branches.push_back(mm->add_instruction(conv, relu, w));
+    }
+    auto sum = branches.front();
+    for(auto it = branches.begin() + 1; it != branches.end(); ++it)
+        sum = mm->add_instruction(migraphx::make_op("add"), sum, *it);
+    mm->add_return({sum});
+    return p;
+}
+
+std::vector<float> run(const migraphx::program& p, const migraphx::argument& x)
+{
+    std::vector<float> result;
+    p.eval({{"x", x}}).back().visit([&](auto v) { result.assign(v.begin(), v.end()); });
+    return result;
+}
+
+TEST_CASE(multi_stream)
+{
+    auto p = create_program();
+    auto r = create_program();
+    p.compile(multi_stream_target{});
+    r.compile(migraphx::ref::target{});
+    auto* mm = p.get_main_module();
+    EXPECT(std::any_of(
+        mm->begin(), mm->end(), [](const auto& ins) { return ins.name() == "cpu::set_stream"; }));
+    // The main module has no return, but the streams are still finished before it ends
+    auto finish = std::find_if(mm->begin(), mm->end(), [](const auto& ins) {
+        return ins.name() == "cpu::finish_streams";
+    });
+    EXPECT(bool{finish != mm->end()});
+    EXPECT(std::none_of(
+        finish, mm->end(), [](const auto& ins) { return ins.name() == "cpu::async"; }));
+    // Run several times so a missing wait is more likely to show up
+    for(std::size_t i = 0; i < 8; i++)
+    {
+        auto x = migraphx::generate_argument(p.get_parameter_shape("x"), i);
+        EXPECT(migraphx::verify_range(run(p, x), run(r, x)));
+    }
+}
+
+TEST_CASE(context_copy)
+{
+    migraphx::cpu::context ctx{2, 1};
+    migraphx::shape s{migraphx::shape::float_type, {16}};
+    auto a    = ctx.get_preallocation("scratch", s);
+    auto copy = ctx;
+    // Copies dont share streams or scratch memory, so they can run at the same time
+    EXPECT(copy.nstreams() == 2);
+    EXPECT(copy.get_preallocation("scratch", s).data() != a.data());
+    EXPECT(ctx.get_preallocation("scratch", s).data() == a.data());
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
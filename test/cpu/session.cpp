@@ -0,0 +1,67 @@
+#include <migraphx/session.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/register_target.hpp>
+#include <migraphx/ref/target.hpp>
+#include <migraphx/verify.hpp>
+#include <test.hpp>
+#include <thread>
+
+migraphx::program create_program()
+{
+    migraphx::program p;
+    auto* mm  = p.get_main_module();
+    auto conv = migraphx::make_op("convolution", {{"padding", {1, 1}}});
+    migraphx::shape ws{migraphx::shape::float_type, {8, 8, 3, 3}};
+    auto x     = mm->add_parameter("x", {migraphx::shape::float_type, {1, 8, 16, 16}});
+    auto w     = mm->add_literal(migraphx::generate_literal(ws, 1));
+    auto conv1 = mm->add_instruction(conv, x, w);
+    auto relu  = mm->add_instruction(migraphx::make_op("relu"), conv1);
+    auto conv2 = mm->add_instruction(conv, relu, w);
+    mm->add_instruction(migraphx::make_op("add"), conv2, x);
+    return p;
+}
+
+std::vector<float> to_vector(const migraphx::argument& arg)
+{
+    std::vector<float> result;
+    arg.visit([&](auto v) { result.assign(v.begin(), v.end()); });
+    return result;
+}
+
+TEST_CASE(session_concurrent)
+{
+    auto p = create_program();
+    auto r = create_program();
+    p.compile(migraphx::make_target("cpu"));
+    r.compile(migraphx::ref::target{});
+    auto s = p.get_parameter_shape("x");
+    std::vector<migraphx::argument> inputs;
+    std::vector<std::vector<float>> expected;
+    for(std::size_t i = 0; i < 4; i++)
+    {
+        inputs.push_back(migraphx::generate_argument(s, i));
+        expected.push_back(to_vector(r.eval({{"x", inputs.back()}}).back()));
+    }
+    // Each session uses its own scratch memory, so the results of one thread are not overwritten by
+    // the others
+    std::vector<int> matches(inputs.size(), 0);
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0; i < inputs.size(); i++)
+    {
+        threads.emplace_back([&, i] {
+            migraphx::session session{p};
+            for(int n = 0; n < 20; n++)
+            {
+                auto result = to_vector(session.eval({{"x", inputs[i]}}).back());
+                matches[i] += migraphx::verify_range(result, expected[i]) ? 1 : 0;
+            }
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    EXPECT(std::all_of(matches.begin(), matches.end(), [](int n) { return n == 20; }));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -0,0 +1,90 @@
+#include <migraphx/cpu/task_pool.hpp>
+#include <test.hpp>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE(task_pool_dependencies)
+{
+    migraphx::cpu::task_pool pool{4};
+    std::mutex m;
+    std::vector<int> order;
+    auto record = [&](int i) {
+        return [&, i] {
+            std::lock_guard<std::mutex> lock(m);
+            order.push_back(i);
+        };
+    };
+    // A diamond: 0 runs first, then 1 and 2 in any order, then 3
+    auto t0 = pool.add(record(0));
+    auto t1 = pool.add(record(1), {t0});
+    auto t2 = pool.add(record(2), {t0});
+    auto t3 = pool.add(record(3), {t1, t2});
+    t3->wait();
+    EXPECT(order.size() == 4);
+    EXPECT(order.front() == 0);
+    EXPECT(order.back() == 3);
+}
+
+TEST_CASE(task_pool_finished_dependency)
+{
+    migraphx::cpu::task_pool pool{2};
+    std::atomic<int> n{0};
+    auto t0 = pool.add([&] { n++; });
+    t0->wait();
+    // Depending on a task that already finished, or on no task, runs right away
+    auto t1 = pool.add([&] { n++; }, {t0, nullptr});
+    t1->wait();
+    EXPECT(n == 2);
+}
+
+TEST_CASE(task_pool_wait_all)
+{
+    migraphx::cpu::task_pool pool{3};
+    std::atomic<std::size_t> n{0};
+    migraphx::cpu::task_ref last = nullptr;
+    for(std::size_t i = 0; i < 1000; i++)
+    {
+        // Chain every other task to the previous one
+        if(i % 2 == 0)
+            last = pool.add([&] { n++; }, {last});
+        else
+            pool.add([&] { n++; });
+    }
+    pool.wait_all();
+    EXPECT(n == 1000);
+}
+
+TEST_CASE(task_pool_nested_add)
+{
+    migraphx::cpu::task_pool pool{2};
+    std::atomic<int> n{0};
+    migraphx::cpu::task_ref inner = nullptr;
+    // Tasks added from a worker go to the worker's own queue
+    auto outer = pool.add([&] { inner = pool.add([&] { n++; }); });
+    outer->wait();
+    inner->wait();
+    EXPECT(n == 1);
+}
+
+TEST_CASE(task_pool_exception)
+{
+    migraphx::cpu::task_pool pool{2};
+    auto t0 = pool.add([] { throw std::runtime_error("task failed"); });
+    std::atomic<bool> ran{false};
+    auto t1 = pool.add([&] { ran = true; }, {t0});
+    EXPECT(test::throws([&] { t0->wait(); }));
+    // The tasks that depend on it fail with the same error without running
+    EXPECT(test::throws<std::runtime_error>([&] { t1->wait(); }, "task failed"));
+    auto t2 = pool.add([&] { ran = true; }, {t1});
+    EXPECT(test::throws<std::runtime_error>([&] { t2->wait(); }, "task failed"));
+    EXPECT(not ran);
+    // Tasks that dont depend on it still run
+    auto t3 = pool.add([&] { ran = true; });
+    t3->wait();
+    EXPECT(ran);
+    pool.wait_all();
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -0,0 +1,120 @@
+#include <batcher.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/ref/target.hpp>
+#include <test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <numeric>
+
+// y = x + bias, where only x and y have the batch as their first dimension
+migraphx::program create_program(std::size_t batch)
+{
+    migraphx::program p;
+    auto* mm  = p.get_main_module();
+    auto x    = mm->add_parameter("x", {migraphx::shape::float_type, {batch, 3}});
+    auto bias = mm->add_parameter("bias", {migraphx::shape::float_type, {3}});
+    auto b    = mm->add_instruction(
+        migraphx::make_op("multibroadcast", {{"out_lens", {batch, 3}}}), bias);
+    auto y = mm->add_instruction(migraphx::make_op("add"), x, b);
+    mm->add_return({y, bias});
+    p.compile(migraphx::ref::target{});
+    return p;
+}
+
+std::map<std::size_t, migraphx::program> create_programs()
+{
+    std::map<std::size_t, migraphx::program> programs;
+    for(std::size_t batch : {1, 2, 4})
+        programs[batch] = create_program(batch);
+    return programs;
+}
+
+struct request_data
+{
+    std::vector<float> x;
+    std::vector<float> bias = {100, 200, 300};
+
+    explicit request_data(std::size_t i) : x(3) { std::iota(x.begin(), x.end(), 3 * i); }
+
+    migraphx::parameter_map params()
+    {
+        migraphx::parameter_map result;
+        result["x"]    = migraphx::argument{{migraphx::shape::float_type, {1, 3}}, x.data()};
+        result["bias"] = migraphx::argument{{migraphx::shape::float_type, {3}}, bias.data()};
+        return result;
+    }
+
+    bool check(const std::vector<migraphx::argument>& results) const
+    {
+        if(results.size() != 2)
+            return false;
+        std::vector<float> y;
+        results[0].visit([&](auto v) { y.assign(v.begin(), v.end()); });
+        std::vector<float> b;
+        results[1].visit([&](auto v) { b.assign(v.begin(), v.end()); });
+        std::vector<float> expected(3);
+        std::transform(x.begin(), x.end(), bias.begin(), expected.begin(), std::plus<>{});
+        return results[0].get_shape().lens() == std::vector<std::size_t>{1, 3} and
+               y == expected and b == bias;
+    }
+};
+
+void run(migraphx::driver::batcher& b, std::size_t n)
+{
+    std::vector<request_data> requests;
+    for(std::size_t i = 0; i < n; i++)
+        requests.emplace_back(i);
+    std::vector<std::future<std::vector<migraphx::argument>>> futures;
+    for(auto& r : requests)
+        futures.push_back(b.submit(r.params()));
+    // The delay is long enough that the requests wait in the queue until the batcher is stopped
+    b.stop();
+    for(std::size_t i = 0; i < n; i++)
+        EXPECT(requests[i].check(futures[i].get()));
+}
+
+TEST_CASE(batcher_request_shapes)
+{
+    migraphx::driver::batcher b{create_programs(), std::chrono::seconds{10}};
+    auto shapes = b.get_request_shapes();
+    EXPECT(shapes.at("x") == migraphx::shape{migraphx::shape::float_type, {1, 3}});
+    EXPECT(shapes.at("bias") == migraphx::shape{migraphx::shape::float_type, {3}});
+}
+
+TEST_CASE(batcher_partial_batch)
+{
+    migraphx::driver::batcher b{create_programs(), std::chrono::seconds{10}};
+    run(b, 3);
+    auto stats = b.get_stats();
+    // Three requests run with the program for four, with one padded row
+    EXPECT(stats.batches.size() == 1);
+    EXPECT(stats.batches.at(4) == 1);
+    EXPECT(stats.padding == 1);
+    EXPECT(stats.latencies_ms.size() == 3);
+}
+
+TEST_CASE(batcher_full_batch)
+{
+    migraphx::driver::batcher b{create_programs(), std::chrono::seconds{10}};
+    run(b, 5);
+    auto stats = b.get_stats();
+    // A full batch runs as soon as it is queued, the last request runs alone
+    EXPECT(stats.batches.at(4) == 1);
+    EXPECT(stats.batches.at(1) == 1);
+    EXPECT(stats.padding == 0);
+}
+
+TEST_CASE(batcher_workers)
+{
+    migraphx::driver::batcher b{create_programs(), std::chrono::seconds{10}, 2};
+    run(b, 11);
+    auto stats = b.get_stats();
+    auto rows  = std::accumulate(stats.batches.begin(),
+                                stats.batches.end(),
+                                std::size_t{0},
+                                [](auto n, auto&& pp) { return n + pp.first * pp.second; });
+    EXPECT(rows == 11 + stats.padding);
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
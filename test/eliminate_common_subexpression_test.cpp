@@ -142,4 +142,76 @@ TEST_CASE(cse_test_literal)
     EXPECT(m1 == m2);
 }
 
+TEST_CASE(cse_test_attributes)
+{
+    migraphx::shape s{migraphx::shape::float_type, {4, 4}};
+    migraphx::module m1;
+    {
+        auto x      = m1.add_parameter("x", s);
+        auto slice1 = m1.add_instruction(
+            migraphx::make_op("slice", {{"axes", {0}}, {"starts", {0}}, {"ends", {2}}}), x);
+        auto slice2 = m1.add_instruction(
+            migraphx::make_op("slice", {{"axes", {0}}, {"starts", {2}}, {"ends", {4}}}), x);
+        auto slice3 = m1.add_instruction(
+            migraphx::make_op("slice", {{"axes", {0}}, {"starts", {0}}, {"ends", {2}}}), x);
+        auto sum1 = m1.add_instruction(migraphx::make_op("add"), slice1, slice2);
+        auto sum2 = m1.add_instruction(migraphx::make_op("add"), slice3, slice2);
+        auto sum3 = m1.add_instruction(migraphx::make_op("add"), sum1, sum2);
+        m1.add_instruction(pass_op{}, sum3);
+    }
+    run_pass(m1);
+
+    migraphx::module m2;
+    {
+        auto x      = m2.add_parameter("x", s);
+        auto slice1 = m2.add_instruction(
+            migraphx::make_op("slice", {{"axes", {0}}, {"starts", {0}}, {"ends", {2}}}), x);
+        auto slice2 = m2.add_instruction(
+            migraphx::make_op("slice", {{"axes", {0}}, {"starts", {2}}, {"ends", {4}}}), x);
+        auto sum1 = m2.add_instruction(migraphx::make_op("add"), slice1, slice2);
+        auto sum3 = m2.add_instruction(migraphx::make_op("add"), sum1, sum1);
+        m2.add_instruction(pass_op{}, sum3);
+    }
+    EXPECT(m1 == m2);
+}
+
+// Many slices that only differ by their attributes
+TEST_CASE(cse_test_many_attributes)
+{
+    const std::size_t n = 1000;
+    migraphx::shape s{migraphx::shape::float_type, {n}};
+    auto slice = [](std::size_t i) {
+        return migraphx::make_op("slice", {{"axes", {0}}, {"starts", {i}}, {"ends", {i + 1}}});
+    };
+    migraphx::module m1;
+    {
+        auto x   = m1.add_parameter("x", s);
+        auto sum = m1.add_instruction(slice(0), x);
+        for(std::size_t i = 1; i < n; i++)
+        {
+            auto slice1 = m1.add_instruction(slice(i), x);
+            auto slice2 = m1.add_instruction(slice(i), x);
+            auto add1   = m1.add_instruction(migraphx::make_op("add"), slice1, sum);
+            auto add2   = m1.add_instruction(migraphx::make_op("add"), slice2, sum);
+            sum         = m1.add_instruction(migraphx::make_op("mul"), add1, add2);
+        }
+        m1.add_instruction(pass_op{}, sum);
+    }
+    run_pass(m1);
+
+    migraphx::module m2;
+    {
+        auto x   = m2.add_parameter("x", s);
+        auto sum = m2.add_instruction(slice(0), x);
+        for(std::size_t i = 1; i < n; i++)
+        {
+            auto slice1 = m2.add_instruction(slice(i), x);
+            auto add1   = m2.add_instruction(migraphx::make_op("add"), slice1, sum);
+            sum         = m2.add_instruction(migraphx::make_op("mul"), add1, add1);
+        }
+        m2.add_instruction(pass_op{}, sum);
+    }
+    EXPECT(m1 == m2);
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
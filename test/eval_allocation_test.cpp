@@ -0,0 +1,142 @@
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/compile_options.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "test.hpp"
+
+// NOLINTNEXTLINE
+static std::atomic<std::size_t> allocation_count{0};
+
+// NOLINTNEXTLINE
+void* operator new(std::size_t n)
+{
+    allocation_count++;
+    if(n == 0)
+        n = 1;
+    void* p = std::malloc(n); // NOLINT
+    if(p == nullptr)
+        throw std::bad_alloc{};
+    return p;
+}
+
+// NOLINTNEXTLINE
+void operator delete(void* p) noexcept { std::free(p); }
+
+// NOLINTNEXTLINE
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+struct alloc_target
+{
+    struct context
+    {
+        void finish() const {}
+    };
+    std::string name() const { return "alloc"; }
+    std::vector<migraphx::pass> get_passes(migraphx::context&,
+                                           const migraphx::compile_options&) const
+    {
+        return {};
+    }
+    migraphx::context get_context() const { return context{}; }
+};
+
+struct forward_op
+{
+    std::string name() const { return "forward"; }
+    migraphx::argument compute(alloc_target::context&,
+                               const migraphx::shape&,
+                               const std::vector<migraphx::argument>& args) const
+    {
+        return args.front();
+    }
+
+    migraphx::shape compute_shape(const std::vector<migraphx::shape>& inputs) const
+    {
+        return inputs.front();
+    }
+    int output_alias(const std::vector<migraphx::shape>&) const { return 0; }
+};
+
+migraphx::program create_program(std::size_t n)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape s{migraphx::shape::float_type, {4}};
+    auto x = mm->add_parameter("x", s);
+    auto l = mm->add_literal(migraphx::literal{s, {1, 2, 3, 4}});
+    for(std::size_t i = 0; i < n; i++)
+    {
+        l = mm->add_instruction(forward_op{}, l, x);
+        x = mm->add_instruction(forward_op{}, x, l);
+    }
+    mm->add_return({x});
+    p.compile(alloc_target{});
+    return p;
+}
+
+std::size_t count_eval_allocations(const migraphx::program& p)
+{
+    std::vector<float> data = {1, 2, 3, 4};
+    migraphx::parameter_map params;
+    params["x"] = migraphx::argument{p.get_parameter_shape("x"), data.data()};
+    // Warm up
+    p.eval(params);
+    auto start  = allocation_count.load();
+    auto result = p.eval(std::move(params));
+    auto count  = allocation_count.load() - start;
+    EXPECT(result.front().data() == reinterpret_cast<char*>(data.data()));
+    return count;
+}
+
+std::size_t max_eval_allocations(const migraphx::program& p)
+{
+    // The slots for the results, the input arguments for each level of modules, the input
+    // arguments of the main module and the vector of outputs
+    std::size_t n = 4;
+#ifdef NDEBUG
+    (void)p;
+    return n;
+#else
+    // The context is also copied after every instruction in debug builds to check it
+    return n + p.get_main_module()->size();
+#endif
+}
+
+TEST_CASE(eval_allocations_independent_of_size)
+{
+    auto p1 = create_program(10);
+    auto p2 = create_program(100);
+    auto n1 = count_eval_allocations(p1);
+    auto n2 = count_eval_allocations(p2);
+    EXPECT(n1 <= max_eval_allocations(p1));
+    EXPECT(n2 <= max_eval_allocations(p2));
+#ifdef NDEBUG
+    EXPECT(n1 == n2);
+#endif
+}
+
+TEST_CASE(eval_after_replace_instruction)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape s{migraphx::shape::float_type, {4}};
+    auto x = mm->add_parameter("x", s);
+    auto y = mm->add_parameter("y", s);
+    auto r = mm->add_instruction(forward_op{}, x, y);
+    mm->add_return({r});
+    p.compile(alloc_target{});
+
+    std::vector<float> x_data = {1, 2, 3, 4};
+    std::vector<float> y_data = {5, 6, 7, 8};
+    migraphx::parameter_map params;
+    params["x"] = migraphx::argument{s, x_data.data()};
+    params["y"] = migraphx::argument{s, y_data.data()};
+    EXPECT(p.eval(params).front().data() == reinterpret_cast<char*>(x_data.data()));
+    // Replacing in place keeps the size of the module the same
+    mm->replace_instruction(r, forward_op{}, y, x);
+    EXPECT(p.eval(params).front().data() == reinterpret_cast<char*>(y_data.data()));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
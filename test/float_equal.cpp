@@ -1,5 +1,6 @@
 #include <migraphx/float_equal.hpp>
 #include <migraphx/half.hpp>
+#include <migraphx/bf16.hpp>
 #include "test.hpp"
 
 #include <limits>
@@ -50,6 +51,8 @@ TEST_CASE_REGISTER(test_equality<double, int>);
 TEST_CASE_REGISTER(test_equality<double, migraphx::half>);
 TEST_CASE_REGISTER(test_equality<float, int>);
 TEST_CASE_REGISTER(test_equality<migraphx::half, int>);
+TEST_CASE_REGISTER(test_equality<double, migraphx::bf16>);
+TEST_CASE_REGISTER(test_equality<migraphx::bf16, int>);
 
 template <class T, class U>
 void test_limits()
@@ -89,6 +92,8 @@ TEST_CASE_REGISTER(test_limits<double, int>);
 TEST_CASE_REGISTER(test_limits<double, migraphx::half>);
 TEST_CASE_REGISTER(test_limits<float, int>);
 TEST_CASE_REGISTER(test_limits<int, migraphx::half>);
+TEST_CASE_REGISTER(test_limits<double, migraphx::bf16>);
+TEST_CASE_REGISTER(test_limits<migraphx::half, migraphx::bf16>);
 TEST_CASE_REGISTER(test_limits<long, int>);
 TEST_CASE_REGISTER(test_limits<long, char>);
 
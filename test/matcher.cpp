@@ -1063,4 +1063,63 @@ TEST_CASE(match_finder)
     match::find_matches(mm, match_find_sum{sum}, match_find_literal{sum});
 }
 
+TEST_CASE(match_root_names)
+{
+    EXPECT(match::get_root_names(match::name("sum")) == std::vector<std::string>{"sum"});
+    EXPECT(match::get_root_names(match::name("sum")(match::arg(0)(match::name("@literal")))) ==
+           std::vector<std::string>{"sum"});
+    EXPECT(match::get_root_names(match::name("sum")(match::used_once()).bind("x")) ==
+           std::vector<std::string>{"sum"});
+    EXPECT(match::get_root_names(match::any_matcher{match::name("sum")}) ==
+           std::vector<std::string>{"sum"});
+    auto names = match::get_root_names(match::name("sum", "pass"));
+    std::sort(names.begin(), names.end());
+    EXPECT(names == std::vector<std::string>{"pass", "sum"});
+    EXPECT(match::get_root_names(match::any_of(match::name("sum"), match::name("pass"))).empty());
+    EXPECT(match::get_root_names(match::used_once(match::name("sum"))).empty());
+}
+
+struct match_count_finder
+{
+    std::string name;
+    std::shared_ptr<std::vector<std::string>> matched;
+    auto matcher() const { return match::name(name); }
+
+    void apply(migraphx::module&, const match::matcher_result& r) const
+    {
+        matched->push_back(name + ":" + r.result->name());
+    }
+};
+
+struct match_any_finder
+{
+    std::shared_ptr<std::vector<std::string>> matched;
+    auto matcher() const { return match::any(); }
+
+    void apply(migraphx::module&, const match::matcher_result& r) const
+    {
+        matched->push_back("any:" + r.result->name());
+    }
+};
+
+TEST_CASE(match_finder_dispatch)
+{
+    migraphx::module mm;
+    auto one = mm.add_literal(1);
+    auto two = mm.add_literal(2);
+    auto sum = mm.add_instruction(sum_op{}, one, two);
+    mm.add_instruction(pass_op{}, sum);
+    auto matched = std::make_shared<std::vector<std::string>>();
+    EXPECT(match::find_matches(mm,
+                               match_count_finder{"sum", matched},
+                               match_any_finder{matched},
+                               match_count_finder{"pass", matched}));
+    EXPECT(*matched == std::vector<std::string>{
+                           "any:@literal", "any:@literal", "sum:sum", "any:pass"});
+
+    matched->clear();
+    EXPECT(not match::find_matches(mm, match_count_finder{"mul", matched}));
+    EXPECT(matched->empty());
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
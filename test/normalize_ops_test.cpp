@@ -3,7 +3,9 @@
 #include <migraphx/pass_manager.hpp>
 #include <migraphx/make_op.hpp>
 #include <migraphx/functional.hpp>
+#include <migraphx/instruction.hpp>
 #include <migraphx/op/normalize_attribute.hpp>
+#include <migraphx/ref/context.hpp>
 #include <basic_ops.hpp>
 #include <test.hpp>
 
@@ -179,4 +181,16 @@ TEST_CASE(test_op)
     EXPECT(m1 == m2);
 }
 
+TEST_CASE(finalize_test)
+{
+    auto m1 = create_gather(-3);
+    auto m2 = create_gather(0);
+
+    migraphx::context ctx = migraphx::ref::context{};
+    m1.finalize(ctx);
+    EXPECT(m1 == m2);
+    EXPECT(std::none_of(
+        m1.begin(), m1.end(), [](const auto& ins) { return ins.need_normalization(); }));
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
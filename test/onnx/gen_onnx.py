@@ -1381,6 +1381,41 @@ def expand_test():
     return ([shape_const, node], [x], [y])
 
 
+@onnx_test
+def external_data_offset_test():
+    w1 = np.array([1, 2, 3, 4, 5, 6]).astype(np.float32)
+    w2 = -w1
+    # Both tensors are stored in one file, the second one at a page offset
+    with open('external_data_offset.data', 'wb') as f:
+        f.write(w1.tobytes())
+        f.seek(4096)
+        f.write(w2.tobytes())
+
+    def make_external_tensor(name, offset, length):
+        tensor = TensorProto()
+        tensor.name = name
+        tensor.data_type = TensorProto.FLOAT
+        tensor.dims.extend([2, 3])
+        for key, value in [('location', 'external_data_offset.data'),
+                           ('offset', str(offset)), ('length', str(length))]:
+            entry = tensor.external_data.add()
+            entry.key = key
+            entry.value = value
+        tensor.data_location = TensorProto.EXTERNAL
+        return tensor
+
+    x = helper.make_tensor_value_info('x', TensorProto.FLOAT, [2, 3])
+    z = helper.make_tensor_value_info('z', TensorProto.FLOAT, [2, 3])
+
+    add = onnx.helper.make_node('Add', inputs=['x', 'w1'], outputs=['y'])
+    mul = onnx.helper.make_node('Mul', inputs=['y', 'w2'], outputs=['z'])
+
+    return ([add, mul], [x], [z], [
+        make_external_tensor('w1', 0, 24),
+        make_external_tensor('w2', 4096, 24)
+    ])
+
+
 @onnx_test
 def flatten_test():
     x = helper.make_tensor_value_info('0', TensorProto.FLOAT, [2, 3, 4, 5])
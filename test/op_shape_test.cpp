@@ -1147,6 +1147,41 @@ TEST_CASE(reshape_shape)
     }
 }
 
+TEST_CASE(resize_shape)
+{
+    migraphx::shape input{migraphx::shape::float_type, {1, 3, 4, 6}};
+    expect_shape(migraphx::shape{migraphx::shape::float_type, {1, 3, 8, 3}},
+                 migraphx::make_op("resize", {{"sizes", {1, 3, 8, 3}}, {"scales", {1, 1, 2, 0.5}}}),
+                 input);
+    expect_shape(migraphx::shape{migraphx::shape::float_type, {1, 3, 2, 2}},
+                 migraphx::make_op("resize",
+                                   {{"sizes", {1, 3, 2, 2}},
+                                    {"scales", {1, 1, 0.5, 0.5}},
+                                    {"mode", "linear"},
+                                    {"coordinate_transformation_mode", "tf_crop_and_resize"},
+                                    {"roi", {0, 0, 0, 0, 1, 1, 1, 1}}}),
+                 input);
+
+    throws_shape(migraphx::make_op("resize", {{"sizes", {3, 8, 3}}, {"scales", {1, 2, 0.5}}}),
+                 input);
+    throws_shape(migraphx::make_op("resize", {{"sizes", {1, 3, 0, 3}}, {"scales", {1, 1, 0, 0.5}}}),
+                 input);
+    throws_shape(
+        migraphx::make_op("resize",
+                          {{"sizes", {1, 3, 8, 3}}, {"scales", {1, 1, 2, 0.5}}, {"mode", "cubic"}}),
+        input);
+    throws_shape(migraphx::make_op("resize",
+                                   {{"sizes", {1, 3, 8, 3}},
+                                    {"scales", {1, 1, 2, 0.5}},
+                                    {"coordinate_transformation_mode", "tf_crop_and_resize"}}),
+                 input);
+    throws_shape(migraphx::make_op("resize",
+                                   {{"sizes", {1, 3, 8, 3}},
+                                    {"scales", {1, 1, 2, 0.5}},
+                                    {"nearest_mode", "round"}}),
+                 input);
+}
+
 TEST_CASE(rnn)
 {
     {
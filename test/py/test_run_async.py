@@ -0,0 +1,127 @@
+import migraphx, array, gc, sys, threading
+
+
+def create_program(filename, map_input_dims={}):
+    p = migraphx.parse_onnx(filename, map_input_dims=map_input_dims)
+    p.compile(migraphx.get_target("ref"))
+    return p
+
+
+def create_params(p, seed=0):
+    params = {}
+    for key, value in p.get_parameter_shapes().items():
+        params[key] = migraphx.generate_argument(value, seed)
+    return params
+
+
+def create_output(s):
+    a = array.array('f', [0] * s.elements())
+    return memoryview(a).cast('B').cast('f', s.lens())
+
+
+def test_run_outputs():
+    p = create_program("matmul_bmbm_test.onnx")
+    params = create_params(p)
+    expected = p.run(params)[-1]
+    out = create_output(p.get_output_shapes()[-1])
+    r = p.run(params, [out])[-1]
+    assert r == expected
+    assert migraphx.argument(out) == expected
+
+
+def test_run_async():
+    p = create_program("matmul_bmbm_test.onnx")
+    params = create_params(p)
+    expected = p.run(params)[-1]
+    out = create_output(p.get_output_shapes()[-1])
+    futures = [p.run_async(params) for i in range(4)]
+    futures.append(p.run_async(params, [out]))
+    for f in futures:
+        assert f.result()[-1] == expected
+        assert f.done()
+    assert migraphx.argument(out) == expected
+
+
+def test_dropped_buffers():
+    # With PYTHONMALLOC=debug freed memory is overwritten, so the results
+    # would be wrong if they did not keep the buffers alive
+    p = create_program("matmul_bmbm_test.onnx")
+    params = create_params(p)
+    expected = p.run(params)[-1]
+    s = p.get_output_shapes()[-1]
+    r = p.run(params, [create_output(s)])[-1]
+    f = p.run_async(params, [create_output(s)])
+    a = migraphx.argument(create_output(s))
+    gc.collect()
+    garbage = [create_output(s) for i in range(8)]
+    assert r == expected
+    assert f.result()[-1] == expected
+    assert a.tolist() == [0] * s.elements()
+
+
+def test_concurrent_threads():
+    p1 = create_program("matmul_bmbm_test.onnx", {
+        "1": [384, 384],
+        "2": [384, 384]
+    })
+    p2 = create_program("matmul_mv_test.onnx")
+    params1 = create_params(p1)
+    params2 = create_params(p2)
+    count = [0]
+    running = threading.Event()
+
+    def run_small():
+        running.wait()
+        while running.is_set():
+            p2.run(params2)
+            count[0] += 1
+
+    # With a long switch interval the other thread only runs python code
+    # when the main thread releases the GIL, so its count can only change
+    # during run if run releases the GIL
+    interval = sys.getswitchinterval()
+    sys.setswitchinterval(1000)
+    t = threading.Thread(target=run_small)
+    t.start()
+    running.set()
+    advanced = False
+    try:
+        for i in range(100):
+            before = count[0]
+            p1.run(params1)
+            if count[0] != before:
+                advanced = True
+                break
+    finally:
+        running.clear()
+        sys.setswitchinterval(interval)
+        t.join()
+    assert advanced
+
+
+def test_sessions():
+    p = create_program("conv_relu_maxpool_test.onnx")
+    params = [create_params(p, i) for i in range(4)]
+    expected = [p.run(x)[-1] for x in params]
+    results = [None] * len(params)
+
+    def run(i):
+        s = migraphx.session(p)
+        results[i] = [s.run(params[i])[-1] for n in range(10)]
+
+    threads = [threading.Thread(target=run, args=(i, )) for i in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    for r, e in zip(results, expected):
+        assert all(x == e for x in r)
+    s = migraphx.session(p)
+    assert s.run_async(params[0]).result()[-1] == expected[0]
+
+
+test_run_outputs()
+test_run_async()
+test_dropped_buffers()
+test_concurrent_threads()
+test_sessions()
@@ -3882,6 +3882,73 @@ TEST_CASE(reshape_test)
     }
 }
 
+TEST_CASE(resize_linear_test)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape s{migraphx::shape::float_type, {1, 1, 2, 2}};
+    std::vector<float> data = {1, 2, 3, 4};
+    auto l                  = mm->add_literal(migraphx::literal{s, data});
+    mm->add_instruction(
+        migraphx::make_op("resize",
+                          {{"sizes", {1, 1, 4, 4}}, {"scales", {1, 1, 2, 2}}, {"mode", "linear"}}),
+        l);
+    p.compile(migraphx::ref::target{});
+    auto result = p.eval({}).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    std::vector<float> gold = {
+        1, 1.25, 1.75, 2, 1.5, 1.75, 2.25, 2.5, 2.5, 2.75, 3.25, 3.5, 3, 3.25, 3.75, 4};
+    EXPECT(migraphx::verify_range(results_vector, gold));
+}
+
+TEST_CASE(resize_nearest_nonstd_test)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape s{migraphx::shape::float_type, {1, 1, 4, 2}};
+    std::vector<float> data = {1, 5, 2, 6, 3, 7, 4, 8};
+    auto l                  = mm->add_literal(migraphx::literal{s, data});
+    auto t =
+        mm->add_instruction(migraphx::make_op("transpose", {{"permutation", {0, 1, 3, 2}}}), l);
+    mm->add_instruction(migraphx::make_op("resize",
+                                          {{"sizes", {1, 1, 1, 2}},
+                                           {"scales", {1, 1, 0.6, 0.6}},
+                                           {"coordinate_transformation_mode", "asymmetric"},
+                                           {"nearest_mode", "ceil"}}),
+                        t);
+    p.compile(migraphx::ref::target{});
+    auto result = p.eval({}).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    std::vector<float> gold = {1, 3};
+    EXPECT(migraphx::verify_range(results_vector, gold));
+}
+
+TEST_CASE(resize_tf_crop_and_resize_test)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape s{migraphx::shape::float_type, {1, 1, 4, 4}};
+    std::vector<float> data(16);
+    std::iota(data.begin(), data.end(), 1);
+    auto l = mm->add_literal(migraphx::literal{s, data});
+    mm->add_instruction(migraphx::make_op("resize",
+                                          {{"sizes", {1, 1, 3, 3}},
+                                           {"scales", {1, 1, 0.75, 0.75}},
+                                           {"mode", "linear"},
+                                           {"coordinate_transformation_mode", "tf_crop_and_resize"},
+                                           {"roi", {0, 0, 0.4, 0.6, 1, 1, 1.2, 1.7}},
+                                           {"extrapolation_value", 10.0f}}),
+                        l);
+    p.compile(migraphx::ref::target{});
+    auto result = p.eval({}).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    std::vector<float> gold = {7.6f, 10.0f, 10.0f, 12.4f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f};
+    EXPECT(migraphx::verify_range(results_vector, gold));
+}
+
 TEST_CASE(reverse_test_axis0)
 {
     migraphx::shape in_shape{migraphx::shape::float_type, {2, 16}};
@@ -0,0 +1,79 @@
+#include <migraphx/rewrite_resize.hpp>
+#include <migraphx/dead_code_elimination.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/ref/target.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/ranges.hpp>
+#include <test.hpp>
+#include <migraphx/make_op.hpp>
+
+#include <migraphx/verify.hpp>
+
+static void opt_resize(migraphx::module& m)
+{
+    migraphx::rewrite_resize rr;
+    migraphx::dead_code_elimination dce;
+    rr.apply(m);
+    dce.apply(m);
+}
+
+static std::vector<float> eval(migraphx::program p, const migraphx::argument& x)
+{
+    p.compile(migraphx::ref::target{});
+    auto result = p.eval({{"x", x}}).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    return results_vector;
+}
+
+static void test_rewrite(const migraphx::shape& s, const migraphx::value& v)
+{
+    migraphx::program p1;
+    auto* mm = p1.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    auto ret = mm->add_instruction(migraphx::make_op("resize", v), x);
+    mm->add_return({ret});
+    migraphx::program p2 = p1;
+    opt_resize(*p2.get_main_module());
+    EXPECT(none_of(*p2.get_main_module(), [](auto& ins) { return ins.name() == "resize"; }));
+
+    auto arg = migraphx::generate_argument(s);
+    EXPECT(migraphx::verify_range(eval(p1, arg), eval(p2, arg)));
+}
+
+TEST_CASE(rewrite_resize_nearest)
+{
+    migraphx::shape s{migraphx::shape::float_type, {1, 2, 3, 4}};
+    test_rewrite(s, {{"sizes", {1, 2, 6, 6}}, {"scales", {1, 1, 2, 1.5}}});
+    test_rewrite(s,
+                 {{"sizes", {1, 2, 2, 3}},
+                  {"scales", {1, 1, 0.6, 0.75}},
+                  {"coordinate_transformation_mode", "align_corners"},
+                  {"nearest_mode", "ceil"}});
+}
+
+TEST_CASE(rewrite_resize_linear)
+{
+    migraphx::shape s{migraphx::shape::float_type, {2, 3, 5, 4}};
+    test_rewrite(s, {{"sizes", {2, 3, 3, 9}}, {"scales", {1, 1, 0.6, 2.25}}, {"mode", "linear"}});
+    test_rewrite(s,
+                 {{"sizes", {4, 3, 10, 4}},
+                  {"scales", {2, 1, 2, 1}},
+                  {"mode", "linear"},
+                  {"coordinate_transformation_mode", "asymmetric"}});
+}
+
+TEST_CASE(rewrite_resize_extrapolation)
+{
+    migraphx::shape s{migraphx::shape::float_type, {1, 2, 5, 4}};
+    test_rewrite(s,
+                 {{"sizes", {1, 2, 4, 6}},
+                  {"scales", {1, 1, 1, 1}},
+                  {"mode", "linear"},
+                  {"coordinate_transformation_mode", "tf_crop_and_resize"},
+                  {"roi", {0, 0, 0.2, -0.1, 1, 1, 0.9, 1.3}},
+                  {"extrapolation_value", -1.0f}});
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
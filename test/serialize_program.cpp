@@ -3,8 +3,15 @@
 #include <migraphx/load_save.hpp>
 #include "test.hpp"
 #include <migraphx/make_op.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/stringutils.hpp>
 
+#include <algorithm>
 #include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <numeric>
+#include <sstream>
 
 migraphx::program create_program()
 {
@@ -18,6 +25,25 @@ migraphx::program create_program()
     return p;
 }
 
+migraphx::program create_program_with_weights()
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+
+    migraphx::shape s{migraphx::shape::float_type, {64, 64}};
+    std::vector<float> weights(s.elements());
+    std::iota(weights.begin(), weights.end(), 0);
+    auto x   = mm->add_parameter("x", s);
+    auto w   = mm->add_literal(migraphx::literal{s, weights});
+    auto two = mm->add_literal(2.0f);
+    auto dot = mm->add_instruction(migraphx::make_op("dot"), x, w);
+    auto b   = mm->add_instruction(
+        migraphx::make_op("multibroadcast", {{"out_lens", s.lens()}}), two);
+    auto add = mm->add_instruction(migraphx::make_op("add"), dot, b);
+    mm->add_return({add});
+    return p;
+}
+
 TEST_CASE(as_value)
 {
     migraphx::program p1 = create_program();
@@ -46,6 +72,90 @@ TEST_CASE(as_json)
     EXPECT(p1.sort() == p2.sort());
 }
 
+TEST_CASE(as_mmap)
+{
+    migraphx::file_options options;
+    options.format           = "mmap";
+    migraphx::program p1     = create_program_with_weights();
+    std::vector<char> buffer = migraphx::save_buffer(p1, options);
+    migraphx::program p2     = migraphx::load_buffer(buffer);
+    EXPECT(p1.sort() == p2.sort());
+}
+
+TEST_CASE(as_mmap_file)
+{
+    std::string filename = "migraphx_program_mmap.dat";
+    migraphx::file_options options;
+    options.format       = "mmap";
+    migraphx::program p1 = create_program_with_weights();
+    migraphx::save(p1, filename, options);
+    migraphx::program p2 = migraphx::load(filename);
+    std::remove(filename.c_str());
+    // The literals still use the mapping after the file is removed
+    EXPECT(p1.sort() == p2.sort());
+}
+
+TEST_CASE(as_mmap_compiled)
+{
+    std::string filename = "migraphx_program_mmap_compiled.dat";
+    migraphx::file_options options;
+    options.format       = "mmap";
+    migraphx::program p1 = create_program_with_weights();
+    p1.compile(migraphx::ref::target{});
+    migraphx::save(p1, filename, options);
+    migraphx::program p2 = migraphx::load(filename);
+    std::remove(filename.c_str());
+    EXPECT(p1.sort() == p2.sort());
+
+    migraphx::shape s{migraphx::shape::float_type, {64, 64}};
+    std::vector<float> x(s.elements(), 1);
+    migraphx::parameter_map params;
+    params["x"] = migraphx::argument(s, x.data());
+    auto r1     = p1.eval(params).back();
+    auto r2     = p2.eval(params).back();
+    EXPECT(r1 == r2);
+}
+
+// Address ranges where the file is mapped in this process
+std::vector<std::pair<std::uintptr_t, std::uintptr_t>> find_mappings(const std::string& filename)
+{
+    std::vector<std::pair<std::uintptr_t, std::uintptr_t>> result;
+    std::ifstream maps("/proc/self/maps");
+    std::string line;
+    while(std::getline(maps, line))
+    {
+        if(not migraphx::ends_with(line, "/" + filename))
+            continue;
+        std::uintptr_t start = 0;
+        std::uintptr_t end   = 0;
+        char dash            = 0;
+        std::istringstream ss(line);
+        ss >> std::hex >> start >> dash >> end;
+        result.emplace_back(start, end);
+    }
+    return result;
+}
+
+TEST_CASE(as_mmap_file_aliases)
+{
+    std::string filename = "migraphx_program_mmap_alias.dat";
+    migraphx::file_options options;
+    options.format = "mmap";
+    migraphx::save(create_program_with_weights(), filename, options);
+    auto p        = migraphx::load(filename);
+    auto mappings = find_mappings(filename);
+    std::remove(filename.c_str());
+    auto* mm = p.get_main_module();
+    auto w   = std::find_if(mm->begin(), mm->end(), [](const auto& ins) {
+        return ins.name() == "@literal" and ins.get_shape().elements() > 1;
+    });
+    EXPECT(bool{w != mm->end()});
+    auto address = reinterpret_cast<std::uintptr_t>(w->get_literal().data());
+    EXPECT(std::any_of(mappings.begin(), mappings.end(), [&](const auto& m) {
+        return address >= m.first and address < m.second;
+    }));
+}
+
 TEST_CASE(as_file)
 {
     std::string filename = "migraphx_program.dat";
@@ -0,0 +1,84 @@
+#include <migraphx/session.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/register_target.hpp>
+#include <migraphx/ref/target.hpp>
+#include <thread>
+#include "test.hpp"
+
+migraphx::program create_program()
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape s{migraphx::shape::float_type, {4, 8}};
+    auto x   = mm->add_parameter("x", s);
+    auto y   = mm->add_parameter("y", s);
+    auto w   = mm->add_literal(migraphx::generate_literal({migraphx::shape::float_type, {8, 8}}));
+    auto dot = mm->add_instruction(migraphx::make_op("dot"), x, w);
+    auto add = mm->add_instruction(migraphx::make_op("add"), dot, y);
+    mm->add_instruction(migraphx::make_op("relu"), add);
+    p.compile(migraphx::ref::target{});
+    return p;
+}
+
+migraphx::parameter_map create_params(const migraphx::program& p, std::size_t seed)
+{
+    migraphx::parameter_map params;
+    for(auto&& x : p.get_parameter_shapes())
+        params[x.first] = migraphx::generate_argument(x.second, seed++);
+    return params;
+}
+
+TEST_CASE(session_eval)
+{
+    auto p      = create_program();
+    auto params = create_params(p, 0);
+    migraphx::session s{p};
+    auto result = s.eval(params);
+    EXPECT(result == p.eval(params));
+    EXPECT(s.eval(params) == result);
+    EXPECT(&s.get_program() == &p);
+}
+
+TEST_CASE(session_missing_param)
+{
+    auto p = create_program();
+    migraphx::session s{p};
+    EXPECT(test::throws([&] { s.eval({}); }));
+}
+
+TEST_CASE(session_uncompiled)
+{
+    migraphx::program p;
+    EXPECT(test::throws([&] { migraphx::session{p}; }));
+}
+
+TEST_CASE(session_concurrent)
+{
+    auto p = create_program();
+    std::vector<migraphx::parameter_map> params;
+    std::vector<std::vector<migraphx::argument>> expected;
+    for(std::size_t i = 0; i < 4; i++)
+    {
+        params.push_back(create_params(p, i * 2));
+        expected.push_back(p.eval(params.back()));
+    }
+    std::vector<migraphx::session> sessions;
+    for(std::size_t i = 0; i < params.size(); i++)
+        sessions.emplace_back(p);
+    std::vector<int> matches(params.size(), 0);
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0; i < params.size(); i++)
+    {
+        threads.emplace_back([&, i] {
+            for(int n = 0; n < 50; n++)
+                matches[i] += sessions[i].eval(params[i]) == expected[i] ? 1 : 0;
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    EXPECT(std::all_of(matches.begin(), matches.end(), [](int n) { return n == 50; }));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
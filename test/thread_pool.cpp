@@ -0,0 +1,94 @@
+#include <migraphx/thread_pool.hpp>
+#include <migraphx/par_for.hpp>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <test.hpp>
+
+TEST_CASE(run_all_elements)
+{
+    migraphx::thread_pool pool{4};
+    std::vector<int> visited(1000);
+    pool.run(visited.size(), 8, pool.size(), [&](auto start, auto end, auto tid) {
+        EXPECT(tid < 4);
+        EXPECT(bool{end - start >= 8 or end == visited.size()});
+        for(auto i = start; i < end; i++)
+            visited[i]++;
+    });
+    EXPECT(std::all_of(visited.begin(), visited.end(), [](auto x) { return x == 1; }));
+}
+
+TEST_CASE(run_limit_threads)
+{
+    migraphx::thread_pool pool{4};
+    std::atomic<std::size_t> count{0};
+    pool.run(100, 1, 2, [&](auto start, auto end, auto tid) {
+        EXPECT(tid < 2);
+        count += end - start;
+    });
+    EXPECT(count == 100);
+}
+
+TEST_CASE(run_nested)
+{
+    migraphx::thread_pool pool{3};
+    migraphx::thread_pool_scope scope{pool};
+    std::atomic<std::size_t> sum{0};
+    migraphx::par_for(16, 1, [&](auto) {
+        migraphx::par_for(100, 1, [&](auto j) { sum += j; });
+    });
+    EXPECT(sum == 16 * 4950);
+}
+
+TEST_CASE(run_concurrent_callers)
+{
+    migraphx::thread_pool pool{4};
+    std::atomic<std::size_t> count{0};
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 4; i++)
+    {
+        threads.emplace_back([&] {
+            pool.run(1000, 1, pool.size(), [&](auto start, auto end, auto) {
+                count += end - start;
+            });
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    EXPECT(count == 4000);
+}
+
+TEST_CASE(run_throws)
+{
+    migraphx::thread_pool pool{4};
+    EXPECT(test::throws<std::runtime_error>([&] {
+        pool.run(1000, 1, pool.size(), [&](auto start, auto end, auto) {
+            if(start <= 500 and 500 < end)
+                throw std::runtime_error("error");
+        });
+    }));
+}
+
+TEST_CASE(scope_limit)
+{
+    migraphx::thread_pool pool{4};
+    {
+        migraphx::thread_pool_scope scope{pool, 2};
+        EXPECT(&migraphx::current_thread_pool() == &pool);
+        EXPECT(migraphx::current_thread_limit() == 2);
+        migraphx::par_for(100, 1, [&](auto, auto tid) { EXPECT(tid < 2); });
+    }
+    EXPECT(&migraphx::current_thread_pool() == &migraphx::default_thread_pool());
+}
+
+TEST_CASE(numa_cpus)
+{
+    auto nodes = migraphx::get_numa_cpus();
+    EXPECT(not nodes.empty());
+    EXPECT(std::any_of(nodes.begin(), nodes.end(), [](const auto& cpus) {
+        return not cpus.empty();
+    }));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -835,4 +835,69 @@ TEST_CASE(value_or_null)
     EXPECT(v.value_or(3) == 3);
 }
 
+TEST_CASE(value_copy_modify)
+{
+    migraphx::value v1 = {{"a", {1, 2}}, {"b", 3}};
+    migraphx::value v2 = v1;
+    v2["a"].push_back(4);
+    v2["c"] = 5;
+    EXPECT(v1.size() == 2);
+    EXPECT(v1.at("a").size() == 2);
+    EXPECT(not v1.contains("c"));
+    EXPECT(v2.size() == 3);
+    EXPECT(v2.at("a").size() == 3);
+    EXPECT(v2.at("c").to<int>() == 5);
+
+    v1.at("b") = 6;
+    EXPECT(v1.at("b").to<int>() == 6);
+    EXPECT(v2.at("b").to<int>() == 3);
+}
+
+TEST_CASE(value_large_object)
+{
+    migraphx::value v;
+    for(int i = 0; i < 20; i++)
+        v["key" + std::to_string(i)] = i;
+    EXPECT(v.size() == 20);
+    for(int i = 0; i < 20; i++)
+        EXPECT(v.at("key" + std::to_string(i)).to<int>() == i);
+    EXPECT(not v.contains("key20"));
+
+    migraphx::value v2 = v;
+    v2["key0"]         = 100;
+    EXPECT(v2.size() == 20);
+    EXPECT(v2.at("key0").to<int>() == 100);
+    EXPECT(v.at("key0").to<int>() == 0);
+
+    v2.clear();
+    EXPECT(v2.empty());
+    EXPECT(not v2.contains("key1"));
+    EXPECT(v.contains("key1"));
+}
+
+TEST_CASE(value_copy_after_reference)
+{
+    migraphx::value v1 = {{"a", {1, 2}}, {"b", 3}};
+    migraphx::value& a  = v1.at("a");
+    migraphx::value& b  = v1["b"];
+    migraphx::value* a0 = a.begin();
+    migraphx::value v2  = v1;
+    *a0 = 7;
+    b   = 6;
+    a.push_back(4);
+    EXPECT(v1.at("a").size() == 3);
+    EXPECT(v1.at("a").at(0).to<int>() == 7);
+    EXPECT(v1.at("b").to<int>() == 6);
+    EXPECT(v2.at("a").size() == 2);
+    EXPECT(v2.at("a").at(0).to<int>() == 1);
+    EXPECT(v2.at("b").to<int>() == 3);
+
+    // Copies made after writing through the reference still see the writes
+    migraphx::value v3 = v1;
+    EXPECT(v3 == v1);
+    a.push_back(5);
+    EXPECT(v3.at("a").size() == 3);
+    EXPECT(v1.at("a").size() == 4);
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
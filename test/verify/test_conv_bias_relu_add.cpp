@@ -0,0 +1,33 @@
+
+#include "verify_program.hpp"
+#include <migraphx/program.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/instruction.hpp>
+
+// The bias, relu and the add of the other convolution are all fused as post ops, the last one as a
+// sum into the buffer of the other convolution
+struct test_conv_bias_relu_add : verify_program<test_conv_bias_relu_add>
+{
+    migraphx::program create_program() const
+    {
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        auto x   = mm->add_parameter("x", {migraphx::shape::float_type, {1, 8, 4, 4}});
+        auto w   = mm->add_literal(
+            migraphx::generate_literal({migraphx::shape::float_type, {4, 8, 3, 3}}, 1));
+        auto b = mm->add_literal(migraphx::generate_literal({migraphx::shape::float_type, {4}}, 2));
+        auto y = mm->add_parameter("y", {migraphx::shape::float_type, {1, 8, 4, 4}});
+        auto v = mm->add_literal(
+            migraphx::generate_literal({migraphx::shape::float_type, {4, 8, 3, 3}}, 3));
+        auto conv1 = mm->add_instruction(migraphx::make_op("convolution"), x, w);
+        auto bias  = mm->add_instruction(
+            migraphx::make_op("broadcast", {{"axis", 1}, {"out_lens", conv1->get_shape().lens()}}),
+            b);
+        auto add   = mm->add_instruction(migraphx::make_op("add"), conv1, bias);
+        auto relu  = mm->add_instruction(migraphx::make_op("relu"), add);
+        auto conv2 = mm->add_instruction(migraphx::make_op("convolution"), y, v);
+        mm->add_instruction(migraphx::make_op("add"), relu, conv2);
+        return p;
+    }
+};
@@ -0,0 +1,29 @@
+#include "verify_program.hpp"
+#include <migraphx/program.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/make_op.hpp>
+
+struct test_conv_branches_concat : verify_program<test_conv_branches_concat>
+{
+    migraphx::program create_program() const
+    {
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        auto input =
+            mm->add_parameter("x", migraphx::shape{migraphx::shape::float_type, {2, 8, 14, 14}});
+        auto w1 = mm->add_literal(migraphx::generate_literal(
+            migraphx::shape{migraphx::shape::float_type, {16, 8, 3, 3}}, 1));
+        auto w2 = mm->add_literal(migraphx::generate_literal(
+            migraphx::shape{migraphx::shape::float_type, {16, 8, 1, 1}}, 2));
+        auto w3 = mm->add_literal(migraphx::generate_literal(
+            migraphx::shape{migraphx::shape::float_type, {8, 16, 1, 1}}, 3));
+        auto conv1 = mm->add_instruction(
+            migraphx::make_op("convolution", {{"padding", {1, 1}}}), input, w1);
+        auto relu1 = mm->add_instruction(migraphx::make_op("relu"), conv1);
+        auto conv2 = mm->add_instruction(migraphx::make_op("convolution"), input, w2);
+        auto conv3 = mm->add_instruction(migraphx::make_op("convolution"), conv2, w3);
+        auto relu3 = mm->add_instruction(migraphx::make_op("relu"), conv3);
+        mm->add_instruction(migraphx::make_op("concat", {{"axis", 1}}), relu1, relu3);
+        return p;
+    }
+};
@@ -0,0 +1,25 @@
+
+#include "verify_program.hpp"
+#include <migraphx/program.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/make_op.hpp>
+
+struct test_conv_dot_literal_weights : verify_program<test_conv_dot_literal_weights>
+{
+    migraphx::program create_program() const
+    {
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        migraphx::shape xs{migraphx::shape::float_type, {2, 16, 14, 14}};
+        migraphx::shape ws{migraphx::shape::float_type, {32, 16, 3, 3}};
+        migraphx::shape ds{migraphx::shape::float_type, {32 * 12 * 12, 10}};
+        auto x    = mm->add_parameter("x", xs);
+        auto w    = mm->add_literal(migraphx::generate_literal(ws, 1));
+        auto d    = mm->add_literal(migraphx::generate_literal(ds, 2));
+        auto conv = mm->add_instruction(migraphx::make_op("convolution"), x, w);
+        auto flat =
+            mm->add_instruction(migraphx::make_op("reshape", {{"dims", {2, 32 * 12 * 12}}}), conv);
+        mm->add_instruction(migraphx::make_op("dot"), flat, d);
+        return p;
+    }
+};
@@ -0,0 +1,39 @@
+
+#include "verify_program.hpp"
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/make_op.hpp>
+
+struct test_conv_qdq : verify_program<test_conv_qdq>
+{
+    static migraphx::instruction_ref add_qdq(migraphx::module& m,
+                                             migraphx::instruction_ref x,
+                                             migraphx::instruction_ref scale,
+                                             migraphx::instruction_ref zero)
+    {
+        auto lens     = x->get_shape().lens();
+        auto scale_mb = m.add_instruction(
+            migraphx::make_op("multibroadcast", {{"out_lens", lens}}), scale);
+        auto zero_mb =
+            m.add_instruction(migraphx::make_op("multibroadcast", {{"out_lens", lens}}), zero);
+        auto q = m.add_instruction(migraphx::make_op("quantizelinear"), x, scale_mb, zero_mb);
+        return m.add_instruction(migraphx::make_op("dequantizelinear"), q, scale_mb, zero_mb);
+    }
+
+    migraphx::program create_program() const
+    {
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        migraphx::shape sw{migraphx::shape::float_type, {4, 3, 3, 3}};
+        auto x = mm->add_parameter("x", migraphx::shape{migraphx::shape::float_type, {2, 3, 8, 8}});
+        auto w = mm->add_literal(migraphx::generate_literal(sw, 1));
+        auto scale = mm->add_literal(0.25f);
+        auto zero  = mm->add_literal(std::int8_t{0});
+        auto conv  = mm->add_instruction(migraphx::make_op("convolution"),
+                                        add_qdq(*mm, x, scale, zero),
+                                        add_qdq(*mm, w, scale, zero));
+        mm->add_instruction(migraphx::make_op("relu"), conv);
+        return p;
+    }
+};
@@ -0,0 +1,24 @@
+#include "verify_program.hpp"
+#include <migraphx/program.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/make_op.hpp>
+
+struct test_conv_relu_conv : verify_program<test_conv_relu_conv>
+{
+    migraphx::program create_program() const
+    {
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        auto input =
+            mm->add_parameter("x", migraphx::shape{migraphx::shape::float_type, {2, 16, 14, 14}});
+        auto w1 = mm->add_literal(migraphx::generate_literal(
+            migraphx::shape{migraphx::shape::float_type, {32, 16, 3, 3}}, 1));
+        auto w2 = mm->add_literal(migraphx::generate_literal(
+            migraphx::shape{migraphx::shape::float_type, {32, 32, 3, 3}}, 2));
+        auto conv1 = mm->add_instruction(
+            migraphx::make_op("convolution", {{"padding", {1, 1}}}), input, w1);
+        auto relu = mm->add_instruction(migraphx::make_op("relu"), conv1);
+        mm->add_instruction(migraphx::make_op("convolution", {{"padding", {1, 1}}}), relu, w2);
+        return p;
+    }
+};
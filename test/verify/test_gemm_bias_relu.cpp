@@ -0,0 +1,30 @@
+
+#include "verify_program.hpp"
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/make_op.hpp>
+
+struct test_gemm_bias_relu : verify_program<test_gemm_bias_relu>
+{
+    migraphx::program create_program() const
+    {
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        migraphx::shape m1_shape{migraphx::shape::float_type, {4, 5}};
+        migraphx::shape m2_shape{migraphx::shape::float_type, {5, 3}};
+        migraphx::shape b_shape{migraphx::shape::float_type, {3}};
+        auto a    = mm->add_parameter("a", m1_shape);
+        auto b    = mm->add_literal(migraphx::generate_literal(m2_shape, 1));
+        auto bias = mm->add_literal(migraphx::generate_literal(b_shape, 2));
+        auto r    = mm->add_parameter("r", {migraphx::shape::float_type, {4, 3}});
+        auto dot  = mm->add_instruction(migraphx::make_op("dot"), a, b);
+        auto bias_b = mm->add_instruction(
+            migraphx::make_op("broadcast", {{"axis", 1}, {"out_lens", dot->get_shape().lens()}}),
+            bias);
+        auto add  = mm->add_instruction(migraphx::make_op("add"), dot, bias_b);
+        auto relu = mm->add_instruction(migraphx::make_op("relu"), add);
+        mm->add_instruction(migraphx::make_op("add"), r, relu);
+        return p;
+    }
+};
@@ -0,0 +1,39 @@
+#include "verify_program.hpp"
+#include <migraphx/literal.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/make_op.hpp>
+
+struct test_loop_dot : verify_program<test_loop_dot>
+{
+    migraphx::program create_program() const
+    {
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        migraphx::shape si{migraphx::shape::int64_type};
+        migraphx::shape s{migraphx::shape::float_type, {4, 4}};
+        migraphx::shape sc{migraphx::shape::bool_type};
+        int64_t iter_num = 3;
+        auto in_iter     = mm->add_literal(migraphx::literal(si, {iter_num}));
+        auto in_cond     = mm->add_parameter("ccond", sc);
+        auto x           = mm->add_parameter("x", s);
+
+        // The loop carried value is read by the dot while its output for the next iteration is
+        // written
+        auto* body = p.create_module("loop_module");
+        body->add_parameter("iter_num", si);
+        auto cond = body->add_parameter("cond", sc);
+        auto in_x = body->add_parameter("x", s);
+        auto w    = body->add_literal(migraphx::generate_literal(s, 1));
+        auto dot  = body->add_instruction(migraphx::make_op("dot"), in_x, w);
+        body->add_return({cond, dot, dot});
+
+        auto rl = mm->add_instruction(
+            migraphx::make_op("loop", {{"max_iterations", 3}}), {in_iter, in_cond, x}, {body});
+        auto r0 = mm->add_instruction(migraphx::make_op("get_tuple_elem", {{"index", 0}}), rl);
+        auto r1 = mm->add_instruction(migraphx::make_op("get_tuple_elem", {{"index", 1}}), rl);
+        mm->add_return({r0, r1});
+
+        return p;
+    }
+};
@@ -0,0 +1,19 @@
+
+#include "verify_program.hpp"
+#include <migraphx/program.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/op/pooling.hpp>
+
+struct test_max_pooling_half : verify_program<test_max_pooling_half>
+{
+    migraphx::program create_program() const
+    {
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        auto input =
+            mm->add_parameter("x", migraphx::shape{migraphx::shape::half_type, {1, 3, 6, 6}});
+        auto op = migraphx::op::pooling{"max", {0, 0}, {2, 2}, {2, 2}};
+        mm->add_instruction(op, input);
+        return p;
+    }
+};
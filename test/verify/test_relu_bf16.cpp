@@ -0,0 +1,18 @@
+
+#include "verify_program.hpp"
+#include <migraphx/program.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/make_op.hpp>
+
+struct test_relu_bf16 : verify_program<test_relu_bf16>
+{
+    migraphx::program create_program() const
+    {
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        auto x =
+            mm->add_parameter("x", migraphx::shape{migraphx::shape::bf16_type, {4, 3, 3, 3}});
+        mm->add_instruction(migraphx::make_op("relu"), x);
+        return p;
+    }
+};
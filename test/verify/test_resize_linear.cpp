@@ -0,0 +1,21 @@
+#include "verify_program.hpp"
+#include <migraphx/program.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/make_op.hpp>
+
+struct test_resize_linear : verify_program<test_resize_linear>
+{
+    migraphx::program create_program() const
+    {
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        migraphx::shape s{migraphx::shape::float_type, {2, 3, 7, 8}};
+        auto x = mm->add_parameter("x", s);
+        mm->add_instruction(migraphx::make_op("resize",
+                                              {{"sizes", {2, 3, 14, 5}},
+                                               {"scales", {1, 1, 2, 0.625}},
+                                               {"mode", "linear"}}),
+                            x);
+        return p;
+    }
+};
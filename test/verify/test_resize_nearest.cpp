@@ -0,0 +1,24 @@
+#include "verify_program.hpp"
+#include <migraphx/program.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/make_op.hpp>
+
+struct test_resize_nearest : verify_program<test_resize_nearest>
+{
+    migraphx::program create_program() const
+    {
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        migraphx::shape s{migraphx::shape::float_type, {1, 3, 5, 4}};
+        auto x = mm->add_parameter("x", s);
+        auto t =
+            mm->add_instruction(migraphx::make_op("transpose", {{"permutation", {0, 1, 3, 2}}}), x);
+        mm->add_instruction(migraphx::make_op("resize",
+                                              {{"sizes", {1, 3, 8, 15}},
+                                               {"scales", {1, 1, 2, 3}},
+                                               {"coordinate_transformation_mode", "asymmetric"},
+                                               {"nearest_mode", "floor"}}),
+                            t);
+        return p;
+    }
+};